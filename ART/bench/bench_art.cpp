@@ -8,29 +8,29 @@
 
 #include "Tree.h"
 #include "encoder_factory.hpp"
+#include "key_set.hpp"
 #include "parameters.h"
+#include "workload_generator.hpp"
 
-static const uint64_t kNumEmailRecords = 25000000;
-static const uint64_t kNumWikiRecords = 14000;
-static const uint64_t kNumUrlRecords = 5000;
-static const uint64_t kNumTxns = 10000000;
 
 static const int kSamplePercent = 20;
 static int kRunALM = 1;
 static int kRunEmail = 0;
 static int kRunWiki = 0;
 static int kRunUrl = 0;
+// copy the keys into the ART leaves instead of loading them through the TIDs
+static int kInlineLeaves = 0;
 
 static const std::string file_load_email = "workloads/load_email";
 static const std::string file_load_wiki = "workloads/load_wiki";
 static const std::string file_load_url = "workloads/load_url";
 
-static const std::string file_txn_email = "workloads/txn_email_zipfian";
-static const std::string file_txn_email_len = "workloads/scan_len_email_zipfian";
-static const std::string file_txn_wiki = "workloads/txn_wiki_zipfian";
-static const std::string file_txn_wiki_len = "workloads/scan_len_wiki_zipfian";
-static const std::string file_txn_url = "workloads/txn_url_zipfian";
-static const std::string file_txn_url_len = "workloads/scan_len_url_zipfian";
+// YCSB workload E on the load keys, generated in memory from the specs
+// that gen_workload uses
+static const std::string file_spec_email = "workload_gen/workload_spec/workloade_email_zipfian";
+static const std::string file_spec_wiki = "workload_gen/workload_spec/workloade_wiki_zipfian";
+static const std::string file_spec_url = "workload_gen/workload_spec/workloade_url_zipfian";
+static const uint64_t kWorkloadSeed = 0;
 
 // for pretty print
 static const char *kGreen = "\033[0;32m";
@@ -124,28 +124,6 @@ void loadKey(TID tid, Key &key) {
   key.set(reinterpret_cast<const char *>(key_str->c_str()), key_str->length());
 }
 
-void loadKeysFromFile(const std::string &file_name, const uint64_t num_records, std::vector<std::string> &keys) {
-  std::ifstream infile(file_name);
-  std::string key;
-  uint64_t count = 0;
-  while (count < num_records && infile.good()) {
-    infile >> key;
-    keys.push_back(key);
-    count++;
-  }
-}
-
-void loadLensInt(const std::string &file_name, const uint64_t num_records, std::vector<int> &keys) {
-  std::ifstream infile(file_name);
-  int key;
-  uint64_t count = 0;
-  while (count < num_records && infile.good()) {
-    infile >> key;
-    keys.push_back(key);
-    count++;
-  }
-}
-
 std::string uint64ToString(uint64_t key) {
   uint64_t endian_swapped_key = __builtin_bswap64(key);
   return std::string(reinterpret_cast<const char *>(&endian_swapped_key), 8);
@@ -159,46 +137,48 @@ std::string getUpperBoundKey(const std::string &key) {
 
 void loadWorkload(int wkld_id, std::vector<std::string> &insert_keys, std::vector<std::string> &insert_keys_sample,
                   std::vector<std::string> &txn_keys, std::vector<int> &scan_key_lens) {
-  std::vector<std::string> load_keys;
-  if (wkld_id == kEmail)
-    loadKeysFromFile(file_load_email, kNumEmailRecords, load_keys);
-  else if (wkld_id == kWiki)
-    loadKeysFromFile(file_load_wiki, kNumWikiRecords, load_keys);
-  else if (wkld_id == kUrl)
-    loadKeysFromFile(file_load_url, kNumUrlRecords, load_keys);
-  else
+  std::string file_name, spec_file_name;
+  if (wkld_id == kEmail) {
+    file_name = file_load_email;
+    spec_file_name = file_spec_email;
+  } else if (wkld_id == kWiki) {
+    file_name = file_load_wiki;
+    spec_file_name = file_spec_wiki;
+  } else if (wkld_id == kUrl) {
+    file_name = file_load_url;
+    spec_file_name = file_spec_url;
+  } else {
     return;
-
-  for (int i = 0; i < (int)load_keys.size() - 1; i++) {
-    int key_len = load_keys[i].length();
-    int next_key_len = load_keys[i + 1].length();
-    if (key_len < next_key_len) {
-      std::string next_prefix = load_keys[i + 1].substr(0, key_len);
-      if (load_keys[i].compare(next_prefix) != 0) insert_keys.push_back(load_keys[i]);
-    } else {
-      insert_keys.push_back(load_keys[i]);
-    }
   }
-  insert_keys.push_back(load_keys[load_keys.size() - 1]);
+  workloadgen::WorkloadSpec spec;
+  if (!workloadgen::loadSpec(spec_file_name, &spec)) {
+    std::cout << "Cannot read workload spec " << spec_file_name << std::endl;
+    return;
+  }
+  // the keys stay in the mapped file; only the ones used are copied
+  benchharness::KeySet key_set;
+  if (!key_set.open(file_name)) return;
+  benchharness::KeyIds load_ids = key_set.ids(spec.record_count);
+  if (load_ids.empty()) return;
+
+  benchharness::KeyIds txn_ids;
+  workloadgen::generateTxns(spec, kWorkloadSeed, load_ids, txn_ids, &scan_key_lens);
+  txn_keys = key_set.strings(txn_ids);
+
+  // keys that are a prefix of the next one are left out
+  benchharness::KeyIds insert_ids;
+  for (int64_t i = 0; i < (int64_t)load_ids.size() - 1; i++) {
+    if (!key_set.key(load_ids[i]).isProperPrefixOf(key_set.key(load_ids[i + 1]))) insert_ids.push_back(load_ids[i]);
+  }
+  insert_ids.push_back(load_ids.back());
+  insert_keys = key_set.strings(insert_ids);
 
-  load_keys.clear();
   std::random_shuffle(insert_keys.begin(), insert_keys.end());
 
   for (int i = 0; i < (int)insert_keys.size(); i += int(100 / kSamplePercent)) {
     insert_keys_sample.push_back(insert_keys[i]);
   }
 
-  if (wkld_id == kEmail) {
-    loadKeysFromFile(file_txn_email, kNumTxns, txn_keys);
-    loadLensInt(file_txn_email_len, kNumTxns, scan_key_lens);
-  } else if (wkld_id == kWiki) {
-    loadKeysFromFile(file_txn_wiki, kNumTxns, txn_keys);
-    loadLensInt(file_txn_wiki_len, kNumTxns, scan_key_lens);
-  } else if (wkld_id == kUrl) {
-    loadKeysFromFile(file_txn_url, kNumTxns, txn_keys);
-    loadLensInt(file_txn_url_len, kNumTxns, scan_key_lens);
-  }
-
   std::cout << "insert_keys size = " << insert_keys.size() << std::endl;
   std::cout << "insert_keys_sample size = " << insert_keys_sample.size() << std::endl;
   std::cout << "txn_keys size = " << txn_keys.size() << std::endl;
@@ -241,7 +221,7 @@ void exec(const int expt_id, const int wkld_id, const bool is_point, const bool
     enc_insert_keys.push_back(std::make_pair(insert_keys[i], encode_str));
   }
 
-  ART_ROWEX::Tree *art = new ART_ROWEX::Tree(loadKey);
+  ART_ROWEX::Tree *art = kInlineLeaves ? new ART_ROWEX::Tree() : new ART_ROWEX::Tree(loadKey);
   auto t = art->getThreadInfo();
   double insert_start_time = getNow();
   std::string enc_insert_str;
@@ -506,6 +486,7 @@ int main(int argc, char *argv[]) {
   kRunEmail = (int)atoi(argv[3]);
   kRunWiki = (int)atoi(argv[4]);
   kRunUrl = (int)atoi(argv[5]);
+  if (argc > 6) kInlineLeaves = (int)atoi(argv[6]);
 
   loadKey((TID) & (end_key_str), end_key);
 
@@ -37,6 +37,17 @@ namespace ART_ROWEX {
     };
 //    static_assert(sizeof(Prefix) == 8, "Prefix should be 64 bit long");
 
+    // Leaf record that keeps a copy of the key right after the TID, so
+    // that a leaf can be checked without calling loadKey
+    struct InlineLeaf {
+        TID tid;
+        KeyLen keyLen;
+
+        const uint8_t *getKey() const {
+            return reinterpret_cast<const uint8_t *>(this + 1);
+        }
+    };
+
     class N {
     protected:
         N(NTypes type, uint32_t level, const uint8_t *prefix, uint32_t prefixLength) : level(level) {
@@ -120,8 +131,16 @@ namespace ART_ROWEX {
 
         static N *setLeaf(TID tid);
 
+        static bool isInlineLeaf(const N *n);
+
+        static N *setInlineLeaf(const Key &k, TID tid);
+
+        static const InlineLeaf *getInlineLeaf(const N *n);
+
         static N *getAnyChild(const N *n);
 
+        static const N *getAnyChildLeaf(const N *n);
+
         static TID getAnyChildTid(const N *n);
 
         static void deleteChildren(N *node);
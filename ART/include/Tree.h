@@ -17,10 +17,17 @@ namespace ART_ROWEX {
     private:
         N *const root;
 
-        TID checkKey(const TID tid, const Key &k) const;
+        TID checkKey(const N *leaf, const Key &k) const;
+
+        N *newLeaf(const Key &k, TID tid) const;
+
+        static void loadLeafKey(const N *leaf, Key &key, LoadKeyFunction loadKey);
 
         LoadKeyFunction loadKey;
 
+        // leaves keep a copy of their key (see Tree())
+        const bool inlineKeys;
+
         Epoche epoche{256};
 
     public:
@@ -63,14 +70,23 @@ namespace ART_ROWEX {
 
         Tree(LoadKeyFunction loadKey);
 
+        // Copies every inserted key into its leaf; leaf checks then compare
+        // against that copy instead of loading the key through the TID.
+        // Meant for short (e.g., HOPE-encoded) keys.
+        Tree();
+
         Tree(const Tree &) = delete;
 
-        Tree(Tree &&t) : root(t.root), loadKey(t.loadKey) { }
+        Tree(Tree &&t) : root(t.root), loadKey(t.loadKey), inlineKeys(t.inlineKeys) { }
 
         ~Tree();
 
         ThreadInfo getThreadInfo();
 
+        // Restarts taken by the calling thread's insert, remove and
+        // lookupRange calls, over all trees
+        static uint64_t &threadRestartCount();
+
 	//huanchen
 	void traverse(double& mem, double& avg_height, int& cnt_N4, int& cnt_N16, int& cnt_N48, int& cnt_N256, uint64_t&  waste_child_mem, uint64_t& skip_prefix_mem, uint64_t& waste_prefix_mem) const;
 
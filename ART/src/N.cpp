@@ -354,9 +354,32 @@ namespace ART_ROWEX {
     }
 
     TID N::getLeaf(const N *n) {
+        if (isInlineLeaf(n)) {
+            return getInlineLeaf(n)->tid;
+        }
         return (reinterpret_cast<uint64_t>(n) & ((static_cast<uint64_t>(1) << 63) - 1));
     }
 
+    // Inline leaves carry bit 62 in addition to the leaf bit
+    bool N::isInlineLeaf(const N *n) {
+        return (reinterpret_cast<uint64_t>(n) & (static_cast<uint64_t>(3) << 62)) == (static_cast<uint64_t>(3) << 62);
+    }
+
+    N *N::setInlineLeaf(const Key &k, TID tid) {
+        void *mem = operator new(sizeof(InlineLeaf) + k.getKeyLen());
+        InlineLeaf *leaf = reinterpret_cast<InlineLeaf *>(mem);
+        leaf->tid = tid;
+        leaf->keyLen = k.getKeyLen();
+        if (k.getKeyLen() > 0) {
+            memcpy(const_cast<uint8_t *>(leaf->getKey()), &k[0], k.getKeyLen());
+        }
+        return reinterpret_cast<N *>(reinterpret_cast<uint64_t>(leaf) | (static_cast<uint64_t>(3) << 62));
+    }
+
+    const InlineLeaf *N::getInlineLeaf(const N *n) {
+        return reinterpret_cast<const InlineLeaf *>(reinterpret_cast<uint64_t>(n) & ((static_cast<uint64_t>(1) << 62) - 1));
+    }
+
     std::tuple<N *, uint8_t> N::getSecondChild(N *node, const uint8_t key) {
         switch (node->getType()) {
             case NTypes::N4: {
@@ -372,6 +395,9 @@ namespace ART_ROWEX {
 
     void N::deleteNode(N *node) {
         if (N::isLeaf(node)) {
+            if (N::isInlineLeaf(node)) {
+                operator delete(const_cast<InlineLeaf *>(N::getInlineLeaf(node)));
+            }
             return;
         }
         switch (node->getType()) {
@@ -399,7 +425,7 @@ namespace ART_ROWEX {
         delete node;
     }
 
-    TID N::getAnyChildTid(const N *n) {
+    const N *N::getAnyChildLeaf(const N *n) {
         const N *nextNode = n;
 
         while (true) {
@@ -408,11 +434,15 @@ namespace ART_ROWEX {
 
             assert(nextNode != nullptr);
             if (isLeaf(nextNode)) {
-                return getLeaf(nextNode);
+                return nextNode;
             }
         }
     }
 
+    TID N::getAnyChildTid(const N *n) {
+        return getLeaf(getAnyChildLeaf(n));
+    }
+
     void N::getChildren(const N *node, uint8_t start, uint8_t end, std::tuple<uint8_t, N *> children[],
                         uint32_t &childrenCount) {
         switch (node->getType()) {
@@ -10,7 +10,10 @@
 
 namespace ART_ROWEX {
 
-    Tree::Tree(LoadKeyFunction loadKey) : root(new N256(0, {})), loadKey(loadKey) {
+    Tree::Tree(LoadKeyFunction loadKey) : root(new N256(0, {})), loadKey(loadKey), inlineKeys(false) {
+    }
+
+    Tree::Tree() : root(new N256(0, {})), loadKey(nullptr), inlineKeys(true) {
     }
 
     Tree::~Tree() {
@@ -22,6 +25,11 @@ namespace ART_ROWEX {
         return ThreadInfo(this->epoche);
     }
 
+    uint64_t &Tree::threadRestartCount() {
+        static thread_local uint64_t restartCount = 0;
+        return restartCount;
+    }
+
     //huanchen
     void Tree::traverse(double& memory, double& avg_height,
                         int& cnt_N4, int& cnt_N16,
@@ -79,6 +87,9 @@ namespace ART_ROWEX {
             N* n = std::get<1>(children[i]);
             if (N::isLeaf(n)) {
                 height_sum += height;
+                if (N::isInlineLeaf(n)) {
+                    mem += sizeof(InlineLeaf) + N::getInlineLeaf(n)->keyLen;
+                }
             } else {
                 node_queue.push(n);
                 node_count_next_level++;
@@ -122,11 +133,10 @@ namespace ART_ROWEX {
                         return 0;
                     }
                     if (N::isLeaf(node)) {
-                        TID tid = N::getLeaf(node);
                         if (level < k.getKeyLen() - 1 || optimisticPrefixMatch) {
-                            return checkKey(tid, k);
+                            return checkKey(node, k);
                         } else {
-                            return tid;
+                            return N::getLeaf(node);
                         }
                     }
                 }
@@ -147,11 +157,13 @@ namespace ART_ROWEX {
         }
        // EpocheGuard epocheGuard(threadEpocheInfo);
         TID toContinue = 0;
+        const N *continueLeaf = nullptr;
         bool restart;
-        std::function<void(const N *)> copy = [&result, &resultSize, &resultsFound, &toContinue, &copy](const N *node) {
+        std::function<void(const N *)> copy = [&result, &resultSize, &resultsFound, &toContinue, &continueLeaf, &copy](const N *node) {
             if (N::isLeaf(node)) {
                 if (resultsFound == resultSize) {
                     toContinue = N::getLeaf(node);
+                    continueLeaf = node;
                     return;
                 }
                 result[resultsFound] = N::getLeaf(node);
@@ -247,7 +259,9 @@ namespace ART_ROWEX {
             }
         };
 
+        int restartCount = 0;
         restart:
+        if (restartCount++) threadRestartCount()++;
         restart = false;
         resultsFound = 0;
 
@@ -310,7 +324,7 @@ namespace ART_ROWEX {
             break;
         }
         if (toContinue != 0) {
-            loadKey(toContinue, continueKey);
+            loadLeafKey(continueLeaf, continueKey, loadKey);
             return true;
         } else {
             return false;
@@ -318,7 +332,15 @@ namespace ART_ROWEX {
     }
 
 
-    TID Tree::checkKey(const TID tid, const Key &k) const {
+    TID Tree::checkKey(const N *leaf, const Key &k) const {
+        if (N::isInlineLeaf(leaf)) {
+            const InlineLeaf *l = N::getInlineLeaf(leaf);
+            if (l->keyLen == k.getKeyLen() && std::memcmp(l->getKey(), &k[0], l->keyLen) == 0) {
+                return l->tid;
+            }
+            return 0;
+        }
+        TID tid = N::getLeaf(leaf);
         Key kt;
         this->loadKey(tid, kt);
         if (k == kt) {
@@ -327,9 +349,27 @@ namespace ART_ROWEX {
         return 0;
     }
 
+    N *Tree::newLeaf(const Key &k, TID tid) const {
+        if (inlineKeys) {
+            return N::setInlineLeaf(k, tid);
+        }
+        return N::setLeaf(tid);
+    }
+
+    void Tree::loadLeafKey(const N *leaf, Key &key, LoadKeyFunction loadKey) {
+        if (N::isInlineLeaf(leaf)) {
+            const InlineLeaf *l = N::getInlineLeaf(leaf);
+            key.set(reinterpret_cast<const char *>(l->getKey()), l->keyLen);
+            return;
+        }
+        loadKey(N::getLeaf(leaf), key);
+    }
+
     void Tree::insert(const Key &k, TID tid, ThreadInfo &epocheInfo) {
 //        EpocheGuard epocheGuard(epocheInfo);
+        int restartCount = 0;
         restart:
+        if (restartCount++) threadRestartCount()++;
         bool needRestart = false;
 
         N *node = nullptr;
@@ -363,7 +403,7 @@ namespace ART_ROWEX {
                     auto newNode = new N4(nextLevel, prefi);
 
                     // 2)  add node and (tid, *k) as children
-                    newNode->insert(k[nextLevel], N::setLeaf(tid));
+                    newNode->insert(k[nextLevel], newLeaf(k, tid));
                     newNode->insert(nonMatchingKey, node);
 
                     // 3) lockVersionOrRestart, update parentNode to point to the new node, unlock
@@ -395,7 +435,7 @@ namespace ART_ROWEX {
                 node->lockVersionOrRestart(v, needRestart);
                 if (needRestart) goto restart;
 
-                N::insertAndUnlock(node, parentNode, parentKey, nodeKey, N::setLeaf(tid), epocheInfo, needRestart);
+                N::insertAndUnlock(node, parentNode, parentKey, nodeKey, newLeaf(k, tid), epocheInfo, needRestart);
                 if (needRestart) goto restart;
                 return;
             }
@@ -404,7 +444,7 @@ namespace ART_ROWEX {
                 if (needRestart) goto restart;
 
                 Key key;
-                loadKey(N::getLeaf(nextNode), key);
+                loadLeafKey(nextNode, key, loadKey);
 
                 level++;
                 assert(level < key.getKeyLen()); //prevent inserting when prefix of key exists already
@@ -414,7 +454,7 @@ namespace ART_ROWEX {
                 }
 
                 auto n4 = new N4(level + prefixLength, &k[level], prefixLength);
-                n4->insert(k[level + prefixLength], N::setLeaf(tid));
+                n4->insert(k[level + prefixLength], newLeaf(k, tid));
                 n4->insert(key[level + prefixLength], nextNode);
                 N::change(node, k[level - 1], n4);
                 node->writeUnlock();
@@ -426,7 +466,9 @@ namespace ART_ROWEX {
 
     void Tree::remove(const Key &k, TID tid, ThreadInfo &threadInfo) {
  //       EpocheGuard epocheGuard(threadInfo);
+        int restartCount = 0;
         restart:
+        if (restartCount++) threadRestartCount()++;
         bool needRestart = false;
 
         N *node = nullptr;
@@ -514,6 +556,9 @@ namespace ART_ROWEX {
                             N::removeAndUnlock(node, k[level], parentNode, parentKey, threadInfo, needRestart);
                             if (needRestart) goto restart;
                         }
+                        if (N::isInlineLeaf(nextNode)) {
+                            this->epoche.markNodeForDeletion(const_cast<InlineLeaf *>(N::getInlineLeaf(nextNode)), threadInfo);
+                        }
                         return;
                     }
                     level++;
@@ -561,14 +606,14 @@ namespace ART_ROWEX {
             Key kt;
             for (uint32_t i = ((level + p.prefixCount) - n->getLevel()); i < p.prefixCount; ++i) {
                 if (i == maxStoredPrefixLength) {
-                    loadKey(N::getAnyChildTid(n), kt);
+                    loadLeafKey(N::getAnyChildLeaf(n), kt, loadKey);
                 }
                 uint8_t curKey = i >= maxStoredPrefixLength ? kt[level] : p.prefix[i];
                 if (curKey != k[level]) {
                     nonMatchingKey = curKey;
                     if (p.prefixCount > maxStoredPrefixLength) {
                         if (i < maxStoredPrefixLength) {
-                            loadKey(N::getAnyChildTid(n), kt);
+                            loadLeafKey(N::getAnyChildLeaf(n), kt, loadKey);
                         }
                         for (uint32_t j = 0; j < std::min((p.prefixCount - (level - prevLevel) - 1),
                                                           maxStoredPrefixLength); ++j) {
@@ -597,7 +642,7 @@ namespace ART_ROWEX {
             Key kt;
             for (uint32_t i = ((level + p.prefixCount) - n->getLevel()); i < p.prefixCount; ++i) {
                 if (i == maxStoredPrefixLength) {
-                    loadKey(N::getAnyChildTid(n), kt);
+                    loadLeafKey(N::getAnyChildLeaf(n), kt, loadKey);
                 }
                 uint8_t kLevel = (k.getKeyLen() > level) ? k[level] : 0;
 
@@ -633,7 +678,7 @@ namespace ART_ROWEX {
             Key kt;
             for (uint32_t i = ((level + p.prefixCount) - n->getLevel()); i < p.prefixCount; ++i) {
                 if (i == maxStoredPrefixLength) {
-                    loadKey(N::getAnyChildTid(n), kt);
+                    loadLeafKey(N::getAnyChildLeaf(n), kt, loadKey);
                 }
                 uint8_t startLevel = (start.getKeyLen() > level) ? start[level] : 0;
                 uint8_t endLevel = (end.getKeyLen() > level) ? end[level] : 0;
@@ -103,6 +103,64 @@ TEST_F(ARTUnitTest, opcLookupWordTest) {
   delete encoder_;
 }
 
+TEST_F(ARTUnitTest, inlineLeafWordTest) {
+  encoder_ = hope::EncoderFactory::createEncoder(kEncoderType);
+  encoder_->build(words_, kDictSizeLimit);
+  for (int i = 0; i < (int)words_.size(); i++) {
+    words_compressed_.push_back(encodeString(words_[i]));
+  }
+  art_ = new ART_ROWEX::Tree();
+  auto t = art_->getThreadInfo();
+  for (int i = 0; i < (int)words_compressed_.size(); i++) {
+    Key key;
+    loadKey((TID) & (words_compressed_[i]), key);
+    art_->insert(key, (TID) & (words_compressed_[i]), t);
+  }
+
+  auto t2 = art_->getThreadInfo();
+  for (int i = 0; i < (int)words_.size(); i++) {
+    std::string enc_str = encodeString(words_[i]);
+    Key key;
+    loadKey((TID)&enc_str, key);
+    TID result_tid = art_->lookup(key, t2);
+    EXPECT_EQ((TID) & (words_compressed_[i]), result_tid);
+  }
+
+  // the continue key comes from the leaf copy
+  TID result[10];
+  std::size_t results_found = 0;
+  Key start_key, end_key, continue_key;
+  loadKey((TID) & (words_compressed_[0]), start_key);
+  std::string end_str = std::string(16, char(255));
+  loadKey((TID)&end_str, end_key);
+  ASSERT_TRUE(art_->lookupRange(start_key, end_key, continue_key, result, 10, results_found, t2));
+  ASSERT_EQ(10, (int)results_found);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ((TID) & (words_compressed_[i]), result[i]);
+  }
+  Key next_key;
+  loadKey((TID) & (words_compressed_[10]), next_key);
+  EXPECT_TRUE(continue_key == next_key);
+
+  for (int i = 0; i < (int)words_compressed_.size(); i += 2) {
+    Key key;
+    loadKey((TID) & (words_compressed_[i]), key);
+    art_->remove(key, (TID) & (words_compressed_[i]), t);
+  }
+  for (int i = 0; i < (int)words_compressed_.size(); i++) {
+    Key key;
+    loadKey((TID) & (words_compressed_[i]), key);
+    TID result_tid = art_->lookup(key, t2);
+    if (i % 2 == 0) {
+      EXPECT_EQ((TID)0, result_tid);
+    } else {
+      EXPECT_EQ((TID) & (words_compressed_[i]), result_tid);
+    }
+  }
+  delete art_;
+  delete encoder_;
+}
+
 void loadWordList() {
   std::ifstream infile(kFilePath);
   std::string key;
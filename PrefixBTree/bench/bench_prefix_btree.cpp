@@ -7,6 +7,7 @@
 
 #include "PrefixBtree.h"
 #include "encoder_factory.hpp"
+#include "key_set.hpp"
 #include "parameters.h"
 
 static const uint64_t kNumEmailRecords = 25000000;
@@ -102,14 +103,9 @@ double getNow() {
 }
 
 void loadKeysFromFile(const std::string &file_name, const uint64_t num_records, std::vector<std::string> &keys) {
-  std::ifstream infile(file_name);
-  std::string key;
-  uint64_t count = 0;
-  while (count < num_records && infile.good()) {
-    infile >> key;
-    keys.push_back(key);
-    count++;
-  }
+  benchharness::KeySet key_set;
+  if (!key_set.open(file_name)) return;
+  keys = key_set.strings(key_set.ids((int64_t)num_records));
 }
 
 void loadLensInt(const std::string &file_name, const uint64_t num_records, std::vector<int> &keys) {
@@ -6,19 +6,21 @@
 #include <atomic>
 #include <cassert>
 #include <cstring>
+#include <iostream>
+#include <mutex>
 #include <queue>
 #include <stack>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace prefixbtreeolc {
 
 enum class PageType : uint8_t { BTreeInner = 1, BTreeLeaf = 2 };
 
-static const uint8_t POINTER_SIZE = 8;
 static const int MaxEntries = 8;
 static const int MaxLeafEntries = 8;
-static int64_t leaf_waste_byte = 0;
 
 struct OptLock {
   std::atomic<uint64_t> typeVersionLockObsolete{0b100};
@@ -75,129 +77,130 @@ struct BTreeLeafBase : public NodeBase {
   static const PageType typeMarker = PageType::BTreeLeaf;
 };
 
-class Key {
- private:
-  // if prefix is too long
-  // key stores the pointer to the prefix
-  char key[POINTER_SIZE];
-  uint16_t part_len_;
-
+// Stores the key bytes of a tree. Keys are copied in once on insert and
+// never move or get freed before the tree, so the keys in the nodes are
+// plain views into this storage and optimistic readers never touch freed
+// memory.
+class KeyArena {
  public:
-  Key() {
-    part_len_ = 0;
-    memset(key, 0, POINTER_SIZE);
-  }
+  // chunks grow from kMinChunkSize up to kMaxChunkSize
+  static const uint64_t kMinChunkSize = 1 << 12;
+  static const uint64_t kMaxChunkSize = 1 << 20;
 
-  // copy constructor
-  Key(const Key &right) {
-    part_len_ = 0;
-    memset(key, 0, POINTER_SIZE);
-    setKeyStr(right.getKeyStr(), right.getLen());
-  }
+  KeyArena() : cur_chunk_(nullptr), next_chunk_size_(kMinChunkSize) {}
 
-  Key &operator=(const Key &right) {
-    setKeyStr(right.getKeyStr(), right.getLen());
-    return *this;
+  ~KeyArena() {
+    for (auto chunk : chunks_) {
+      delete[] chunk->data;
+      delete chunk;
+    }
   }
 
-  ~Key() {
-    if (part_len_ > POINTER_SIZE) {
-      delete[](getOverFlowStr());
-      part_len_ = 0;
-    }
+  const char *copy(const char *str, uint16_t len) {
+    char *dest = allocate(len);
+    memcpy(dest, str, len);
+    return dest;
   }
 
-  void printKeyStr() {
-    const char *str = getKeyStr();
-    uint16_t str_len = getLen();
-    std::cout << str_len << "|";
-    for (int i = 0; i < str_len; i++) {
-      std::cout << unsigned(uint8_t(str[i])) << " ";
+  // Thread-safe; only takes the lock when the current chunk is full
+  char *allocate(uint64_t len) {
+    while (true) {
+      Chunk *chunk = cur_chunk_.load(std::memory_order_acquire);
+      if (chunk != nullptr) {
+        uint64_t offset = chunk->used.fetch_add(len);
+        if (offset + len <= chunk->capacity) return chunk->data + offset;
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (cur_chunk_.load() == chunk) {
+        Chunk *new_chunk = new Chunk();
+        new_chunk->capacity = std::max(next_chunk_size_, (uint64_t)len);
+        new_chunk->data = new char[new_chunk->capacity];
+        new_chunk->used = 0;
+        chunks_.push_back(new_chunk);
+        next_chunk_size_ = std::min(next_chunk_size_ * 2, kMaxChunkSize);
+        cur_chunk_.store(new_chunk, std::memory_order_release);
+      }
     }
   }
 
-  void setOverFlow() {
-    uint16_t mask = 1 << (sizeof(uint16_t) * 8 - 1);
-    part_len_ |= mask;
+  // Bytes handed out, not counting the unused tails of the chunks
+  int64_t getSize() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t size = 0;
+    for (auto chunk : chunks_) size += std::min(chunk->used.load(), chunk->capacity);
+    return size;
   }
 
-  void clearOverFlow() {
-    uint16_t mask = (1 << (sizeof(uint16_t) * 8 - 1)) - 1;
-    part_len_ &= mask;
-  }
+ private:
+  struct Chunk {
+    char *data;
+    uint64_t capacity;
+    std::atomic<uint64_t> used;
+  };
+
+  std::atomic<Chunk *> cur_chunk_;
+  std::vector<Chunk *> chunks_;
+  std::mutex mutex_;
+  uint64_t next_chunk_size_;
+};
+
+// A view of len key bytes; it does not own them. A key passed to the tree
+// only needs to stay valid during the call. Inside a node, the bytes right
+// before a key are always the node's prefix (both are cut out of the same
+// full key in the KeyArena), so moving bytes between a key and the prefix
+// only adjusts offsets.
+class Key {
+ private:
+  static const int kHeadLen = 6;
 
-  bool isOverFlow() const {
-    uint16_t mask = 1 << (sizeof(uint16_t) * 8 - 1);
-    return (part_len_ & mask) > 0;
+  const char *key_;
+  uint16_t len_;
+  // copy of the first bytes (in what would be padding), so that most
+  // comparisons do not leave the node
+  char head_[kHeadLen];
+
+  void loadHead() {
+    if (len_ > 0) memcpy(head_, key_, std::min((int)len_, kHeadLen));
   }
 
-  const char *getOverFlowStr() const { return *reinterpret_cast<const char *const *>(key); }
+ public:
+  Key() : key_(nullptr), len_(0) {}
 
-  uint16_t getLen() const {
-    uint16_t mask = (1 << (sizeof(uint16_t) * 8 - 1)) - 1;
-    return part_len_ & mask;
+  void printKeyStr() {
+    std::cout << len_ << "|";
+    for (int i = 0; i < len_; i++) {
+      std::cout << unsigned(uint8_t(key_[i])) << " ";
+    }
   }
 
-  Key concate(Key &right) {
+  uint16_t getLen() const { return len_; }
+
+  // The full key: prefix bytes followed by right
+  Key concate(const Key &right) const {
     Key new_key;
-    const char *my_key = getKeyStr();
-    const char *right_str = right.getKeyStr();
-    uint16_t prefix_len = getLen();
-    uint16_t right_len = right.getLen();
-    uint16_t full_key_len = prefix_len + right_len;
-    char *re = new char[full_key_len];
-    memcpy(re, my_key, prefix_len);
-    memcpy(re + prefix_len, right_str, right_len);
-    new_key.setKeyStr(re, full_key_len);
-    delete[] re;
+    new_key.setKeyStr(right.getKeyStr() - len_, len_ + right.getLen());
+    assert(len_ == 0 || memcmp(new_key.getKeyStr(), key_, len_) == 0);
     return new_key;
   }
 
-  void setLen(uint16_t new_len) {
-    part_len_ = new_len;
-    if (new_len > POINTER_SIZE) setOverFlow();
-  }
-
-  int64_t getSize() {  // in bytes
-    int64_t re = POINTER_SIZE + sizeof(uint16_t);
-    if (isOverFlow()) re += getLen();
-    return re;
+  int64_t getSize() {  // in bytes, key bytes are in the KeyArena
+    return sizeof(Key);
   }
 
   void chunkToLength(uint16_t new_len) {
-    if (getLen() > POINTER_SIZE && new_len <= POINTER_SIZE) {
-      const char *overflow_str = getOverFlowStr();
-      memcpy(key, overflow_str, new_len);
-      delete[] overflow_str;
-    }
-    setLen(new_len);
+    assert(new_len <= len_);
+    len_ = new_len;
   }
 
   void setKeyStr(const char *str, uint16_t len) {
-    assert(getLen() < (1 << 15));
-    if (isOverFlow()) {
-      delete[](getOverFlowStr());
-      part_len_ = 0;
-    }
-
-    if (len > POINTER_SIZE) {
-      char *overflow_key = new char[len];
-      memcpy(overflow_key, str, len);
-      memcpy(key, &overflow_key, POINTER_SIZE);
-    } else {
-      memcpy(key, str, len);
-    }
-    setLen(len);
+    key_ = str;
+    len_ = len;
+    loadHead();
   }
 
-  const char *getKeyStr() const {
-    if (getLen() > POINTER_SIZE) {
-      return getOverFlowStr();
-    }
-    return key;
-  }
+  const char *getKeyStr() const { return key_; }
 
-  int charStrCmp(const char *s1, int len1, const char *s2, int len2) {
+  static int charStrCmp(const char *s1, int len1, const char *s2, int len2) {
     int len = std::min(len1, len2);
     for (int i = 0; i < len; i++) {
       uint8_t c1 = static_cast<uint8_t>(s1[i]);
@@ -229,14 +232,38 @@ class Key {
     } else {  // mylen > prefix_len
       int cmp = charStrCmp(cur_str, prefix_len, prefix_str, prefix_len);
       if (cmp == 0) {
-        int right_len = right.getLen();
-        return charStrCmp(cur_str + prefix_len, mylen - prefix_len, right.getKeyStr(), right_len);
+        return compareWithKey(cur_str + prefix_len, mylen - prefix_len, right);
       } else
         return cmp;
     }
   }
 
-  uint16_t commonPrefix(Key &right) {
+  // Compares str with right, reading right's head copy first
+  static int compareWithKey(const char *str, int len, const Key &right) {
+    int head_len = std::min(std::min(len, (int)right.len_), kHeadLen);
+    for (int i = 0; i < head_len; i++) {
+      uint8_t c1 = static_cast<uint8_t>(str[i]);
+      uint8_t c2 = static_cast<uint8_t>(right.head_[i]);
+      if (c1 < c2) return -1;
+      if (c1 > c2) return 1;
+    }
+    return charStrCmp(str + head_len, len - head_len, right.key_ + head_len, right.len_ - head_len);
+  }
+
+  // The first 8 bytes, big-endian and zero padded: a < b if
+  // headWord(a) < headWord(b), and headWord(a) <= headWord(b) if a < b
+  uint64_t headWord() const { return headWord(key_, len_); }
+
+  static uint64_t headWord(const char *str, int len) {
+    uint64_t word = 0;
+    if (len >= 8)
+      memcpy(&word, str, 8);
+    else if (len > 0)
+      memcpy(&word, str, len);
+    return __builtin_bswap64(word);
+  }
+
+  uint16_t commonPrefix(const Key &right) const {
     uint16_t len = std::min(getLen(), right.getLen());
     const char *my_str = getKeyStr();
     const char *right_str = right.getKeyStr();
@@ -250,151 +277,141 @@ class Key {
     return i;
   }
 
-  void addTailChar(const char &new_c) {
-    uint16_t cur_len = getLen();
-    // already overflow
-    if (cur_len > POINTER_SIZE) {
-      char *overflow_key = *reinterpret_cast<char **>(key);
-      char *new_overflow_key = new char[cur_len + 1];
-      memcpy(new_overflow_key, overflow_key, cur_len);
-      new_overflow_key[cur_len] = new_c;
-      memcpy(key, &new_overflow_key, POINTER_SIZE);
-      delete[] overflow_key;
-    } else if (cur_len == POINTER_SIZE) {
-      // overflow
-      char *overflow_key = new char[POINTER_SIZE + 1];
-      overflow_key[cur_len] = new_c;
-      memcpy(overflow_key, key, POINTER_SIZE);
-      memcpy(key, &overflow_key, POINTER_SIZE);
-    } else {
-      // no overflow
-      key[cur_len] = new_c;
-    }
-    setLen(cur_len + 1);
-  }
-
-  void addHeadChar(const char &new_c) {
-    uint16_t cur_len = getLen();
-    // already overflow
-    if (cur_len > POINTER_SIZE) {
-      char *overflow_key = *reinterpret_cast<char **>(key);
-      char *new_overflow_key = new char[cur_len + 1];
-      memcpy(new_overflow_key + 1, overflow_key, cur_len);
-      new_overflow_key[0] = new_c;
-      delete[] overflow_key;
-      memcpy(key, &new_overflow_key, POINTER_SIZE);
-    } else if (cur_len == POINTER_SIZE) {
-      // overflow
-      char *overflow_key = new char[POINTER_SIZE + 1];
-      overflow_key[0] = new_c;
-      memcpy(overflow_key + 1, key, POINTER_SIZE);
-      memcpy(key, &overflow_key, POINTER_SIZE);
-    } else {
-      // no overflow
-      memmove(key + 1, key, cur_len);
-      key[0] = new_c;
-    }
-    setLen(cur_len + 1);
-  }
-
+  // Moves the last byte of prefix to the head of the key
   void addHead(const Key &prefix) {
-    uint16_t prefix_key_len = prefix.getLen();
-    char new_head_char = prefix.getKeyStr()[prefix_key_len - 1];
-    addHeadChar(new_head_char);
+    assert(prefix.getLen() > 0 && key_[-1] == prefix.getKeyStr()[prefix.getLen() - 1]);
+    key_--;
+    len_++;
+    loadHead();
   }
 
   void removeHead() {
-    uint16_t key_len = getLen();
-    assert(key_len > 0);
-    if (key_len > POINTER_SIZE + 1) {
-      char *overflow_key = *reinterpret_cast<char **>(key);
-      memmove(overflow_key, overflow_key + 1, key_len - 1);
-    } else if (key_len == POINTER_SIZE + 1) {
-      char *overflow_key = *reinterpret_cast<char **>(key);
-      memcpy(key, overflow_key + 1, POINTER_SIZE);
-      delete[] overflow_key;
-    } else {
-      memmove(key, key + 1, key_len - 1);
-      key[key_len - 1] = '\0';
-    }
-    setLen(key_len - 1);
+    assert(len_ > 0);
+    key_++;
+    len_--;
+    loadHead();
   }
 
   // remove the head number of bytes
   void chunkBeginning(uint16_t cnt) {
-    uint16_t key_len = getLen();
-    assert(cnt <= key_len);
-    for (int i = 0; i < cnt; i++) {
-      removeHead();
-    }
+    assert(cnt <= len_);
+    key_ += cnt;
+    len_ -= cnt;
+    loadHead();
   }
 };
 
-template <class Payload>
+// Moves the common prefix of keys[0, count) to the tail of prefix
+inline void extendPrefix(Key &prefix, Key *keys, int count) {
+  assert(count > 0);
+  uint16_t len = keys[0].getLen();
+  for (int i = 1; i < count; i++) {
+    len = std::min(len, keys[0].commonPrefix(keys[i]));
+  }
+  if (len == 0) return;
+  prefix.setKeyStr(keys[0].getKeyStr() - prefix.getLen(), prefix.getLen() + len);
+  for (int i = 0; i < count; i++) keys[i].chunkBeginning(len);
+}
+
+// Sets [lower, upper) to the range of heads[0, count) equal to head;
+// heads must be sorted
+inline void findHeads(const uint64_t *heads, unsigned count, uint64_t head, unsigned &lower, unsigned &upper) {
+  static const unsigned kScanLen = 16;
+  lower = 0;
+  upper = count;
+  // narrow down to a few vectors (or to a long run of ties), then
+  // compare all of them at once
+  while (upper - lower > kScanLen) {
+    unsigned mid = ((upper - lower) / 2) + lower;
+    if (heads[mid] < head)
+      lower = mid + 1;
+    else if (heads[mid] > head)
+      upper = mid;
+    else
+      break;
+  }
+  unsigned num_less = 0;
+  unsigned num_equal = 0;
+  unsigned i = lower;
+#ifdef __AVX2__
+  // AVX2 only compares signed words, so flip the sign bits first
+  const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+  const __m256i head_vec = _mm256_xor_si256(_mm256_set1_epi64x(head), sign);
+  for (; i + 4 <= upper; i += 4) {
+    __m256i heads_vec = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(heads + i)), sign);
+    __m256i less = _mm256_cmpgt_epi64(head_vec, heads_vec);
+    __m256i equal = _mm256_cmpeq_epi64(head_vec, heads_vec);
+    num_less += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(less)));
+    num_equal += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(equal)));
+  }
+#endif
+  for (; i < upper; i++) {
+    num_less += (heads[i] < head);
+    num_equal += (heads[i] == head);
+  }
+  lower += num_less;
+  upper = lower + num_equal;
+}
+
+// First index of keys[0, count) (under prefix) that is >= k, or > k if
+// upper is set. The head words settle most comparisons; only the keys
+// whose heads tie with k's are compared in full.
+inline unsigned searchNode(const Key &prefix, const Key *keys, const uint64_t *heads, unsigned count, const Key &k,
+                           bool upper) {
+  uint16_t prefix_len = prefix.getLen();
+  if (prefix_len > 0) {
+    int cmp = memcmp(k.getKeyStr(), prefix.getKeyStr(), std::min(k.getLen(), prefix_len));
+    // every key starts with the prefix
+    if (cmp < 0 || (cmp == 0 && k.getLen() < prefix_len)) return 0;
+    if (cmp > 0) return count;
+  }
+
+  const char *suffix = k.getKeyStr() + prefix_len;
+  int suffix_len = k.getLen() - prefix_len;
+  unsigned lower, tie_end;
+  findHeads(heads, count, Key::headWord(suffix, suffix_len), lower, tie_end);
+  while (lower < tie_end) {
+    unsigned mid = ((tie_end - lower) / 2) + lower;
+    int cmp = Key::compareWithKey(suffix, suffix_len, keys[mid]);
+    if (cmp > 0 || (upper && cmp == 0))
+      lower = mid + 1;
+    else
+      tie_end = mid;
+  }
+  return lower;
+}
+
+template <class Payload, int LeafEntries = MaxLeafEntries>
 struct BTreeLeaf : public BTreeLeafBase {
   Key prefix_key_;
-  Key keys[MaxLeafEntries];
-  Payload payloads[MaxLeafEntries];
+  Key keys[LeafEntries];
+  Payload payloads[LeafEntries];
+  // headWord() of each key, for searchNode
+  uint64_t heads[LeafEntries];
 
   BTreeLeaf() {
     count = 0;
     type = typeMarker;
-    memset(keys, 0, sizeof(Key) * MaxEntries);
   }
 
-  bool isFull() { return count == MaxLeafEntries; };
+  bool isFull() { return count == LeafEntries; };
 
   int64_t getSize() {
-    int64_t prefix_size = prefix_key_.getSize();
-    int64_t key_size = 0;
-    int64_t normal_key_size = POINTER_SIZE + sizeof(uint16_t);
-    for (int i = 0; i < count; i++) {
-      key_size += keys[i].getSize();
-    }
-    key_size += (MaxLeafEntries - count) * normal_key_size;
-    leaf_waste_byte += (MaxLeafEntries - count) * normal_key_size;
-    return key_size + sizeof(std::string) * MaxLeafEntries + prefix_size;
+    return prefix_key_.getSize() + (sizeof(Key) + sizeof(uint64_t) + sizeof(std::string)) * LeafEntries;
   }
 
-  unsigned insertBound(Key &k) {
-    unsigned lower = 0;
-    unsigned upper = count;
-    do {
-      unsigned mid = ((upper - lower) / 2) + lower;
-      Key mid_key = keys[mid];
-      int cmp = k.compare(mid_key, prefix_key_);
-      if (cmp < 0) {
-        upper = mid;
-      } else if (cmp > 0) {
-        lower = mid + 1;
-      } else {
-        return mid + 1;
-      }
-    } while (lower < upper);
-    return lower;
-  }
+  unsigned insertBound(Key &k) { return searchNode(prefix_key_, keys, heads, count, k, true); }
 
   // first index >= k
-  unsigned lowerBound(Key &k) {
-    unsigned lower = 0;
-    unsigned upper = count;
-    do {
-      unsigned mid = ((upper - lower) / 2) + lower;
-      Key mid_key = keys[mid];
-      int cmp = k.compare(mid_key, prefix_key_);
-      if (cmp < 0) {
-        upper = mid;
-      } else if (cmp > 0) {
-        lower = mid + 1;
-      } else {
-        return mid;
-      }
-    } while (lower < upper);
-    return lower;
+  unsigned lowerBound(Key &k) { return searchNode(prefix_key_, keys, heads, count, k, false); }
+
+  void loadHeads() {
+    for (int i = 0; i < count; i++) heads[i] = keys[i].headWord();
   }
 
-  void insert(Key &k, Payload &p) {
-    assert(count + 1 <= MaxLeafEntries);
+  // A new key is copied into arena first
+  void insert(Key &k, Payload &p, KeyArena &arena) {
+    assert(count + 1 <= LeafEntries);
     if (count) {
       unsigned pos = insertBound(k);
 
@@ -415,8 +432,10 @@ struct BTreeLeaf : public BTreeLeafBase {
       for (int i = count; i > (int)pos; i--) {
         keys[i] = keys[i - 1];
         payloads[i] = payloads[i - 1];
+        heads[i] = heads[i - 1];
       }
 
+      k.setKeyStr(arena.copy(k.getKeyStr(), k.getLen()), k.getLen());
       // get common prefix of key and other keys
       uint16_t new_prefix_len = k.commonPrefix(prefix_key_);
       k.chunkBeginning(new_prefix_len);
@@ -426,6 +445,7 @@ struct BTreeLeaf : public BTreeLeafBase {
       // decide if we need to modify all the other keys
       if (new_prefix_len == prefix_key_.getLen()) {
         // insert directly
+        heads[pos] = k.headWord();
       } else {
         // modify all the keys, add the last several bytes of prefix to those keys
         assert(new_prefix_len < prefix_key_.getLen());
@@ -437,12 +457,15 @@ struct BTreeLeaf : public BTreeLeafBase {
           }
           prefix_key_.chunkToLength(prefix_key_.getLen() - 1);
         }
+        loadHeads();
       }
     } else {
-      prefix_key_.setKeyStr(k.getKeyStr(), k.getLen());
-      k.setKeyStr("", 0);
+      k.setKeyStr(arena.copy(k.getKeyStr(), k.getLen()), k.getLen());
+      prefix_key_ = k;
+      k.chunkBeginning(k.getLen());
       keys[0] = k;
       payloads[0] = p;
+      heads[0] = k.headWord();
       count++;
     }
   }
@@ -460,43 +483,28 @@ struct BTreeLeaf : public BTreeLeafBase {
     }
 
     // update common prefix
-    assert(count > 0);
-    Key tmp = keys[0];
-    for (int i = 1; i < count; i++) {
-      tmp.chunkToLength(tmp.commonPrefix(keys[i]));
-    }
-
-    uint16_t new_prefix_len = tmp.getLen();
-    for (int i = 0; i < new_prefix_len; i++) {
-      prefix_key_.addTailChar(keys[0].getKeyStr()[0]);
-      for (int j = 0; j < count; j++) keys[j].removeHead();
-    }
+    extendPrefix(prefix_key_, keys, count);
+    extendPrefix(newLeaf->prefix_key_, newLeaf->keys, newLeaf->count);
+    loadHeads();
+    newLeaf->loadHeads();
 
-    assert(newLeaf->count > 0);
-    // Set common prefix
-    Key tmp2 = newLeaf->keys[0];
-    for (int i = 1; i < newLeaf->count; i++) {
-      tmp2.chunkToLength(tmp2.commonPrefix(newLeaf->keys[i]));
-    }
-
-    uint16_t nl_new_prefix_len = tmp2.getLen();
-    for (int i = 0; i < nl_new_prefix_len; i++) {
-      newLeaf->prefix_key_.addTailChar(newLeaf->keys[0].getKeyStr()[0]);
-      for (int j = 0; j < newLeaf->count; j++) newLeaf->keys[j].removeHead();
-    }
+    sep = separator(this, newLeaf);
+    return newLeaf;
+  }
 
-    Key &left = keys[count - 1];
+  // The shortest prefix of right's first key that is greater than left's
+  // last key, or left's last key when no such proper prefix exists
+  static Key separator(BTreeLeaf *left, BTreeLeaf *right) {
     // Concatenate to get the full key
-    sep = prefix_key_.concate(left);
-    Key right = newLeaf->prefix_key_.concate(newLeaf->keys[0]);
-    int prefix_len = sep.commonPrefix(right);
+    Key sep = left->prefix_key_.concate(left->keys[left->count - 1]);
+    Key right_key = right->prefix_key_.concate(right->keys[0]);
+    int prefix_len = sep.commonPrefix(right_key);
 
-    if (prefix_len + 1 >= sep.getLen() || prefix_len + 1 >= right.getLen()) {
-      return newLeaf;
+    if (prefix_len + 1 >= sep.getLen() || prefix_len + 1 >= right_key.getLen()) {
+      return sep;
     }
-    right.chunkToLength(prefix_len + 1);
-    sep = right;
-    return newLeaf;
+    right_key.chunkToLength(prefix_len + 1);
+    return right_key;
   }
 };
 
@@ -504,17 +512,19 @@ struct BTreeInnerBase : public NodeBase {
   static const PageType typeMarker = PageType::BTreeInner;
 };
 
-template <class Payload>
+template <class Payload, int LeafEntries = MaxLeafEntries, int InnerEntries = MaxEntries>
 struct BTreeInner : public BTreeInnerBase {
   Key prefix_key_;
-  NodeBase *children[MaxEntries];
-  Key *keys = new Key[MaxEntries];
+  NodeBase *children[InnerEntries];
+  Key *keys = new Key[InnerEntries];
+  // headWord() of each key, for searchNode
+  uint64_t heads[InnerEntries];
 
   BTreeInner() {
     count = 0;
     type = typeMarker;
-    memset(children, 0, sizeof(NodeBase *) * MaxEntries);
-    for (int i = 0; i < MaxEntries;i++) {
+    memset(children, 0, sizeof(NodeBase *) * InnerEntries);
+    for (int i = 0; i < InnerEntries;i++) {
       keys[i] = Key();
     }
   }
@@ -524,7 +534,7 @@ struct BTreeInner : public BTreeInnerBase {
       if (children[i]->type == PageType::BTreeInner) {
         delete reinterpret_cast<BTreeInner *>(children[i]);
       } else {
-        delete reinterpret_cast<BTreeLeaf<Payload> *>(children[i]);
+        delete reinterpret_cast<BTreeLeaf<Payload, LeafEntries> *>(children[i]);
       }
     }
     delete[] keys;
@@ -535,46 +545,18 @@ struct BTreeInner : public BTreeInnerBase {
     for (int i = 0; i < count; i++) {
       key_size += keys[i].getSize();
     }
-    key_size += (MaxEntries - count) * (POINTER_SIZE + sizeof(uint16_t));
-    return key_size + sizeof(NodeBase *) * MaxEntries;
+    key_size += (InnerEntries - count) * sizeof(Key);
+    return key_size + (sizeof(NodeBase *) + sizeof(uint64_t)) * InnerEntries;
   }
 
-  bool isFull() { return count == (MaxEntries - 1); };
-
-  unsigned insertBound(Key &k) {
-    unsigned lower = 0;
-    unsigned upper = count;
-    do {
-      unsigned mid = ((upper - lower) / 2) + lower;
-      Key &mid_key = keys[mid];
-      int cmp = k.compare(mid_key, prefix_key_);
-      if (cmp < 0) {
-        upper = mid;
-      } else if (cmp > 0) {
-        lower = mid + 1;
-      } else {
-        return mid + 1;
-      }
-    } while (lower < upper);
-    return lower;
-  }
+  bool isFull() { return count == (InnerEntries - 1); };
 
-  unsigned lowerBound(Key &k) {
-    unsigned lower = 0;
-    unsigned upper = count;
-    do {
-      unsigned mid = ((upper - lower) / 2) + lower;
-      Key &mid_key = keys[mid];
-      int cmp = k.compare(mid_key, prefix_key_);
-      if (cmp < 0) {
-        upper = mid;
-      } else if (cmp > 0) {
-        lower = mid + 1;
-      } else {
-        return mid;
-      }
-    } while (lower < upper);
-    return lower;
+  unsigned insertBound(Key &k) { return searchNode(prefix_key_, keys, heads, count, k, true); }
+
+  unsigned lowerBound(Key &k) { return searchNode(prefix_key_, keys, heads, count, k, false); }
+
+  void loadHeads() {
+    for (int i = 0; i < count; i++) heads[i] = keys[i].headWord();
   }
 
   BTreeInner *split(Key &sep) {
@@ -595,39 +577,20 @@ struct BTreeInner : public BTreeInnerBase {
     newInner->prefix_key_ = prefix_key_;
 
     // update common prefix
-    assert(count > 0);
-    Key tmp = keys[0];
-    for (int i = 1; i < count; i++) {
-      tmp.chunkToLength(tmp.commonPrefix(keys[i]));
-    }
-
-    uint16_t new_prefix_len = tmp.getLen();
-    for (int i = 0; i < new_prefix_len; i++) {
-      prefix_key_.addTailChar(keys[0].getKeyStr()[0]);
-      for (int j = 0; j < count; j++) keys[j].removeHead();
-    }
-
-    assert(newInner->count > 0);
-    // Set common prefix
-    Key tmp2 = newInner->keys[0];
-    for (int i = 1; i < newInner->count; i++) {
-      tmp2.chunkToLength(tmp2.commonPrefix(newInner->keys[i]));
-    }
-
-    uint16_t nl_new_prefix_len = tmp2.getLen();
-    for (int i = 0; i < nl_new_prefix_len; i++) {
-      newInner->prefix_key_.addTailChar(newInner->keys[0].getKeyStr()[0]);
-      for (int j = 0; j < newInner->count; j++) newInner->keys[j].removeHead();
-    }
+    extendPrefix(prefix_key_, keys, count);
+    extendPrefix(newInner->prefix_key_, newInner->keys, newInner->count);
+    loadHeads();
+    newInner->loadHeads();
 
     return newInner;
   }
 
   void insert(Key k, NodeBase *child) {
-    assert(count <= MaxEntries - 1);
+    assert(count <= InnerEntries - 1);
     unsigned pos = insertBound(k);
     for (int i = count; i > (int)pos; i--) {
       keys[i] = keys[i - 1];
+      heads[i] = heads[i - 1];
     }
 
     memmove(children + pos + 1, children + pos, sizeof(NodeBase *) * (count - pos + 1));
@@ -641,6 +604,7 @@ struct BTreeInner : public BTreeInnerBase {
     // decide if we need to modify all the other keys
     if (new_prefix_len == prefix_key_.getLen()) {
       // insert directly
+      heads[pos] = k.headWord();
     } else {
       // modify all the keys, add the last several bytes of prefix to those keys
       assert(new_prefix_len < prefix_key_.getLen());
@@ -652,22 +616,26 @@ struct BTreeInner : public BTreeInnerBase {
         }
         prefix_key_.chunkToLength(prefix_key_.getLen() - 1);
       }
+      loadHeads();
     }
     std::swap(children[pos], children[pos + 1]);
   }
 };
 
-template <class Payload>
+template <class Payload, int LeafEntries = MaxLeafEntries, int InnerEntries = MaxEntries>
 class BTreeIterator {
  private:
+  typedef BTreeLeaf<Payload, LeafEntries> Leaf;
+  typedef BTreeInner<Payload, LeafEntries, InnerEntries> Inner;
+
   std::stack<std::pair<NodeBase *, uint16_t>> s_;
-  BTreeLeaf<Payload> *pushAll(NodeBase *node) {
+  Leaf *pushAll(NodeBase *node) {
     while (true) {
       s_.push(std::make_pair(node, 0));
       if (node->type == PageType::BTreeLeaf) {
-        return reinterpret_cast<BTreeLeaf<Payload> *>(node);
+        return reinterpret_cast<Leaf *>(node);
       }
-      auto inner = reinterpret_cast<BTreeInner<Payload> *>(node);
+      auto inner = reinterpret_cast<Inner *>(node);
       node = inner->children[0];
     }
   }
@@ -676,12 +644,12 @@ class BTreeIterator {
   BTreeIterator(NodeBase *root, Key k) {
     NodeBase *node = root;
     while (node->type == PageType::BTreeInner) {
-      auto inner = static_cast<BTreeInner<Payload> *>(node);
+      auto inner = static_cast<Inner *>(node);
       uint16_t id = inner->lowerBound(k);
       s_.push(std::make_pair(node, id));
       node = inner->children[id];
     };
-    auto leaf = static_cast<BTreeLeaf<Payload> *>(node);
+    auto leaf = static_cast<Leaf *>(node);
     unsigned pos = leaf->lowerBound(k);
     s_.push(std::make_pair(leaf, pos));
   }
@@ -693,7 +661,7 @@ class BTreeIterator {
   Payload *next() {
     std::pair<NodeBase *, uint16_t> p = s_.top();
     s_.pop();
-    auto leaf = reinterpret_cast<BTreeLeaf<Payload> *>(p.first);
+    auto leaf = reinterpret_cast<Leaf *>(p.first);
     int cur_idx = p.second;
     if (cur_idx < p.first->count) {
       s_.push(std::make_pair(leaf, cur_idx + 1));
@@ -704,7 +672,7 @@ class BTreeIterator {
       std::pair<NodeBase *, uint16_t> parent_p = s_.top();
       s_.pop();
       if (parent_p.second < parent_p.first->count) {
-        BTreeInner<Payload> *parent = reinterpret_cast<BTreeInner<Payload> *>(parent_p.first);
+        Inner *parent = reinterpret_cast<Inner *>(parent_p.first);
         NodeBase *next = parent->children[parent_p.second + 1];
         s_.push(std::make_pair(parent, parent_p.second + 1));
         pushAll(next);
@@ -715,33 +683,109 @@ class BTreeIterator {
   }
 };
 
-template <class Payload>
+template <class Payload, int LeafEntries = MaxLeafEntries, int InnerEntries = MaxEntries>
 class BTree {
+  // both halves of a split inner node must keep a key
+  static_assert(LeafEntries >= 2 && InnerEntries >= 5, "node fanout too small");
+
  public:
+  typedef BTreeLeaf<Payload, LeafEntries> Leaf;
+  typedef BTreeInner<Payload, LeafEntries, InnerEntries> Inner;
+
   std::atomic<NodeBase *> root;
+  KeyArena key_arena_;
 
-  BTree() { root = new BTreeLeaf<Payload>(); }
+  BTree() { root = new Leaf(); }
 
   ~BTree() {
     if (root.load()->type == PageType::BTreeInner) {
-      auto inner = reinterpret_cast<BTreeInner<Payload> *>(root.load());
+      auto inner = reinterpret_cast<Inner *>(root.load());
       delete inner;
     } else {
-      auto leaf = reinterpret_cast<BTreeLeaf<Payload> *>(root.load());
+      auto leaf = reinterpret_cast<Leaf *>(root.load());
       delete leaf;
     }
   }
 
   void makeRoot(Key k, NodeBase *leftChild, NodeBase *rightChild) {
-    auto inner = new BTreeInner<Payload>();
+    auto inner = new Inner();
     inner->count = 1;
     inner->keys[0] = k;
+    inner->heads[0] = k.headWord();
     inner->children[0] = leftChild;
     inner->children[1] = rightChild;
     root = inner;
   }
 
+  // Builds the tree bottom up from keys in strictly increasing order.
+  // Each node is filled to fill_factor of its capacity, leaving room for
+  // later inserts; the nodes of a level are independent and are built by
+  // num_threads threads. The tree must be empty, and no other operation
+  // may run during the load.
+  void bulkLoad(const std::vector<Key> &keys, const std::vector<Payload> &payloads, double fill_factor = 1.0,
+                int num_threads = 1) {
+    assert(keys.size() == payloads.size());
+    assert(root.load()->type == PageType::BTreeLeaf && root.load()->count == 0);
+    int64_t n = (int64_t)keys.size();
+    if (n == 0) return;
+    fill_factor = std::min(std::max(fill_factor, 0.0), 1.0);
+    int leaf_fill = std::max(1, (int)(LeafEntries * fill_factor));
+    int inner_fill = std::max(2, (int)(InnerEntries * fill_factor));
+
+    // seps[i] separates nodes[i] and nodes[i + 1]
+    std::vector<NodeBase *> nodes((n + leaf_fill - 1) / leaf_fill);
+    std::vector<Key> seps(nodes.size() - 1);
+    int64_t num_leaves = (int64_t)nodes.size();
+    runSlices(num_threads, num_leaves, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        nodes[i] = bulkLoadLeaf(keys, payloads, n * i / num_leaves, n * (i + 1) / num_leaves);
+      }
+    });
+    runSlices(num_threads, num_leaves - 1, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        seps[i] = Leaf::separator(reinterpret_cast<Leaf *>(nodes[i]),
+                                                reinterpret_cast<Leaf *>(nodes[i + 1]));
+      }
+    });
+
+    while (nodes.size() > 1) {
+      int64_t num_children = (int64_t)nodes.size();
+      // every inner node needs at least two children
+      int64_t num_parents = std::max<int64_t>(
+          1, std::min((num_children + inner_fill - 1) / inner_fill, num_children / 2));
+      std::vector<NodeBase *> parents(num_parents);
+      std::vector<Key> parent_seps(num_parents - 1);
+      runSlices(num_threads, num_parents, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; i++) {
+          int64_t first = num_children * i / num_parents;
+          int64_t last = num_children * (i + 1) / num_parents;
+          auto inner = new Inner();
+          inner->count = last - first - 1;
+          for (int64_t j = first; j < last; j++) inner->children[j - first] = nodes[j];
+          for (int64_t j = first; j < last - 1; j++) inner->keys[j - first] = seps[j];
+          inner->prefix_key_.setKeyStr(inner->keys[0].getKeyStr(), 0);
+          extendPrefix(inner->prefix_key_, inner->keys, inner->count);
+          inner->loadHeads();
+          parents[i] = inner;
+          // the separator between two parents moves up, as in BTreeInner::split
+          if (i + 1 < num_parents) parent_seps[i] = seps[last - 1];
+        }
+      });
+      nodes.swap(parents);
+      seps.swap(parent_seps);
+    }
+    delete reinterpret_cast<Leaf *>(root.load());
+    root = nodes[0];
+  }
+
+  // Restarts taken by the calling thread's operations, over all trees
+  static uint64_t &threadRestartCount() {
+    static thread_local uint64_t restart_count = 0;
+    return restart_count;
+  }
+
   void yield(int count) {
+    threadRestartCount()++;
     if (count > 3)
       sched_yield();
     else
@@ -760,11 +804,11 @@ class BTree {
     if (needRestart || (node != root)) goto restart;
 
     // Parent of current node
-    BTreeInner<Payload> *parent = nullptr;
-    uint64_t versionParent;
+    Inner *parent = nullptr;
+    uint64_t versionParent = 0;
 
     while (node->type == PageType::BTreeInner) {
-      auto inner = static_cast<BTreeInner<Payload> *>(node);
+      auto inner = static_cast<Inner *>(node);
 
       // Split eagerly if full
       if (inner->isFull()) {
@@ -784,7 +828,7 @@ class BTree {
         }
         // Split
         Key sep;
-        BTreeInner<Payload> *newInner = inner->split(sep);
+        Inner *newInner = inner->split(sep);
         if (parent)
           parent->insert(sep, newInner);
         else
@@ -810,10 +854,10 @@ class BTree {
       if (needRestart) goto restart;
     }
 
-    auto leaf = static_cast<BTreeLeaf<Payload> *>(node);
+    auto leaf = static_cast<Leaf *>(node);
 
     // Split leaf if full
-    if (leaf->count == MaxLeafEntries) {
+    if (leaf->isFull()) {
       // Lock
       if (parent) {
         parent->upgradeToWriteLockOrRestart(versionParent, needRestart);
@@ -830,7 +874,7 @@ class BTree {
       }
       // Split
       Key sep;
-      BTreeLeaf<Payload> *newLeaf = leaf->split(sep);
+      Leaf *newLeaf = leaf->split(sep);
       if (parent)
         parent->insert(sep, newLeaf);
       else
@@ -850,7 +894,7 @@ class BTree {
           goto restart;
         }
       }
-      leaf->insert(k, v);
+      leaf->insert(k, v, key_arena_);
       node->writeUnlock();
       return;  // success
     }
@@ -867,11 +911,11 @@ class BTree {
     if (needRestart || (node != root)) goto restart;
 
     // Parent of current node
-    BTreeInner<Payload> *parent = nullptr;
+    Inner *parent = nullptr;
     uint64_t versionParent = 0;
 
     while (node->type == PageType::BTreeInner) {
-      auto inner = static_cast<BTreeInner<Payload> *>(node);
+      auto inner = static_cast<Inner *>(node);
 
       if (parent) {
         parent->readUnlockOrRestart(versionParent, needRestart);
@@ -888,7 +932,7 @@ class BTree {
       if (needRestart) goto restart;
     }
 
-    BTreeLeaf<Payload> *leaf = static_cast<BTreeLeaf<Payload> *>(node);
+    Leaf *leaf = static_cast<Leaf *>(node);
     unsigned pos = leaf->lowerBound(k);
     bool success = false;
     assert(pos != leaf->count);
@@ -908,7 +952,7 @@ class BTree {
   }
 
   uint16_t rangeScan(Key k, int range, Payload *output) {
-    auto it = new BTreeIterator<Payload>(root, k);
+    auto it = new BTreeIterator<Payload, LeafEntries, InnerEntries>(root, k);
     uint16_t cnt = 0;
     while (cnt < range) {
       Payload *v = it->next();
@@ -930,11 +974,11 @@ class BTree {
     if (needRestart || (node != root)) goto restart;
 
     // Parent of current node
-    BTreeInner<Payload> *parent = nullptr;
+    Inner *parent = nullptr;
     uint64_t versionParent;
 
     while (node->type == PageType::BTreeInner) {
-      auto inner = static_cast<BTreeInner<Payload> *>(node);
+      auto inner = static_cast<Inner *>(node);
 
       if (parent) {
         parent->readUnlockOrRestart(versionParent, needRestart);
@@ -951,7 +995,7 @@ class BTree {
       if (needRestart) goto restart;
     }
 
-    BTreeLeaf<Payload> *leaf = static_cast<BTreeLeaf<Payload> *>(node);
+    Leaf *leaf = static_cast<Leaf *>(node);
     unsigned pos = leaf->lowerBound(k);
     int count = 0;
     for (unsigned i = pos; i < leaf->count; i++) {
@@ -994,7 +1038,7 @@ class BTree {
       max_hei = std::max(h, max_hei);
 
       if (top->type == PageType::BTreeInner) {
-        auto node = reinterpret_cast<BTreeInner<Payload> *>(top);
+        auto node = reinterpret_cast<Inner *>(top);
         size += node->getSize();
         internal_node_size += node->getSize();
         avg_internal_prefix += node->prefix_key_.getLen();
@@ -1009,7 +1053,7 @@ class BTree {
           node_cnt++;
         }
       } else {
-        auto node = reinterpret_cast<BTreeLeaf<Payload> *>(top);
+        auto node = reinterpret_cast<Leaf *>(top);
         prefix_size += node->prefix_key_.getSize();
 
         prefix_byte_size += node->prefix_key_.getLen() * node->count;
@@ -1024,13 +1068,14 @@ class BTree {
       }
       q.pop();
     }
+    size += key_arena_.getSize();
     std::cout << "---------------Compressed B tree----------------------" << std::endl;
     std::cout << "Btree size = " << size * 1.0 / 1000000.0 << " MB" << std::endl;
     std::cout << "Max Height = " << max_hei << std::endl;
     std::cout << "Max Prefix Len = " << max_prefix_len << std::endl;
     std::cout << "Avg Prefix Len = " << 1.0 * avg_internal_prefix / internal_node_num << std::endl;
     std::cout << "Leaf Prefix node size = " << prefix_size << std::endl;
-    std::cout << "Leaf waste size = " << leaf_waste_byte << std::endl;
+    std::cout << "Key arena size = " << key_arena_.getSize() << std::endl;
     std::cout << "Leaf Key Num = " << leaf_key_num << std::endl;
     std::cout << "Leaf Key Size = " << leaf_key_size << std::endl;
     std::cout << "Node Num = " << node_cnt << std::endl;
@@ -1043,13 +1088,49 @@ class BTree {
     return size;
   }
 
+  // Runs fn(begin, end) on up to num_threads contiguous slices of [0, n)
+  template <class Fn>
+  static void runSlices(int num_threads, int64_t n, Fn fn) {
+    static const int64_t kMinNodesPerThread = 1024;
+    int64_t num_slices = std::max<int64_t>(1, std::min<int64_t>(num_threads, n / kMinNodesPerThread));
+    std::vector<std::thread> threads;
+    for (int64_t t = 1; t < num_slices; t++) {
+      threads.push_back(std::thread(fn, n * t / num_slices, n * (t + 1) / num_slices));
+    }
+    fn(0, n / num_slices);
+    for (auto &thread : threads) thread.join();
+  }
+
+  Leaf *bulkLoadLeaf(const std::vector<Key> &keys, const std::vector<Payload> &payloads,
+                                   int64_t begin, int64_t end) {
+    auto leaf = new Leaf();
+    leaf->count = end - begin;
+    uint64_t total_len = 0;
+    for (int64_t i = begin; i < end; i++) total_len += keys[i].getLen();
+    // one arena allocation for all the keys of the leaf
+    char *dest = key_arena_.allocate(total_len);
+    for (int64_t i = begin; i < end; i++) {
+      assert(i == begin || Key::charStrCmp(keys[i - 1].getKeyStr(), keys[i - 1].getLen(), keys[i].getKeyStr(),
+                                           keys[i].getLen()) < 0);
+      memcpy(dest, keys[i].getKeyStr(), keys[i].getLen());
+      leaf->keys[i - begin].setKeyStr(dest, keys[i].getLen());
+      leaf->payloads[i - begin] = payloads[i];
+      dest += keys[i].getLen();
+    }
+    // the prefix is the common prefix of the keys, as insert keeps it
+    leaf->prefix_key_.setKeyStr(leaf->keys[0].getKeyStr(), 0);
+    extendPrefix(leaf->prefix_key_, leaf->keys, leaf->count);
+    leaf->loadHeads();
+    return leaf;
+  }
+
   void getSubstrings(std::vector<std::string> &substrings) {
     std::queue<NodeBase *> q;
     q.push(root.load());
     while (!q.empty()) {
       NodeBase *top = q.front();
       if (top->type == PageType::BTreeInner) {
-        auto inner = reinterpret_cast<BTreeInner<Payload> *>(top);
+        auto inner = reinterpret_cast<Inner *>(top);
         for (int i = 0; i <= (int)inner->count; i++) {
           q.push(inner->children[i]);
         }
@@ -1061,7 +1142,7 @@ class BTree {
           substrings.emplace_back(inner->keys[i].getKeyStr(), inner->keys[i].getLen());
         }
       } else {
-        auto leaf = reinterpret_cast<BTreeLeaf<Payload> *>(top);
+        auto leaf = reinterpret_cast<Leaf *>(top);
         if (leaf->prefix_key_.getLen() > 0) {
           substrings.emplace_back(leaf->prefix_key_.getKeyStr(), leaf->prefix_key_.getLen());
         }
@@ -1074,4 +1155,18 @@ class BTree {
   }
 };
 
+// Fanouts that make a node take about page_size bytes (e.g. 4096), not
+// counting the key bytes in the KeyArena
+template <class Payload>
+constexpr int leafEntriesForPage(int page_size) {
+  return (page_size - sizeof(NodeBase) - sizeof(Key)) / (sizeof(Key) + sizeof(uint64_t) + sizeof(Payload));
+}
+
+constexpr int innerEntriesForPage(int page_size) {
+  return (page_size - sizeof(NodeBase) - sizeof(Key)) / (sizeof(Key) + sizeof(uint64_t) + sizeof(NodeBase *));
+}
+
+template <class Payload, int PageSize>
+using PagedBTree = BTree<Payload, leafEntriesForPage<Payload>(PageSize), innerEntriesForPage(PageSize)>;
+
 }  // namespace prefixbtreeolc
@@ -162,6 +162,118 @@ TEST_F(PrefixBtreeUnitTest, rangeScanEncodeWordTest) {
   delete encoder_;
 }
 
+// The tree copies the key bytes on insert, so the caller's buffer can be reused
+TEST_F(PrefixBtreeUnitTest, reuseKeyBufferTest) {
+  bt_ = new prefixbtreeolc::BTree<int64_t>();
+  char key_buffer[256];
+  for (int i = 0; i < (int)words.size(); i++) {
+    memcpy(key_buffer, words[i].c_str(), words[i].length());
+    prefixbtreeolc::Key key;
+    key.setKeyStr(key_buffer, words[i].length());
+    bt_->insert(key, i);
+    memset(key_buffer, 0xFF, words[i].length());
+  }
+  EXPECT_GT(bt_->key_arena_.getSize(), 0);
+
+  for (int i = 0; i < (int)words.size(); i++) {
+    prefixbtreeolc::Key key;
+    key.setKeyStr(words[i].c_str(), words[i].length());
+    int64_t re;
+    ASSERT_TRUE(bt_->lookup(key, re));
+    EXPECT_EQ(i, re);
+  }
+  delete bt_;
+}
+
+// Bulk loads every other word, then inserts the rest into the loaded tree
+TEST_F(PrefixBtreeUnitTest, bulkLoadWordTest) {
+  std::vector<std::string> sorted_words = words;
+  std::sort(sorted_words.begin(), sorted_words.end());
+  sorted_words.erase(std::unique(sorted_words.begin(), sorted_words.end()), sorted_words.end());
+  double fill_factors[] = {1.0, 0.5, 0.1};
+  int thread_counts[] = {1, 4, 4};
+  for (int run = 0; run < 3; run++) {
+    bt_ = new prefixbtreeolc::BTree<int64_t>();
+    std::vector<prefixbtreeolc::Key> keys;
+    std::vector<int64_t> payloads;
+    for (int i = 0; i < (int)sorted_words.size(); i += 2) {
+      prefixbtreeolc::Key key;
+      key.setKeyStr(sorted_words[i].c_str(), sorted_words[i].length());
+      keys.push_back(key);
+      payloads.push_back(i);
+    }
+    bt_->bulkLoad(keys, payloads, fill_factors[run], thread_counts[run]);
+    for (int i = 1; i < (int)sorted_words.size(); i += 2) {
+      prefixbtreeolc::Key key;
+      key.setKeyStr(sorted_words[i].c_str(), sorted_words[i].length());
+      bt_->insert(key, i);
+    }
+
+    for (int i = 0; i < (int)sorted_words.size(); i++) {
+      prefixbtreeolc::Key key;
+      key.setKeyStr(sorted_words[i].c_str(), sorted_words[i].length());
+      int64_t re;
+      ASSERT_TRUE(bt_->lookup(key, re));
+      EXPECT_EQ(i, re);
+    }
+    int scanlen = 100;
+    int64_t scan_result[100];
+    for (int i = 0; i < (int)sorted_words.size(); i += 997) {
+      prefixbtreeolc::Key key;
+      key.setKeyStr(sorted_words[i].c_str(), sorted_words[i].length());
+      int cnt = bt_->rangeScan(key, scanlen, scan_result);
+      ASSERT_EQ(std::min(scanlen, (int)sorted_words.size() - i), cnt);
+      for (int j = 0; j < cnt; j++) {
+        EXPECT_EQ(i + j, scan_result[j]);
+      }
+    }
+    delete bt_;
+  }
+}
+
+template <class BTree>
+void checkFanout(const std::vector<std::string> &keys) {
+  std::vector<std::string> sorted_keys = keys;
+  std::sort(sorted_keys.begin(), sorted_keys.end());
+  sorted_keys.erase(std::unique(sorted_keys.begin(), sorted_keys.end()), sorted_keys.end());
+  std::vector<int> order(sorted_keys.size());
+  for (int i = 0; i < (int)order.size(); i++) order[i] = i;
+  std::shuffle(order.begin(), order.end(), std::mt19937(0));
+  BTree *bt = new BTree();
+  for (int i : order) {
+    prefixbtreeolc::Key key;
+    key.setKeyStr(sorted_keys[i].c_str(), sorted_keys[i].length());
+    bt->insert(key, i);
+  }
+
+  for (int i = 0; i < (int)sorted_keys.size(); i++) {
+    prefixbtreeolc::Key key;
+    key.setKeyStr(sorted_keys[i].c_str(), sorted_keys[i].length());
+    int64_t re;
+    ASSERT_TRUE(bt->lookup(key, re));
+    EXPECT_EQ(i, re);
+  }
+  int scanlen = 100;
+  int64_t scan_result[100];
+  for (int i = 0; i < (int)sorted_keys.size(); i += 997) {
+    prefixbtreeolc::Key key;
+    key.setKeyStr(sorted_keys[i].c_str(), sorted_keys[i].length());
+    int cnt = bt->rangeScan(key, scanlen, scan_result);
+    ASSERT_EQ(std::min(scanlen, (int)sorted_keys.size() - i), cnt);
+    for (int j = 0; j < cnt; j++) {
+      EXPECT_EQ(i + j, scan_result[j]);
+    }
+  }
+  delete bt;
+}
+
+TEST_F(PrefixBtreeUnitTest, fanoutTest) {
+  checkFanout<prefixbtreeolc::BTree<int64_t, 2, 5>>(words);
+  checkFanout<prefixbtreeolc::BTree<int64_t, 2, 5>>(integers);
+  checkFanout<prefixbtreeolc::PagedBTree<int64_t, 4096>>(words);
+  checkFanout<prefixbtreeolc::PagedBTree<int64_t, 4096>>(integers);
+}
+
 TEST_F(PrefixBtreeUnitTest, lookIntTest) {
   bt_ = new prefixbtreeolc::BTree<int64_t>();
   for (int i = 0; i < (int)integers.size(); i++) {
@@ -8,6 +8,7 @@
 #include <set>
 
 #include "encoder_factory.hpp"
+#include "key_set.hpp"
 #include "surf.hpp"
 #include "parameters.h"
 
@@ -172,14 +173,9 @@ double getNow() {
 }
 
 void loadKeysFromFile(const std::string &file_name, const uint64_t num_records, std::vector<std::string> &keys) {
-  std::ifstream infile(file_name);
-  std::string key;
-  uint64_t count = 0;
-  while (count < num_records && infile.good()) {
-    infile >> key;
-    keys.push_back(key);
-    count++;
-  }
+  benchharness::KeySet key_set;
+  if (!key_set.open(file_name)) return;
+  keys = key_set.strings(key_set.ids((int64_t)num_records));
 }
 
 std::string uint64ToString(uint64_t key) {
@@ -0,0 +1,171 @@
+#ifndef COMPRESSED_SURF_H_
+#define COMPRESSED_SURF_H_
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "encoder_factory.hpp"
+#include "key_sampler.hpp"
+#include "surf.hpp"
+
+namespace surf {
+
+// A SuRF over HOPE-encoded keys that owns both the encoder and the
+// filter. It is built from the raw sorted keys and probed with raw keys;
+// probes are encoded into per-thread buffers without allocating.
+//
+// Encoded keys are padded with zero bits to whole bytes, so different
+// raw keys can share an encoded key (only adding false positives), and
+// an exclusive raw bound can only be searched exclusively where no
+// other key pads to its bytes (see encoded_key.hpp).
+class CompressedSuRF {
+public:
+    // The encoder is built on kSamplePercent% of the keys,
+    // but on no fewer than kMinSampleSize of them
+    static const int kSamplePercent = 1;
+    static const int64_t kMinSampleSize = 10000;
+
+    //------------------------------------------------------------------
+    // Input keys must be SORTED
+    //------------------------------------------------------------------
+    CompressedSuRF(const std::vector<std::string>& keys,
+		   const int encoder_type, const int64_t dict_size_limit) {
+	create(buildEncoder(keys, encoder_type, dict_size_limit), keys,
+	       kIncludeDense, kSparseDenseRatio, kNone, 0, 0);
+    }
+
+    CompressedSuRF(const std::vector<std::string>& keys,
+		   const int encoder_type, const int64_t dict_size_limit,
+		   const SuffixType suffix_type,
+		   const level_t hash_suffix_len, const level_t real_suffix_len) {
+	create(buildEncoder(keys, encoder_type, dict_size_limit), keys,
+	       kIncludeDense, kSparseDenseRatio, suffix_type, hash_suffix_len, real_suffix_len);
+    }
+
+    // Takes over an encoder that is already built
+    CompressedSuRF(hope::Encoder* encoder, const std::vector<std::string>& keys,
+		   const SuffixType suffix_type,
+		   const level_t hash_suffix_len, const level_t real_suffix_len) {
+	create(encoder, keys, kIncludeDense, kSparseDenseRatio,
+	       suffix_type, hash_suffix_len, real_suffix_len);
+    }
+
+    ~CompressedSuRF() {
+	filter_->destroy();
+	delete filter_;
+	delete encoder_;
+    }
+
+    bool lookupKey(const std::string& key) const;
+    // The iterator walks the encoded key prefixes stored in the filter
+    SuRF::Iter moveToKeyGreaterThan(const std::string& key, const bool inclusive) const;
+    bool lookupRange(const std::string& left_key, const bool left_inclusive,
+		     const std::string& right_key, const bool right_inclusive);
+    // Whether the filter may hold a key that starts with prefix
+    bool lookupPrefix(const std::string& prefix);
+
+    // Filter and encoder dictionary together
+    uint64_t getMemoryUsage() const;
+    const SuRF* getFilter() const { return filter_; }
+    const hope::Encoder* getEncoder() const { return encoder_; }
+
+private:
+    static hope::Encoder* buildEncoder(const std::vector<std::string>& keys,
+				       const int encoder_type, const int64_t dict_size_limit);
+    void create(hope::Encoder* encoder, const std::vector<std::string>& keys,
+		const bool include_dense, const uint32_t sparse_dense_ratio,
+		const SuffixType suffix_type,
+		const level_t hash_suffix_len, const level_t real_suffix_len);
+
+    // Per-thread buffers for the encoded probes; slot 0 is used for
+    // point probes and left bounds, slot 1 for right bounds
+    static uint8_t* getBuffer(const int slot, const size_t key_len);
+    static const std::string& toEncodedKey(const int slot, const int bit_len);
+
+    hope::Encoder* encoder_;
+    SuRF* filter_;
+};
+
+hope::Encoder* CompressedSuRF::buildEncoder(const std::vector<std::string>& keys,
+					    const int encoder_type, const int64_t dict_size_limit) {
+    int64_t sample_size = std::max((int64_t)keys.size() * kSamplePercent / 100, (int64_t)kMinSampleSize);
+    hope::Encoder* encoder = hope::EncoderFactory::createEncoder(encoder_type);
+    encoder->buildFromStream(keys.begin(), keys.end(), dict_size_limit, sample_size);
+    return encoder;
+}
+
+void CompressedSuRF::create(hope::Encoder* encoder, const std::vector<std::string>& keys,
+			    const bool include_dense, const uint32_t sparse_dense_ratio,
+			    const SuffixType suffix_type,
+			    const level_t hash_suffix_len, const level_t real_suffix_len) {
+    encoder_ = encoder;
+    std::vector<std::string> enc_keys;
+    for (int i = 0; i < (int)keys.size(); i++) {
+	int bit_len = encoder_->encode(keys[i], getBuffer(0, keys[i].length()));
+	const std::string& enc_key = toEncodedKey(0, bit_len);
+	// padding can map neighboring keys to the same encoded key
+	if (!enc_keys.empty() && enc_keys.back() == enc_key)
+	    continue;
+	enc_keys.push_back(enc_key);
+    }
+    filter_ = new SuRF(enc_keys, include_dense, sparse_dense_ratio,
+		       suffix_type, hash_suffix_len, real_suffix_len);
+}
+
+bool CompressedSuRF::lookupKey(const std::string& key) const {
+    int bit_len = encoder_->encode(key, getBuffer(0, key.length()));
+    return filter_->lookupKey(toEncodedKey(0, bit_len));
+}
+
+SuRF::Iter CompressedSuRF::moveToKeyGreaterThan(const std::string& key, const bool inclusive) const {
+    int bit_len = encoder_->encode(key, getBuffer(0, key.length()));
+    return filter_->moveToKeyGreaterThan(toEncodedKey(0, bit_len),
+					 hope::paddedLeftInclusive(bit_len, inclusive));
+}
+
+bool CompressedSuRF::lookupRange(const std::string& left_key, const bool left_inclusive,
+				 const std::string& right_key, const bool right_inclusive) {
+    hope::EncodedBound left_bound, right_bound;
+    encoder_->encodeRange(left_key, left_inclusive, right_key, right_inclusive,
+			  getBuffer(0, left_key.length()), getBuffer(1, right_key.length()),
+			  &left_bound, &right_bound);
+    return filter_->lookupRange(toEncodedKey(0, left_bound.bit_len), left_bound.inclusive,
+				toEncodedKey(1, right_bound.bit_len), right_bound.inclusive);
+}
+
+bool CompressedSuRF::lookupPrefix(const std::string& prefix) {
+    hope::EncodedBound lo_bound, hi_bound;
+    if (!encoder_->encodePrefixRange(prefix, getBuffer(0, prefix.length()),
+				     getBuffer(1, prefix.length()), &lo_bound, &hi_bound)) {
+	if (lo_bound.bit_len == 0)
+	    return filter_->moveToFirst().isValid();
+	return filter_->moveToKeyGreaterThan(toEncodedKey(0, lo_bound.bit_len), true).isValid();
+    }
+    return filter_->lookupRange(toEncodedKey(0, lo_bound.bit_len), lo_bound.inclusive,
+				toEncodedKey(1, hi_bound.bit_len), hi_bound.inclusive);
+}
+
+uint64_t CompressedSuRF::getMemoryUsage() const {
+    return filter_->getMemoryUsage() + encoder_->memoryUse();
+}
+
+uint8_t* CompressedSuRF::getBuffer(const int slot, const size_t key_len) {
+    static thread_local std::vector<uint8_t> buffers[2];
+    // a code is at most 32 bits per key byte; encoders write 8-byte words
+    size_t size = key_len * 4 + 16;
+    if (buffers[slot].size() < size)
+	buffers[slot].resize(size * 2);
+    return buffers[slot].data();
+}
+
+const std::string& CompressedSuRF::toEncodedKey(const int slot, const int bit_len) {
+    static thread_local std::string enc_keys[2];
+    // assign reuses the string's capacity
+    enc_keys[slot].assign((const char*)getBuffer(slot, 0), (bit_len + 7) >> 3);
+    return enc_keys[slot];
+}
+
+} // namespace surf
+
+#endif // COMPRESSED_SURF_H_
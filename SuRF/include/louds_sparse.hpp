@@ -225,11 +225,14 @@ bool LoudsSparse::moveToKeyGreaterThan(const std::string& key,
     level_t level;
     for (level = start_level_; level < key.length(); level++) {
 	position_t node_size = nodeSize(pos);
-	// if no exact match
-	if (!labels_->search((label_t)key[level], pos, node_size)) {
+	// if no exact match; search can move its position past the
+	// terminator even when it fails
+	position_t search_pos = pos;
+	if (!labels_->search((label_t)key[level], search_pos, node_size)) {
 	    moveToLeftInNextSubtrie(pos, node_size, key[level], iter);
 	    return false;
 	}
+	pos = search_pos;
 
 	iter.append(key[level], pos);
 
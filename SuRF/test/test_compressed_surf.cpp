@@ -0,0 +1,121 @@
+#include "gtest/gtest.h"
+
+#include <assert.h>
+
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "compressed_surf.hpp"
+#include "config.hpp"
+
+namespace surf {
+
+namespace compressedsurftest {
+
+static const std::string kFilePath = "../../../datasets/words.txt";
+static const int kWordTestSize = 234369;
+static const int kNumEncoderType = 6;
+static const int kEncoderTypeList[kNumEncoderType] = {1, 2, 3, 4, 5, 6};
+static const int kDictSizeLimit = 10000;
+static const level_t kSuffixLen = 8;
+static std::vector<std::string> words;
+
+class CompressedSuRFUnitTest : public ::testing::Test {
+ public:
+  virtual void SetUp(){};
+  virtual void TearDown(){};
+};
+
+TEST_F(CompressedSuRFUnitTest, lookupWordTest) {
+  for (int t = 0; t < kNumEncoderType; t++) {
+    CompressedSuRF *surf = new CompressedSuRF(words, kEncoderTypeList[t], kDictSizeLimit, kReal, 0, kSuffixLen);
+    for (int i = 0; i < (int)words.size(); i++) {
+      ASSERT_TRUE(surf->lookupKey(words[i]));
+    }
+    EXPECT_GT(surf->getMemoryUsage(), surf->getFilter()->getMemoryUsage());
+    delete surf;
+  }
+}
+
+TEST_F(CompressedSuRFUnitTest, lookupRangeWordTest) {
+  for (int t = 0; t < kNumEncoderType; t++) {
+    CompressedSuRF *surf = new CompressedSuRF(words, kEncoderTypeList[t], kDictSizeLimit);
+    ASSERT_TRUE(surf->lookupRange(std::string("\1"), true, words[0], true));
+    for (int i = 0; i < (int)words.size() - 1; i++) {
+      ASSERT_TRUE(surf->lookupRange(words[i], true, words[i + 1], true));
+      ASSERT_TRUE(surf->lookupRange(words[i], true, words[i + 1], false));
+      ASSERT_TRUE(surf->lookupRange(words[i], false, words[i + 1], true));
+      // the key in between must be found whatever the padding
+      if (i + 2 < (int)words.size()) {
+        ASSERT_TRUE(surf->lookupRange(words[i], false, words[i + 2], false));
+      }
+    }
+    ASSERT_TRUE(surf->lookupRange(words[words.size() - 1], true, std::string("zzzzzzzz"), false));
+    delete surf;
+  }
+}
+
+TEST_F(CompressedSuRFUnitTest, lookupPrefixWordTest) {
+  for (int t = 0; t < kNumEncoderType; t++) {
+    CompressedSuRF *surf = new CompressedSuRF(words, kEncoderTypeList[t], kDictSizeLimit);
+    ASSERT_TRUE(surf->lookupPrefix(std::string()));
+    for (int i = 0; i < (int)words.size(); i++) {
+      for (int len = 1; len <= (int)words[i].length(); len++)
+        ASSERT_TRUE(surf->lookupPrefix(words[i].substr(0, len)));
+    }
+    delete surf;
+  }
+}
+
+TEST_F(CompressedSuRFUnitTest, moveToKeyGreaterThanTest) {
+  CompressedSuRF *surf = new CompressedSuRF(words, 3, kDictSizeLimit);
+  for (int i = 0; i < (int)words.size() - 1; i++) {
+    SuRF::Iter iter = surf->moveToKeyGreaterThan(words[i], true);
+    ASSERT_TRUE(iter.isValid());
+    iter = surf->moveToKeyGreaterThan(words[i], false);
+    ASSERT_TRUE(iter.isValid());
+  }
+  delete surf;
+}
+
+TEST_F(CompressedSuRFUnitTest, concurrentLookupTest) {
+  CompressedSuRF *surf = new CompressedSuRF(words, 4, kDictSizeLimit);
+  static const int kNumThreads = 4;
+  std::vector<int> num_found(kNumThreads, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.push_back(std::thread([&, t]() {
+      for (int i = t; i < (int)words.size(); i += kNumThreads) num_found[t] += (int)surf->lookupKey(words[i]);
+    }));
+  }
+  int total_found = 0;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads[t].join();
+    total_found += num_found[t];
+  }
+  EXPECT_EQ((int)words.size(), total_found);
+  delete surf;
+}
+
+void loadWordList() {
+  std::ifstream infile(kFilePath);
+  std::string key;
+  int count = 0;
+  while (infile.good() && count < kWordTestSize) {
+    infile >> key;
+    words.push_back(key);
+    count++;
+  }
+}
+
+}  // namespace compressedsurftest
+
+}  // namespace surf
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  surf::compressedsurftest::loadWordList();
+  return RUN_ALL_TESTS();
+}
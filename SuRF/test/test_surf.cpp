@@ -114,6 +114,22 @@ TEST_F(SuRFUnitTest, lookupRangeWordTest) {
   }
 }
 
+// A key that is missing from a node with a terminator label must still
+// move to the next greater label of that node
+TEST_F(SuRFUnitTest, moveToKeyGreaterThanTerminatorTest) {
+  std::vector<std::string> keys = {std::string("ab"), std::string("abb"), std::string("abc"), std::string("abd"),
+                                   std::string("abf"), std::string("aca"), std::string("acb")};
+  for (int include_dense = 0; include_dense < 2; include_dense++) {
+    surf_ = new SuRF(keys, include_dense, kSparseDenseRatio, kNone, 0, 0);
+    SuRF::Iter iter = surf_->moveToKeyGreaterThan(std::string("abe"), true);
+    ASSERT_TRUE(iter.isValid());
+    ASSERT_EQ(std::string("abf"), iter.getKey());
+    ASSERT_TRUE(surf_->lookupRange(std::string("abe"), true, std::string("abg"), false));
+    surf_->destroy();
+    delete surf_;
+  }
+}
+
 void loadWordList() {
   std::ifstream infile(kFilePath);
   std::string key;
@@ -6,6 +6,7 @@
 #include <iostream>
 
 #include "encoder_factory.hpp"
+#include "key_set.hpp"
 #include "parameters.h"
 
 static const int64_t MAX_THREE = 80000;
@@ -27,22 +28,12 @@ int getByteLen(const int bitlen) { return ((bitlen + 7) & ~7) / 8; }
 
 int64_t loadKeys(const std::string &file_name, const int sample_percent, std::vector<std::string> &keys,
                  std::vector<std::string> &keys_shuffle) {
-  std::ifstream infile(file_name);
-  int step_size = 100 / sample_percent;
-  std::string key;
-  int64_t total_len = 0;
-  int count = 0;
-  while (infile.good()) {
-    infile >> key;
-    keys.push_back(key);
-    total_len += key.length();
-    count++;
-  }
-  std::random_shuffle(keys.begin(), keys.end());
-  for (int i = 0; i < (int)keys.size(); i += step_size) {
-    keys_shuffle.push_back(keys[i]);
-  }
-  return total_len;
+  benchharness::KeySet key_set;
+  if (!key_set.open(file_name)) return 0;
+  benchharness::KeyIds ids = key_set.shuffledIds(0);
+  keys = key_set.strings(ids);
+  keys_shuffle = key_set.strings(benchharness::KeySet::sample(ids, 100 / sample_percent));
+  return key_set.totalLength(ids);
 }
 
 std::string uint64ToString(uint64_t key) {
@@ -0,0 +1,276 @@
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PrefixBtree.h"
+#include "Tree.h"
+#include "encoder_factory.hpp"
+#include "key_set.hpp"
+
+// Usage: bench_concurrent <key_file> <art|btree> [encoder_type] [dict_size] [max_threads]
+// Inserts and then looks up all the keys in a fresh index with 1, 2, 4, ...
+// max_threads threads. Every thread encodes its own slice of the keys with
+// the shared (read-only) encoder; encoder_type 0 means uncompressed keys.
+// Prints the throughput and speedup of both phases and the number of
+// optimistic-lock restarts taken.
+namespace concurrentbench {
+
+static const int kIndexART = 0;
+static const int kIndexBTree = 1;
+static const int kDefaultDictSize = 65536;
+static const int kSamplePercent = 20;
+
+struct PhaseResult {
+  double mops;
+  uint64_t restarts;
+  int64_t num_found;
+};
+
+int encodeKey(const hope::Encoder *encoder, const std::string &key, uint8_t *buffer) {
+  if (encoder == nullptr) {
+    memcpy(buffer, key.data(), key.length());
+    return (int)key.length();
+  }
+  return (encoder->encode(key, buffer) + 7) >> 3;
+}
+
+// Drops keys whose encoding collides with another key's (padding can map
+// neighboring keys to the same bytes). ART cannot store a key that is a
+// prefix of another one either.
+void filterKeys(const hope::Encoder *encoder, const bool drop_prefix_keys, std::vector<std::string> &keys) {
+  std::vector<std::pair<std::string, int>> enc_keys;
+  std::vector<uint8_t> buffer;
+  for (int i = 0; i < (int)keys.size(); i++) {
+    buffer.resize(keys[i].length() * 4 + 16);
+    int len = encodeKey(encoder, keys[i], buffer.data());
+    enc_keys.push_back(std::make_pair(std::string((const char *)buffer.data(), len), i));
+  }
+  std::sort(enc_keys.begin(), enc_keys.end());
+  std::vector<std::string> kept;
+  for (int i = 0; i < (int)enc_keys.size(); i++) {
+    const std::string &cur = enc_keys[i].first;
+    if (cur.empty()) continue;
+    if (i > 0 && enc_keys[i - 1].first == cur) continue;
+    if (i + 1 < (int)enc_keys.size()) {
+      const std::string &next = enc_keys[i + 1].first;
+      if (next == cur) continue;
+      if (drop_prefix_keys && next.compare(0, cur.length(), cur) == 0) continue;
+    }
+    kept.push_back(keys[enc_keys[i].second]);
+  }
+  keys.swap(kept);
+}
+
+// What one thread counted in a phase
+struct ThreadCounts {
+  uint64_t restarts = 0;
+  int64_t num_found = 0;
+};
+
+// Runs op(thread_id, key_id, buffer, counts) over [0, n) split evenly
+// across the threads. Every thread counts into a local ThreadCounts and
+// stores it into (*counts)[thread_id] once, when it is done, so that the
+// threads do not write to neighboring slots while they run
+template <class Op>
+double runThreads(const int num_threads, const int64_t n, const int max_key_len, Op op,
+		  std::vector<ThreadCounts> *counts) {
+  counts->assign(num_threads, ThreadCounts());
+  std::atomic<int> num_ready(0);
+  std::atomic<bool> go(false);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.push_back(std::thread([&, t]() {
+      std::vector<uint8_t> buffer(max_key_len * 4 + 16);
+      ThreadCounts local_counts;
+      int64_t begin = n * t / num_threads;
+      int64_t end = n * (t + 1) / num_threads;
+      num_ready++;
+      while (!go.load()) std::this_thread::yield();
+      for (int64_t i = begin; i < end; i++) op(t, i, buffer.data(), local_counts);
+      (*counts)[t] = local_counts;
+    }));
+  }
+  while (num_ready.load() < num_threads) std::this_thread::yield();
+  double start_time = hope::getNow();
+  go = true;
+  for (auto &thread : threads) thread.join();
+  return hope::getNow() - start_time;
+}
+
+// Sums the counts of all the threads into result
+void addCounts(const std::vector<ThreadCounts> &counts, PhaseResult *result) {
+  result->restarts = 0;
+  result->num_found = 0;
+  for (const ThreadCounts &count : counts) {
+    result->restarts += count.restarts;
+    result->num_found += count.num_found;
+  }
+}
+
+void runART(const hope::Encoder *encoder, const std::vector<std::string> &keys,
+	    const std::vector<int64_t> &lookup_order, const int num_threads, const int max_key_len,
+	    PhaseResult *insert_result, PhaseResult *lookup_result) {
+  int64_t n = (int64_t)keys.size();
+  // leaves keep a copy of the encoded key, so no key store is needed
+  ART_ROWEX::Tree *art = new ART_ROWEX::Tree();
+  std::vector<ThreadCounts> counts;
+
+  std::vector<ThreadInfo> thread_infos;
+  for (int t = 0; t < num_threads; t++) thread_infos.push_back(art->getThreadInfo());
+  double time = runThreads(
+      num_threads, n, max_key_len,
+      [&](int t, int64_t i, uint8_t *buffer, ThreadCounts &count) {
+	if (i == n * t / num_threads) ART_ROWEX::Tree::threadRestartCount() = 0;
+	Key key;
+	key.set((const char *)buffer, encodeKey(encoder, keys[i], buffer));
+	art->insert(key, (TID)(i + 1), thread_infos[t]);
+	count.restarts = ART_ROWEX::Tree::threadRestartCount();
+      },
+      &counts);
+  insert_result->mops = n / time / 1000000;
+  addCounts(counts, insert_result);
+  insert_result->num_found = n;
+
+  // point lookups take no locks, so they never restart
+  time = runThreads(
+      num_threads, n, max_key_len,
+      [&](int t, int64_t i, uint8_t *buffer, ThreadCounts &count) {
+	int64_t key_id = lookup_order[i];
+	Key key;
+	key.set((const char *)buffer, encodeKey(encoder, keys[key_id], buffer));
+	count.num_found += (art->lookup(key, thread_infos[t]) == (TID)(key_id + 1));
+      },
+      &counts);
+  lookup_result->mops = n / time / 1000000;
+  addCounts(counts, lookup_result);
+  thread_infos.clear();
+  delete art;
+}
+
+void runBTree(const hope::Encoder *encoder, const std::vector<std::string> &keys,
+	      const std::vector<int64_t> &lookup_order, const int num_threads, const int max_key_len,
+	      PhaseResult *insert_result, PhaseResult *lookup_result) {
+  typedef prefixbtreeolc::BTree<int64_t> BTree;
+  int64_t n = (int64_t)keys.size();
+  BTree *bt = new BTree();
+  std::vector<ThreadCounts> counts;
+
+  double time = runThreads(
+      num_threads, n, max_key_len,
+      [&](int t, int64_t i, uint8_t *buffer, ThreadCounts &count) {
+	if (i == n * t / num_threads) BTree::threadRestartCount() = 0;
+	prefixbtreeolc::Key key;
+	key.setKeyStr((const char *)buffer, encodeKey(encoder, keys[i], buffer));
+	bt->insert(key, i);
+	count.restarts = BTree::threadRestartCount();
+      },
+      &counts);
+  insert_result->mops = n / time / 1000000;
+  addCounts(counts, insert_result);
+  insert_result->num_found = n;
+
+  time = runThreads(
+      num_threads, n, max_key_len,
+      [&](int t, int64_t i, uint8_t *buffer, ThreadCounts &count) {
+	if (i == n * t / num_threads) BTree::threadRestartCount() = 0;
+	int64_t key_id = lookup_order[i];
+	prefixbtreeolc::Key key;
+	key.setKeyStr((const char *)buffer, encodeKey(encoder, keys[key_id], buffer));
+	int64_t value = -1;
+	count.num_found += (bt->lookup(key, value) && value == key_id);
+	count.restarts = BTree::threadRestartCount();
+      },
+      &counts);
+  lookup_result->mops = n / time / 1000000;
+  addCounts(counts, lookup_result);
+  delete bt;
+}
+
+}  // namespace concurrentbench
+
+using namespace concurrentbench;
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    std::cout << "Usage: " << argv[0] << " <key_file> <art|btree> [encoder_type] [dict_size] [max_threads]"
+	      << std::endl;
+    return 1;
+  }
+  std::string index_name = argv[2];
+  int index_type = (index_name == "art") ? kIndexART : kIndexBTree;
+  if (index_name != "art" && index_name != "btree") {
+    std::cout << "Unknown index " << index_name << std::endl;
+    return 1;
+  }
+  int encoder_type = (argc > 3) ? atoi(argv[3]) : 0;
+  int64_t dict_size = (argc > 4) ? atoll(argv[4]) : kDefaultDictSize;
+  int max_threads = (argc > 5) ? atoi(argv[5]) : (int)std::thread::hardware_concurrency();
+  if (max_threads < 1) max_threads = 1;
+
+  benchharness::KeySet key_set;
+  if (!key_set.open(argv[1])) {
+    std::cout << "Cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+  benchharness::KeyIds key_ids = key_set.ids();
+  key_set.sortIds(&key_ids, true);
+  std::vector<std::string> keys = key_set.strings(key_ids);
+
+  hope::Encoder *encoder = nullptr;
+  if (encoder_type > 0) {
+    std::vector<std::string> sample;
+    for (int i = 0; i < (int)keys.size(); i += 100 / kSamplePercent) sample.push_back(keys[i]);
+    encoder = hope::EncoderFactory::createEncoder(encoder_type);
+    encoder->build(sample, dict_size);
+  }
+  filterKeys(encoder, index_type == kIndexART, keys);
+  int max_key_len = 0;
+  for (const auto &k : keys) max_key_len = std::max(max_key_len, (int)k.length());
+
+  std::mt19937_64 rng(0);
+  std::shuffle(keys.begin(), keys.end(), rng);
+  std::vector<int64_t> lookup_order(keys.size());
+  for (int64_t i = 0; i < (int64_t)keys.size(); i++) lookup_order[i] = i;
+  std::shuffle(lookup_order.begin(), lookup_order.end(), rng);
+
+  std::cout << "index = " << index_name << ", encoder type = " << encoder_type << ", keys = " << keys.size()
+	    << ", hardware threads = " << std::thread::hardware_concurrency() << std::endl;
+  std::cout << std::setw(8) << "threads" << std::setw(12) << "insert_mops" << std::setw(10) << "speedup"
+	    << std::setw(12) << "restarts" << std::setw(12) << "lookup_mops" << std::setw(10) << "speedup"
+	    << std::setw(12) << "restarts" << std::endl;
+  std::vector<int> thread_counts;
+  for (int t = 1; t < max_threads; t *= 2) thread_counts.push_back(t);
+  thread_counts.push_back(max_threads);
+
+  PhaseResult base_insert = PhaseResult(), base_lookup = PhaseResult();
+  bool ok = true;
+  for (int num_threads : thread_counts) {
+    PhaseResult insert_result, lookup_result;
+    if (index_type == kIndexART)
+      runART(encoder, keys, lookup_order, num_threads, max_key_len, &insert_result, &lookup_result);
+    else
+      runBTree(encoder, keys, lookup_order, num_threads, max_key_len, &insert_result, &lookup_result);
+    if (num_threads == 1) {
+      base_insert = insert_result;
+      base_lookup = lookup_result;
+    }
+    std::cout << std::fixed << std::setprecision(3) << std::setw(8) << num_threads << std::setw(12)
+	      << insert_result.mops << std::setw(10) << insert_result.mops / base_insert.mops << std::setw(12)
+	      << insert_result.restarts << std::setw(12) << lookup_result.mops << std::setw(10)
+	      << lookup_result.mops / base_lookup.mops << std::setw(12) << lookup_result.restarts << std::endl;
+    if (lookup_result.num_found != (int64_t)keys.size()) {
+      std::cout << "Lookups found " << lookup_result.num_found << " of " << keys.size() << " keys" << std::endl;
+      ok = false;
+    }
+  }
+  delete encoder;
+  return ok ? 0 : 2;
+}
@@ -0,0 +1,470 @@
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_harness.hpp"
+#include "encoder_factory.hpp"
+#include "index_adapters.hpp"
+#include "key_set.hpp"
+#include "latency_histogram.hpp"
+#include "perf_counters.hpp"
+#include "workload_generator.hpp"
+
+// Usage: bench_driver [--option=value ...]; see --help
+// Runs one benchmark configuration: builds the encoder on a sample of
+// the dataset, loads the encoded keys into the index, and runs a YCSB
+// point or range workload on them, --reps times. Writes one record with
+// the configuration and the statistics of every metric, as JSON or CSV.
+// With --latency=1, an extra pass after the throughput run times every
+// --latency_sample-th operation's encode, encodePair, decode and index
+// operation with the cycle counter, and adds their percentiles overall
+// and by raw key length to the record. With --perf=1, the available
+// hardware counters (cycles, instructions, cache, TLB and branch misses)
+// are added per key for an encode-only pass and the inserts, and per
+// operation for the transactions.
+namespace benchdriver {
+
+using benchharness::IndexAdapter;
+
+struct RepResult {
+  double encoder_build_sec = 0;
+  // the encoder's BuildStats, as build_<name>
+  std::vector<std::pair<std::string, double> > build_metrics;
+  double insert_mops = 0;
+  double txn_mops = 0;
+  double memory_bytes = 0;
+  double index_memory_bytes = 0;
+  double encoder_memory_bytes = 0;
+  double compression_rate = 1;
+  int64_t num_found = 0;
+  int64_t num_scanned = 0;
+  // filled with --latency=1; the index histograms are lookup or scan ones
+  benchharness::KeyLengthHistograms encode_latency;
+  benchharness::KeyLengthHistograms encode_pair_latency;
+  benchharness::KeyLengthHistograms decode_latency;
+  benchharness::KeyLengthHistograms index_latency;
+  // filled with --perf=1
+  std::vector<std::pair<std::string, double> > perf_metrics;
+  bool perf_hardware = false;
+};
+
+// What one thread found in the transactions
+struct TxnCounts {
+  int64_t num_found = 0;
+  int64_t num_scanned = 0;
+};
+
+double getNow() {
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+void addOptions(benchharness::Options *options) {
+  options->add("dataset", "datasets/words.txt", "key file, one key per line");
+  options->add("num_keys", "0", "keys to load from the dataset; 0 for all");
+  options->add("index", "btree", "btree, art, prefix_btree or surf");
+  options->add("encoder", "0", "encoder type 1-6; 0 for uncompressed keys");
+  options->add("dict_size", "65536", "dictionary size limit");
+  options->add("sample_percent", "1", "percentage of the keys the encoder is built on");
+  options->add("workload", "point", "point or range");
+  options->add("distribution", "zipfian", "uniform, zipfian or latest");
+  options->add("num_txns", "1000000", "operations per repetition");
+  options->add("max_scan_len", "100", "scan lengths are uniform in [1, max_scan_len]");
+  options->add("threads", "1", "threads running the operations");
+  options->add("reps", "3", "repetitions");
+  options->add("seed", "0", "seed of the insert order and the workload");
+  options->add("latency", "0", "1 to add per-operation latency percentiles");
+  options->add("latency_sample", "1", "time every n-th operation in the latency pass");
+  options->add("perf", "0", "1 to add hardware counters per key and per operation");
+  options->add("format", "json", "json or csv");
+  options->add("output", "", "file to append the record to; stdout if empty");
+}
+
+int encodeKey(const hope::Encoder *encoder, const std::string &key, uint8_t *buffer) {
+  if (encoder == nullptr) {
+    memcpy(buffer, key.data(), key.length());
+    return (int)key.length();
+  }
+  return (encoder->encode(key, buffer) + 7) >> 3;
+}
+
+// Drops keys whose encoding collides with another key's (padding can map
+// neighboring keys to the same bytes), and keys whose encoding prefixes
+// another one's if the index needs that
+void filterKeys(const hope::Encoder *encoder, const bool drop_prefix_keys, std::vector<std::string> &keys) {
+  std::vector<std::pair<std::string, int> > enc_keys;
+  std::vector<uint8_t> buffer;
+  for (int i = 0; i < (int)keys.size(); i++) {
+    buffer.resize(keys[i].length() * 4 + 16);
+    int len = encodeKey(encoder, keys[i], buffer.data());
+    enc_keys.push_back(std::make_pair(std::string((const char *)buffer.data(), len), i));
+  }
+  std::sort(enc_keys.begin(), enc_keys.end());
+  std::vector<std::string> kept;
+  for (int i = 0; i < (int)enc_keys.size(); i++) {
+    const std::string &cur = enc_keys[i].first;
+    if (cur.empty()) continue;
+    if (i > 0 && enc_keys[i - 1].first == cur) continue;
+    if (i + 1 < (int)enc_keys.size()) {
+      const std::string &next = enc_keys[i + 1].first;
+      if (next == cur) continue;
+      if (drop_prefix_keys && next.compare(0, cur.length(), cur) == 0) continue;
+    }
+    kept.push_back(keys[enc_keys[i].second]);
+  }
+  keys.swap(kept);
+}
+
+// Runs op(thread_id, op_id, buffer, state) over [0, n) split evenly across
+// the threads. Every thread updates a local State and stores it into
+// (*states)[thread_id] once, when it is done, so that the threads do not
+// write to neighboring slots while they run
+template <class State, class Op>
+double runThreads(const int num_threads, const int64_t n, const int max_key_len, Op op, std::vector<State> *states) {
+  states->assign(num_threads, State());
+  std::atomic<int> num_ready(0);
+  std::atomic<bool> go(false);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.push_back(std::thread([&, t]() {
+      std::vector<uint8_t> buffer(max_key_len * 4 + 16);
+      State state = State();
+      int64_t begin = n * t / num_threads;
+      int64_t end = n * (t + 1) / num_threads;
+      num_ready++;
+      while (!go.load()) std::this_thread::yield();
+      for (int64_t i = begin; i < end; i++) op(t, i, buffer.data(), state);
+      (*states)[t] = state;
+    }));
+  }
+  while (num_ready.load() < num_threads) std::this_thread::yield();
+  double start_time = getNow();
+  go = true;
+  for (auto &thread : threads) thread.join();
+  return getNow() - start_time;
+}
+
+// Runs op(thread_id, op_id, buffer) over [0, n) split evenly across the threads
+template <class Op>
+double runThreads(const int num_threads, const int64_t n, const int max_key_len, Op op) {
+  std::vector<char> states;
+  return runThreads(num_threads, n, max_key_len, [&](int t, int64_t i, uint8_t *buf, char &) { op(t, i, buf); },
+		    &states);
+}
+
+// The first num_keys keys of the file (all if 0), sorted and deduplicated
+bool loadKeys(const std::string &file_name, const int64_t num_keys, std::vector<std::string> &keys) {
+  benchharness::KeySet key_set;
+  if (!key_set.open(file_name)) return false;
+  benchharness::KeyIds ids = key_set.ids(num_keys);
+  key_set.sortIds(&ids, true);
+  keys = key_set.strings(ids);
+  return true;
+}
+
+hope::Encoder *buildEncoder(const benchharness::Options &options, const std::vector<std::string> &keys) {
+  int encoder_type = (int)options.getInt("encoder");
+  if (encoder_type == 0) return nullptr;
+  int64_t step = std::max((int64_t)1, (int64_t)(100 / options.getDouble("sample_percent")));
+  std::vector<std::string> sample;
+  for (int64_t i = step / 2; i < (int64_t)keys.size(); i += step) sample.push_back(keys[i]);
+  hope::Encoder *encoder = hope::EncoderFactory::createEncoder(encoder_type);
+  encoder->setResetPeakRss(true);
+  encoder->build(sample, options.getInt("dict_size"));
+  return encoder;
+}
+
+// Times the sampled operations one part at a time. encodePair encodes
+// the key with its neighbor in the insert order, which is random
+void measureLatency(const hope::Encoder *encoder, IndexAdapter *index, const std::vector<std::string> &keys,
+		    const std::vector<workloadgen::Operation> &ops, const int num_threads, const int max_key_len,
+		    const int64_t sample_every, RepResult *result) {
+  int64_t step = std::max((int64_t)1, sample_every);
+  int64_t num_samples = ((int64_t)ops.size() + step - 1) / step;
+  int buffer_len = max_key_len * 4 + 16;
+  std::vector<benchharness::KeyLengthHistograms> encode_latency(num_threads), encode_pair_latency(num_threads),
+      decode_latency(num_threads), index_latency(num_threads);
+  std::vector<std::vector<uint8_t> > scratch(num_threads, std::vector<uint8_t>(buffer_len * 3));
+  runThreads(num_threads, num_samples, max_key_len, [&](int t, int64_t i, uint8_t *buf) {
+    const workloadgen::Operation &op = ops[i * step];
+    const std::string &raw_key = keys[op.key_id];
+    int key_len = (int)raw_key.length();
+    uint64_t start = benchharness::readCycles();
+    int bit_len = (encoder == nullptr) ? 0 : encoder->encode(raw_key, buf);
+    int len = (encoder == nullptr) ? encodeKey(encoder, raw_key, buf) : (bit_len + 7) >> 3;
+    uint64_t end = benchharness::readCycles();
+    encode_latency[t].record(key_len, end - start);
+
+    std::string key((const char *)buf, len);
+    start = benchharness::readCycles();
+    if (op.type == workloadgen::kScan) {
+      index->scan(t, key, op.scan_len);
+    } else {
+      uint64_t value = 0;
+      index->lookup(t, key, &value);
+    }
+    end = benchharness::readCycles();
+    index_latency[t].record(key_len, end - start);
+    if (encoder == nullptr) return;
+
+    uint8_t *decode_buf = scratch[t].data();
+    start = benchharness::readCycles();
+    encoder->decode(key, bit_len, decode_buf);
+    end = benchharness::readCycles();
+    decode_latency[t].record(key_len, end - start);
+
+    const std::string &neighbor = keys[(op.key_id + 1) % (int64_t)keys.size()];
+    const std::string &l_key = std::min(raw_key, neighbor);
+    const std::string &r_key = std::max(raw_key, neighbor);
+    uint8_t *l_buf = scratch[t].data() + buffer_len;
+    uint8_t *r_buf = scratch[t].data() + buffer_len * 2;
+    int l_len = 0, r_len = 0;
+    start = benchharness::readCycles();
+    encoder->encodePair(l_key, r_key, l_buf, r_buf, l_len, r_len);
+    end = benchharness::readCycles();
+    encode_pair_latency[t].record((int)std::max(l_key.length(), r_key.length()), end - start);
+  });
+  for (int t = 0; t < num_threads; t++) {
+    result->encode_latency.merge(encode_latency[t]);
+    result->encode_pair_latency.merge(encode_pair_latency[t]);
+    result->decode_latency.merge(decode_latency[t]);
+    result->index_latency.merge(index_latency[t]);
+  }
+}
+
+// keys are in insert order; ops index into them
+RepResult runRep(const benchharness::Options &options, const std::vector<std::string> &sorted_keys,
+		 const std::vector<std::string> &keys, const std::vector<workloadgen::Operation> &ops) {
+  RepResult result;
+  double start_time = getNow();
+  hope::Encoder *encoder = buildEncoder(options, sorted_keys);
+  result.encoder_build_sec = getNow() - start_time;
+  if (encoder != nullptr) {
+    for (const auto &metric : encoder->buildStats().metrics())
+      result.build_metrics.push_back(std::make_pair("build_" + metric.first, metric.second));
+  }
+  IndexAdapter *index = benchharness::createIndex(options.get("index"));
+  int max_key_len = 0;
+  for (const std::string &key : keys) max_key_len = std::max(max_key_len, (int)key.length());
+
+  std::vector<uint8_t> buffer(max_key_len * 4 + 16);
+  bool count_perf = options.getInt("perf") != 0;
+  // opened before the transaction threads start, so that they inherit it
+  std::unique_ptr<benchharness::PerfCounters> counters(count_perf ? new benchharness::PerfCounters() : nullptr);
+  auto addPerf = [&](const std::string &phase, const double num_ops, const std::string &unit) {
+    counters->stop();
+    for (const auto &metric : counters->perOp(phase, num_ops, unit)) result.perf_metrics.push_back(metric);
+  };
+  if (count_perf) {
+    result.perf_hardware = counters->hardwareAvailable();
+    counters->start();
+    for (const std::string &key : keys) encodeKey(encoder, key, buffer.data());
+    addPerf("encode", (double)keys.size(), "key");
+  }
+
+  int64_t total_key_len = 0, total_enc_len = 0;
+  if (count_perf) counters->start();
+  start_time = getNow();
+  for (int64_t i = 0; i < (int64_t)keys.size(); i++) {
+    int len = encodeKey(encoder, keys[i], buffer.data());
+    index->insert(std::string((const char *)buffer.data(), len), (uint64_t)i);
+    total_key_len += keys[i].length();
+    total_enc_len += len;
+  }
+  index->finishLoad();
+  result.insert_mops = keys.size() / (getNow() - start_time) / 1000000;
+  if (count_perf) addPerf("insert", (double)keys.size(), "key");
+  result.index_memory_bytes = (double)index->memoryUse();
+  result.encoder_memory_bytes = (encoder == nullptr) ? 0 : (double)encoder->memoryUse();
+  result.memory_bytes = result.index_memory_bytes + result.encoder_memory_bytes;
+  result.compression_rate = total_key_len / (double)total_enc_len;
+
+  int num_threads = std::max(1, (int)options.getInt("threads"));
+  index->prepareThreads(num_threads);
+  std::vector<TxnCounts> counts;
+  bool check_values = index->storesValues();
+  if (count_perf) counters->start();
+  double time = runThreads(
+      num_threads, (int64_t)ops.size(), max_key_len,
+      [&](int t, int64_t i, uint8_t *buf, TxnCounts &count) {
+	const workloadgen::Operation &op = ops[i];
+	int len = encodeKey(encoder, keys[op.key_id], buf);
+	std::string key((const char *)buf, len);
+	if (op.type == workloadgen::kScan) {
+	  count.num_scanned += index->scan(t, key, op.scan_len);
+	} else {
+	  uint64_t value = 0;
+	  bool found = index->lookup(t, key, &value);
+	  count.num_found += found && (!check_values || value == (uint64_t)op.key_id);
+	}
+      },
+      &counts);
+  result.txn_mops = ops.size() / time / 1000000;
+  if (count_perf) addPerf("txn", (double)ops.size(), "op");
+  for (const TxnCounts &count : counts) {
+    result.num_found += count.num_found;
+    result.num_scanned += count.num_scanned;
+  }
+  if (options.getInt("latency") != 0)
+    measureLatency(encoder, index, keys, ops, num_threads, max_key_len, options.getInt("latency_sample"), &result);
+  delete index;
+  delete encoder;
+  return result;
+}
+
+}  // namespace benchdriver
+
+using namespace benchdriver;
+
+int main(int argc, char *argv[]) {
+  benchharness::Options options;
+  addOptions(&options);
+  std::string error;
+  if (!options.parse(argc, argv, &error) || options.helpRequested()) {
+    if (!error.empty()) std::cerr << error << std::endl;
+    std::cerr << "Usage: " << argv[0] << " [--option=value ...]\n";
+    options.printHelp(std::cerr);
+    return error.empty() ? 0 : 1;
+  }
+
+  benchharness::ResultWriter::Format format;
+  if (!benchharness::ResultWriter::parseFormat(options.get("format"), &format)) {
+    std::cerr << "Unknown format " << options.get("format") << std::endl;
+    return 1;
+  }
+  IndexAdapter *probe_index = benchharness::createIndex(options.get("index"));
+  if (probe_index == nullptr) {
+    std::cerr << "Unknown index " << options.get("index") << std::endl;
+    return 1;
+  }
+  bool drop_prefix_keys = probe_index->needsPrefixFreeKeys();
+  delete probe_index;
+  int encoder_type = (int)options.getInt("encoder");
+  if (encoder_type < 0 || encoder_type > 6) {
+    std::cerr << "Unknown encoder " << encoder_type << std::endl;
+    return 1;
+  }
+  bool is_point = (options.get("workload") == "point");
+  if (!is_point && options.get("workload") != "range") {
+    std::cerr << "Unknown workload " << options.get("workload") << std::endl;
+    return 1;
+  }
+
+  // the indexes print their stats to std::cout; keep stdout for the record
+  std::streambuf *stdout_buf = std::cout.rdbuf(std::cerr.rdbuf());
+
+  std::vector<std::string> sorted_keys;
+  if (!loadKeys(options.get("dataset"), options.getInt("num_keys"), sorted_keys) || sorted_keys.empty()) {
+    std::cerr << "Cannot load keys from " << options.get("dataset") << std::endl;
+    return 1;
+  }
+  // the keys an index can hold under this encoder, in a seeded insert order
+  std::vector<std::string> keys = sorted_keys;
+  hope::Encoder *encoder = buildEncoder(options, sorted_keys);
+  filterKeys(encoder, drop_prefix_keys, keys);
+  delete encoder;
+  uint64_t seed = (uint64_t)options.getInt("seed");
+  std::mt19937_64 rng(seed);
+  std::shuffle(keys.begin(), keys.end(), rng);
+
+  workloadgen::WorkloadSpec spec;
+  spec.record_count = (int64_t)keys.size();
+  spec.operation_count = options.getInt("num_txns");
+  spec.read_proportion = is_point ? 1 : 0;
+  spec.scan_proportion = is_point ? 0 : 1;
+  spec.request_distribution = workloadgen::parseDistribution(options.get("distribution"));
+  spec.max_scan_length = (int)options.getInt("max_scan_len");
+  workloadgen::WorkloadGenerator generator(spec, seed);
+  std::vector<workloadgen::Operation> ops;
+  for (int64_t i = 0; i < spec.operation_count; i++) ops.push_back(generator.next());
+
+  std::vector<double> encoder_build_sec, insert_mops, txn_mops, memory_bytes, index_memory_bytes,
+      encoder_memory_bytes, compression_rate;
+  benchharness::LatencyMetrics latency_metrics;
+  benchharness::MetricSeries build_metrics, perf_metrics;
+  benchharness::KeyLengthHistograms encode_latency, encode_pair_latency, decode_latency, index_latency;
+  bool measure_latency = options.getInt("latency") != 0;
+  bool warned_perf = false;
+  bool ok = true;
+  int num_reps = std::max(1, (int)options.getInt("reps"));
+  for (int rep = 0; rep < num_reps; rep++) {
+    RepResult result = runRep(options, sorted_keys, keys, ops);
+    encoder_build_sec.push_back(result.encoder_build_sec);
+    insert_mops.push_back(result.insert_mops);
+    txn_mops.push_back(result.txn_mops);
+    memory_bytes.push_back(result.memory_bytes);
+    index_memory_bytes.push_back(result.index_memory_bytes);
+    encoder_memory_bytes.push_back(result.encoder_memory_bytes);
+    compression_rate.push_back(result.compression_rate);
+    if (measure_latency) {
+      std::string index_op = is_point ? "lookup" : "scan";
+      latency_metrics.add("encode", result.encode_latency);
+      latency_metrics.add(index_op, result.index_latency);
+      encode_latency.merge(result.encode_latency);
+      index_latency.merge(result.index_latency);
+      if (encoder_type != 0) {
+	latency_metrics.add("decode", result.decode_latency);
+	latency_metrics.add("encode_pair", result.encode_pair_latency);
+	decode_latency.merge(result.decode_latency);
+	encode_pair_latency.merge(result.encode_pair_latency);
+      }
+    }
+    for (const auto &metric : result.build_metrics) build_metrics.add(metric.first, metric.second);
+    for (const auto &metric : result.perf_metrics) perf_metrics.add(metric.first, metric.second);
+    if (options.getInt("perf") != 0 && !result.perf_hardware && !warned_perf) {
+      std::cerr << "Hardware performance counters are unavailable; reporting the task clock only" << std::endl;
+      warned_perf = true;
+    }
+    if (is_point && result.num_found != (int64_t)ops.size()) {
+      std::cerr << "Lookups found " << result.num_found << " of " << ops.size() << " keys" << std::endl;
+      ok = false;
+    }
+  }
+
+  benchharness::Record record;
+  record.config = options.all();
+  record.config.push_back(std::make_pair("loaded_keys", std::to_string(keys.size())));
+  record.addMetric("encoder_build_sec", encoder_build_sec);
+  record.addMetric("insert_mops", insert_mops);
+  record.addMetric("txn_mops", txn_mops);
+  record.addMetric("memory_bytes", memory_bytes);
+  record.addMetric("index_memory_bytes", index_memory_bytes);
+  record.addMetric("encoder_memory_bytes", encoder_memory_bytes);
+  record.addMetric("compression_rate", compression_rate);
+  build_metrics.addTo(&record);
+  perf_metrics.addTo(&record);
+  if (measure_latency) {
+    latency_metrics.addTo(&record);
+    // over all the repetitions, for reading
+    benchharness::printLatencyReport(std::cerr, "encode", encode_latency);
+    benchharness::printLatencyReport(std::cerr, is_point ? "lookup" : "scan", index_latency);
+    if (encoder_type != 0) {
+      benchharness::printLatencyReport(std::cerr, "decode", decode_latency);
+      benchharness::printLatencyReport(std::cerr, "encode_pair", encode_pair_latency);
+    }
+  }
+  if (options.get("output").empty()) {
+    std::ostream stdout_stream(stdout_buf);
+    benchharness::ResultWriter writer(stdout_stream, format);
+    writer.write(record);
+  } else {
+    std::ifstream existing(options.get("output"));
+    bool is_new = existing.peek() == std::ifstream::traits_type::eof();
+    existing.close();
+    std::ofstream outfile(options.get("output"), std::ios::app);
+    benchharness::ResultWriter writer(outfile, format, is_new);
+    writer.write(record);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,275 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Named options, repetition statistics and JSON/CSV result records for
+// the benchmark driver (bench_driver.cpp)
+namespace benchharness {
+
+//------------------------------------------------------------------
+// Options are given as --name=value or --name value; every option has
+// a default and a help line, and unknown options are rejected
+//------------------------------------------------------------------
+class Options {
+ public:
+  void add(const std::string &name, const std::string &default_value, const std::string &help) {
+    if (values_.find(name) == values_.end()) names_.push_back(name);
+    values_[name] = default_value;
+    helps_[name] = help;
+  }
+
+  // Returns false (with a message in *error) on an unknown option or a
+  // missing value
+  bool parse(const int argc, const char *const argv[], std::string *error) {
+    for (int i = 1; i < argc; i++) {
+      std::string arg = argv[i];
+      if (arg.compare(0, 2, "--") != 0) {
+	*error = "unexpected argument " + arg;
+	return false;
+      }
+      std::string name, value;
+      size_t pos = arg.find('=');
+      if (pos != std::string::npos) {
+	name = arg.substr(2, pos - 2);
+	value = arg.substr(pos + 1);
+      } else {
+	name = arg.substr(2);
+	if (name == "help") {
+	  help_ = true;
+	  continue;
+	}
+	if (i + 1 >= argc) {
+	  *error = "missing value for --" + name;
+	  return false;
+	}
+	value = argv[++i];
+      }
+      if (values_.find(name) == values_.end()) {
+	*error = "unknown option --" + name;
+	return false;
+      }
+      values_[name] = value;
+    }
+    return true;
+  }
+
+  bool helpRequested() const { return help_; }
+
+  void printHelp(std::ostream &os) const {
+    for (const std::string &name : names_)
+      os << "  --" << std::left << std::setw(16) << name << helps_.at(name) << " (default: " << values_.at(name)
+	 << ")\n";
+  }
+
+  const std::string &get(const std::string &name) const { return values_.at(name); }
+  int64_t getInt(const std::string &name) const { return atoll(get(name).c_str()); }
+  double getDouble(const std::string &name) const { return atof(get(name).c_str()); }
+
+  // All the options in the order they were added, for the records
+  std::vector<std::pair<std::string, std::string> > all() const {
+    std::vector<std::pair<std::string, std::string> > options;
+    for (const std::string &name : names_) options.push_back(std::make_pair(name, values_.at(name)));
+    return options;
+  }
+
+ private:
+  std::vector<std::string> names_;
+  std::map<std::string, std::string> values_;
+  std::map<std::string, std::string> helps_;
+  bool help_ = false;
+};
+
+//------------------------------------------------------------------
+// Statistics over the repetitions of a measurement
+//------------------------------------------------------------------
+struct Stats {
+  double median = 0;
+  double mean = 0;
+  // sample variance; 0 for a single repetition
+  double variance = 0;
+  double min = 0;
+  double max = 0;
+};
+
+inline Stats computeStats(std::vector<double> values) {
+  Stats stats;
+  if (values.empty()) return stats;
+  std::sort(values.begin(), values.end());
+  size_t n = values.size();
+  stats.median = (n % 2 == 1) ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+  stats.min = values.front();
+  stats.max = values.back();
+  double sum = 0;
+  for (double value : values) sum += value;
+  stats.mean = sum / n;
+  if (n > 1) {
+    double sum_sq = 0;
+    for (double value : values) sum_sq += (value - stats.mean) * (value - stats.mean);
+    stats.variance = sum_sq / (n - 1);
+  }
+  return stats;
+}
+
+//------------------------------------------------------------------
+// A result record: the full configuration, then named metrics with
+// the statistics over the repetitions. Written as one JSON object per
+// line or as CSV rows with one metric per row, so that both formats
+// can be diffed cell by cell
+//------------------------------------------------------------------
+struct Record {
+  std::vector<std::pair<std::string, std::string> > config;
+  std::vector<std::pair<std::string, std::vector<double> > > metrics;
+
+  void addMetric(const std::string &name, const std::vector<double> &values) {
+    metrics.push_back(std::make_pair(name, values));
+  }
+};
+
+// Builds the metrics of a record one repetition at a time: add() appends
+// a value to the named metric, creating it on first use
+class MetricSeries {
+ public:
+  void add(const std::string &name, const double value) {
+    for (size_t i = 0; i < names_.size(); i++) {
+      if (names_[i] == name) {
+	values_[i].push_back(value);
+	return;
+      }
+    }
+    names_.push_back(name);
+    values_.push_back(std::vector<double>(1, value));
+  }
+
+  // Metrics missing from some repetitions keep the values they have
+  void addTo(Record *record) const {
+    for (size_t i = 0; i < names_.size(); i++) record->addMetric(names_[i], values_[i]);
+  }
+
+ private:
+  std::vector<std::string> names_;
+  std::vector<std::vector<double> > values_;
+};
+
+inline std::string jsonEscape(const std::string &str) {
+  std::string escaped;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+      escaped += c;
+    } else if ((unsigned char)c < 0x20) {
+      char hex[8];
+      snprintf(hex, sizeof(hex), "\\u%04x", (unsigned char)c);
+      escaped += hex;
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+inline std::string csvEscape(const std::string &str) {
+  if (str.find_first_of(",\"\n") == std::string::npos) return str;
+  std::string escaped = "\"";
+  for (char c : str) {
+    if (c == '"') escaped += '"';
+    escaped += c;
+  }
+  return escaped + "\"";
+}
+
+inline std::string formatDouble(const double value) {
+  std::ostringstream os;
+  os << std::setprecision(10) << value;
+  return os.str();
+}
+
+// JSON has no NaN or infinity; such values are written as null
+inline std::string jsonNumber(const double value) {
+  if (!std::isfinite(value)) return "null";
+  return formatDouble(value);
+}
+
+class ResultWriter {
+ public:
+  enum Format { kJson = 0, kCsv = 1 };
+
+  // Pass write_header = false to append CSV rows to an existing file
+  ResultWriter(std::ostream &os, const Format format, const bool write_header = true)
+      : os_(os), format_(format), wrote_header_(!write_header) {}
+
+  static bool parseFormat(const std::string &name, Format *format) {
+    if (name == "json")
+      *format = kJson;
+    else if (name == "csv")
+      *format = kCsv;
+    else
+      return false;
+    return true;
+  }
+
+  void write(const Record &record) {
+    if (format_ == kJson)
+      writeJson(record);
+    else
+      writeCsv(record);
+    os_.flush();
+  }
+
+ private:
+  void writeJson(const Record &record) {
+    os_ << "{\"config\":{";
+    for (size_t i = 0; i < record.config.size(); i++) {
+      if (i > 0) os_ << ",";
+      os_ << "\"" << jsonEscape(record.config[i].first) << "\":\"" << jsonEscape(record.config[i].second) << "\"";
+    }
+    os_ << "},\"metrics\":{";
+    for (size_t i = 0; i < record.metrics.size(); i++) {
+      const std::vector<double> &values = record.metrics[i].second;
+      Stats stats = computeStats(values);
+      if (i > 0) os_ << ",";
+      os_ << "\"" << jsonEscape(record.metrics[i].first) << "\":{\"median\":" << jsonNumber(stats.median)
+	  << ",\"mean\":" << jsonNumber(stats.mean) << ",\"variance\":" << jsonNumber(stats.variance)
+	  << ",\"min\":" << jsonNumber(stats.min) << ",\"max\":" << jsonNumber(stats.max) << ",\"values\":[";
+      for (size_t j = 0; j < values.size(); j++) os_ << (j > 0 ? "," : "") << jsonNumber(values[j]);
+      os_ << "]}";
+    }
+    os_ << "}}\n";
+  }
+
+  // The header is written with the first record
+  void writeCsv(const Record &record) {
+    if (!wrote_header_) {
+      for (const auto &option : record.config) os_ << csvEscape(option.first) << ",";
+      os_ << "metric,median,mean,variance,min,max,reps\n";
+      wrote_header_ = true;
+    }
+    for (const auto &metric : record.metrics) {
+      Stats stats = computeStats(metric.second);
+      for (const auto &option : record.config) os_ << csvEscape(option.second) << ",";
+      os_ << csvEscape(metric.first) << "," << formatDouble(stats.median) << "," << formatDouble(stats.mean) << ","
+	  << formatDouble(stats.variance) << "," << formatDouble(stats.min) << "," << formatDouble(stats.max) << ","
+	  << metric.second.size() << "\n";
+    }
+  }
+
+  std::ostream &os_;
+  Format format_;
+  bool wrote_header_;
+};
+
+}  // namespace benchharness
+
+#endif  // BENCH_HARNESS_H
@@ -0,0 +1,101 @@
+#ifndef CACHE_INFO_H
+#define CACHE_INFO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// The cache hierarchy of the machine, and the dictionary working sets
+// that the cache sweep of microbench (expt 11) places in it
+namespace benchharness {
+
+struct CacheLevel {
+  int level;
+  std::string name;  // e.g., L1d, L2, L3
+  int64_t size_bytes;
+  int line_bytes;
+};
+
+static const int kDefaultCacheLineBytes = 64;
+
+// "48K", "2048K", "16M" or a plain number of bytes; -1 if malformed
+inline int64_t parseCacheSize(const std::string &size) {
+  char *end = nullptr;
+  int64_t value = strtoll(size.c_str(), &end, 10);
+  if (end == size.c_str() || value < 0) return -1;
+  std::string unit(end);
+  if (!unit.empty() && unit.back() == '\n') unit.pop_back();
+  if (unit.empty()) return value;
+  if (unit == "K") return value << 10;
+  if (unit == "M") return value << 20;
+  if (unit == "G") return value << 30;
+  return -1;
+}
+
+// The data and unified caches of a CPU, smallest level first, from
+// <cpu_dir>/cache/index<i>/{level,type,size,coherency_line_size}. Falls
+// back to sysconf when sysfs lists none
+inline std::vector<CacheLevel> readCacheLevels(const std::string &cpu_dir = "/sys/devices/system/cpu/cpu0") {
+  std::vector<CacheLevel> levels;
+  for (int i = 0;; i++) {
+    std::string index_dir = cpu_dir + "/cache/index" + std::to_string(i) + "/";
+    std::ifstream level_file(index_dir + "level");
+    if (!level_file.is_open()) break;
+    std::ifstream type_file(index_dir + "type");
+    std::ifstream size_file(index_dir + "size");
+    std::ifstream line_file(index_dir + "coherency_line_size");
+    int level = 0;
+    std::string type, size;
+    int line_bytes = 0;
+    level_file >> level;
+    type_file >> type;
+    size_file >> size;
+    if (!(line_file >> line_bytes) || line_bytes <= 0) line_bytes = kDefaultCacheLineBytes;
+    int64_t size_bytes = parseCacheSize(size);
+    if (type == "Instruction" || level <= 0 || size_bytes <= 0) continue;
+    std::string name = "L" + std::to_string(level) + ((type == "Data") ? "d" : "");
+    levels.push_back(CacheLevel{level, name, size_bytes, line_bytes});
+  }
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+  if (levels.empty()) {
+    const int kNames[3] = {_SC_LEVEL1_DCACHE_SIZE, _SC_LEVEL2_CACHE_SIZE, _SC_LEVEL3_CACHE_SIZE};
+    for (int level = 1; level <= 3; level++) {
+      long size_bytes = sysconf(kNames[level - 1]);
+      if (size_bytes <= 0) continue;
+      std::string name = "L" + std::to_string(level) + ((level == 1) ? "d" : "");
+      levels.push_back(CacheLevel{level, name, size_bytes, kDefaultCacheLineBytes});
+    }
+  }
+#endif
+  std::stable_sort(levels.begin(), levels.end(),
+		   [](const CacheLevel &x, const CacheLevel &y) { return x.level < y.level; });
+  return levels;
+}
+
+// Bytes of a dictionary that its num_hot_entries most used entries keep
+// in cache: their share of memory_bytes, but at least a line each, as
+// hot entries are spread over the dictionary rather than packed together
+inline int64_t workingSetBytes(const int64_t memory_bytes, const int64_t num_entries, const int64_t num_hot_entries,
+			       const int line_bytes = kDefaultCacheLineBytes) {
+  if (num_entries <= 0 || num_hot_entries <= 0) return 0;
+  double bytes_per_entry = std::max((double)memory_bytes / num_entries, (double)line_bytes);
+  return std::min(memory_bytes, (int64_t)(bytes_per_entry * num_hot_entries));
+}
+
+// Index of the smallest level that holds bytes; levels.size() if none
+// does (the working set lives in memory)
+inline int fittingLevel(const std::vector<CacheLevel> &levels, const int64_t bytes) {
+  for (int i = 0; i < (int)levels.size(); i++) {
+    if (bytes <= levels[i].size_bytes) return i;
+  }
+  return (int)levels.size();
+}
+
+}  // namespace benchharness
+
+#endif  // CACHE_INFO_H
@@ -0,0 +1,93 @@
+#include <stdlib.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "key_set.hpp"
+#include "workload_generator.hpp"
+
+// Writes the workload files that the benchmarks read, in place of the
+// YCSB pipeline: ../workloads/load_<key type>, txn_<key type>_<dist>
+// and, for the key types with a workload E spec, scan_len_<key
+// type>_<dist>. Run from workload_gen/
+
+static const std::string kSpecDir = "workload_spec/";
+static const std::string kDatasetDir = "../datasets/";
+static const std::string kOutputDir = "../workloads/";
+
+static const int64_t kEmailListSize = 27000000;
+static const int64_t kUrlListSize = 25000000;
+static const int64_t kWikiTitlesSize = 14000000;
+
+// The load keys picked from the first num_records keys of the file; only
+// those are copied out of the mapped dataset
+void loadDataset(const std::string &file_name, const int64_t num_records, const int64_t record_count,
+		 std::vector<std::string> &load_keys) {
+  benchharness::KeySet key_set;
+  if (!key_set.open(file_name)) return;
+  benchharness::KeyIds load_ids;
+  workloadgen::selectLoadKeys(key_set.ids(num_records), record_count, load_ids);
+  load_keys = key_set.strings(load_ids);
+}
+
+void writeKeys(const std::string &file_name, const std::vector<std::string> &keys) {
+  std::ofstream outfile(file_name);
+  for (int64_t i = 0; i < (int64_t)keys.size(); i++) outfile << keys[i] << '\n';
+}
+
+void writeLens(const std::string &file_name, const std::vector<int> &lens) {
+  std::ofstream outfile(file_name);
+  for (int64_t i = 0; i < (int64_t)lens.size(); i++) outfile << lens[i] << '\n';
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    std::cout << "Usage:\n";
+    std::cout << "1. key type: randint, email, url, wiki\n";
+    std::cout << "2. distribution: uniform, zipfian, latest\n";
+    std::cout << "3. seed (default 0)\n";
+    return -1;
+  }
+  std::string key_type = argv[1];
+  std::string distribution = argv[2];
+  uint64_t seed = (argc > 3) ? strtoull(argv[3], nullptr, 10) : 0;
+
+  std::string workload_name = key_type + "_" + distribution;
+  workloadgen::WorkloadSpec spec;
+  if (!workloadgen::loadSpec(kSpecDir + "workloadc_" + workload_name, &spec)) {
+    std::cout << "No workload spec for " << workload_name << std::endl;
+    return -1;
+  }
+
+  std::vector<std::string> load_keys;
+  if (key_type == "randint") {
+    workloadgen::selectRandintLoadKeys(spec.record_count, load_keys);
+  } else {
+    if (key_type == "email")
+      loadDataset(kDatasetDir + "emails.txt", kEmailListSize, spec.record_count, load_keys);
+    else if (key_type == "url")
+      loadDataset(kDatasetDir + "urls.txt", kUrlListSize, spec.record_count, load_keys);
+    else if (key_type == "wiki")
+      loadDataset(kDatasetDir + "wikis.txt", kWikiTitlesSize, spec.record_count, load_keys);
+  }
+  if (load_keys.empty()) {
+    std::cout << "No keys for " << key_type << std::endl;
+    return -1;
+  }
+  writeKeys(kOutputDir + "load_" + key_type, load_keys);
+
+  std::vector<std::string> txn_keys;
+  workloadgen::generateTxns(spec, seed, load_keys, txn_keys, nullptr);
+  writeKeys(kOutputDir + "txn_" + workload_name, txn_keys);
+
+  workloadgen::WorkloadSpec scan_spec;
+  if (workloadgen::loadSpec(kSpecDir + "workloade_" + workload_name, &scan_spec)) {
+    std::vector<std::string> scan_keys;
+    std::vector<int> scan_lens;
+    workloadgen::generateTxns(scan_spec, seed, load_keys, scan_keys, &scan_lens);
+    writeLens(kOutputDir + "scan_len_" + workload_name, scan_lens);
+  }
+  return 0;
+}
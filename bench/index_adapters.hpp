@@ -0,0 +1,262 @@
+#ifndef INDEX_ADAPTERS_H
+#define INDEX_ADAPTERS_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "PrefixBtree.h"
+#include "Tree.h"
+#include "btree_map.hpp"
+#include "surf.hpp"
+
+// The indexes that bench_driver measures, behind one interface. Keys are
+// byte strings (HOPE-encoded or not) and values are the key ids. To add
+// an index, implement IndexAdapter and register a factory in
+// adapterRegistry()
+namespace benchharness {
+
+class IndexAdapter {
+ public:
+  virtual ~IndexAdapter() {}
+
+  // Whether the index cannot store a key that is a prefix of another
+  virtual bool needsPrefixFreeKeys() const { return false; }
+
+  // Whether lookup() returns the inserted values (filters do not)
+  virtual bool storesValues() const { return true; }
+
+  virtual void insert(const std::string &key, const uint64_t value) = 0;
+
+  // Called after the last insert; static indexes are built here
+  virtual void finishLoad() {}
+
+  // Called before lookup() and scan() run on num_threads threads
+  virtual void prepareThreads(const int num_threads) {}
+
+  // Returns whether key is found, and its value in *value
+  virtual bool lookup(const int thread_id, const std::string &key, uint64_t *value) = 0;
+
+  // Visits up to len keys from the first key >= key; returns the
+  // number of keys visited
+  virtual int scan(const int thread_id, const std::string &key, const int len) = 0;
+
+  // Bytes, without the key store of the caller
+  virtual int64_t memoryUse() const = 0;
+};
+
+//------------------------------------------------------------------
+// tlx B+tree over std::string keys
+//------------------------------------------------------------------
+class BTreeAdapter : public IndexAdapter {
+ public:
+  typedef tlx::btree_map<std::string, uint64_t, std::less<std::string> > btree_type;
+  // estimated node size, as in bench_btree
+  static const int64_t kNodeSize = 256;
+
+  void insert(const std::string &key, const uint64_t value) {
+    bt_.insert(std::make_pair(key, value));
+    total_key_size_ += key.length();
+  }
+
+  bool lookup(const int thread_id, const std::string &key, uint64_t *value) {
+    btree_type::const_iterator iter = bt_.find(key);
+    if (iter == bt_.end()) return false;
+    *value = iter->second;
+    return true;
+  }
+
+  int scan(const int thread_id, const std::string &key, const int len) {
+    btree_type::const_iterator iter = bt_.lower_bound(key);
+    int count = 0;
+    for (; count < len && iter != bt_.end(); count++) ++iter;
+    return count;
+  }
+
+  int64_t memoryUse() const { return kNodeSize * bt_.get_stats().nodes() + total_key_size_; }
+
+ private:
+  btree_type bt_;
+  int64_t total_key_size_ = 0;
+};
+
+//------------------------------------------------------------------
+// ART (ROWEX) with the keys copied into the leaves
+//------------------------------------------------------------------
+class ARTAdapter : public IndexAdapter {
+ public:
+  static const int kMaxScanLen = 1000;
+
+  ARTAdapter() : art_(new ART_ROWEX::Tree()), load_info_(art_->getThreadInfo()) {
+    end_key_str_ = std::string(255, char(255));
+    end_key_.set(end_key_str_.data(), end_key_str_.length());
+  }
+
+  ~ARTAdapter() {
+    thread_infos_.clear();
+    delete art_;
+  }
+
+  bool needsPrefixFreeKeys() const { return true; }
+
+  // TID 0 is "not found"
+  void insert(const std::string &key, const uint64_t value) {
+    Key art_key;
+    art_key.set(key.data(), key.length());
+    art_->insert(art_key, (TID)(value + 1), load_info_);
+  }
+
+  void prepareThreads(const int num_threads) {
+    thread_infos_.clear();
+    for (int t = 0; t < num_threads; t++) thread_infos_.push_back(art_->getThreadInfo());
+    results_.assign(num_threads, std::vector<TID>(kMaxScanLen));
+  }
+
+  bool lookup(const int thread_id, const std::string &key, uint64_t *value) {
+    Key art_key;
+    art_key.set(key.data(), key.length());
+    TID tid = art_->lookup(art_key, thread_infos_[thread_id]);
+    if (tid == 0) return false;
+    *value = tid - 1;
+    return true;
+  }
+
+  int scan(const int thread_id, const std::string &key, const int len) {
+    Key start_key, continue_key;
+    start_key.set(key.data(), key.length());
+    std::size_t count = 0;
+    art_->lookupRange(start_key, end_key_, continue_key, results_[thread_id].data(),
+		      (std::size_t)std::min(len, kMaxScanLen), count, thread_infos_[thread_id]);
+    return (int)count;
+  }
+
+  int64_t memoryUse() const {
+    double mem = 0, avg_height = 0;
+    int cnt_N4 = 0, cnt_N16 = 0, cnt_N48 = 0, cnt_N256 = 0;
+    uint64_t waste_child_mem = 0, skip_prefix_mem = 0, waste_prefix_mem = 0;
+    art_->traverse(mem, avg_height, cnt_N4, cnt_N16, cnt_N48, cnt_N256, waste_child_mem, skip_prefix_mem,
+		   waste_prefix_mem);
+    // traverse() reports MB
+    return (int64_t)(mem * 1000000);
+  }
+
+ private:
+  ART_ROWEX::Tree *art_;
+  ThreadInfo load_info_;
+  std::vector<ThreadInfo> thread_infos_;
+  std::vector<std::vector<TID> > results_;
+  std::string end_key_str_;
+  Key end_key_;
+};
+
+//------------------------------------------------------------------
+// Prefix B+tree (optimistic lock coupling)
+//------------------------------------------------------------------
+class PrefixBTreeAdapter : public IndexAdapter {
+ public:
+  static const int kMaxScanLen = 1000;
+  typedef prefixbtreeolc::BTree<int64_t> BTree;
+
+  PrefixBTreeAdapter() : bt_(new BTree()) {}
+  ~PrefixBTreeAdapter() { delete bt_; }
+
+  void insert(const std::string &key, const uint64_t value) {
+    prefixbtreeolc::Key bt_key;
+    bt_key.setKeyStr(key.data(), key.length());
+    bt_->insert(bt_key, (int64_t)value);
+  }
+
+  void prepareThreads(const int num_threads) { results_.assign(num_threads, std::vector<int64_t>(kMaxScanLen)); }
+
+  bool lookup(const int thread_id, const std::string &key, uint64_t *value) {
+    prefixbtreeolc::Key bt_key;
+    bt_key.setKeyStr(key.data(), key.length());
+    int64_t result = 0;
+    if (!bt_->lookup(bt_key, result)) return false;
+    *value = (uint64_t)result;
+    return true;
+  }
+
+  int scan(const int thread_id, const std::string &key, const int len) {
+    prefixbtreeolc::Key bt_key;
+    bt_key.setKeyStr(key.data(), key.length());
+    return bt_->rangeScan(bt_key, std::min(len, kMaxScanLen), results_[thread_id].data());
+  }
+
+  int64_t memoryUse() const { return bt_->getSize(); }
+
+ private:
+  BTree *bt_;
+  std::vector<std::vector<int64_t> > results_;
+};
+
+//------------------------------------------------------------------
+// SuRF (a static filter): the keys are collected and the filter is
+// built in finishLoad()
+//------------------------------------------------------------------
+class SuRFAdapter : public IndexAdapter {
+ public:
+  ~SuRFAdapter() {
+    if (filter_ != nullptr) {
+      filter_->destroy();
+      delete filter_;
+    }
+  }
+
+  bool storesValues() const { return false; }
+
+  void insert(const std::string &key, const uint64_t value) { keys_.push_back(key); }
+
+  void finishLoad() {
+    std::sort(keys_.begin(), keys_.end());
+    keys_.erase(std::unique(keys_.begin(), keys_.end()), keys_.end());
+    filter_ = new surf::SuRF(keys_, surf::kReal, 0, 8);
+    std::vector<std::string>().swap(keys_);
+  }
+
+  bool lookup(const int thread_id, const std::string &key, uint64_t *value) { return filter_->lookupKey(key); }
+
+  int scan(const int thread_id, const std::string &key, const int len) {
+    surf::SuRF::Iter iter = filter_->moveToKeyGreaterThan(key, true);
+    int count = 0;
+    for (; count < len && iter.isValid(); count++) iter++;
+    return count;
+  }
+
+  int64_t memoryUse() const { return filter_->getMemoryUsage(); }
+
+ private:
+  std::vector<std::string> keys_;
+  surf::SuRF *filter_ = nullptr;
+};
+
+typedef IndexAdapter *(*AdapterFactory)();
+
+template <class Adapter>
+IndexAdapter *createAdapter() {
+  return new Adapter();
+}
+
+inline std::map<std::string, AdapterFactory> &adapterRegistry() {
+  static std::map<std::string, AdapterFactory> registry = {
+      {"btree", createAdapter<BTreeAdapter>},
+      {"art", createAdapter<ARTAdapter>},
+      {"prefix_btree", createAdapter<PrefixBTreeAdapter>},
+      {"surf", createAdapter<SuRFAdapter>},
+  };
+  return registry;
+}
+
+// Returns nullptr for an unknown index
+inline IndexAdapter *createIndex(const std::string &name) {
+  std::map<std::string, AdapterFactory>::const_iterator iter = adapterRegistry().find(name);
+  if (iter == adapterRegistry().end()) return nullptr;
+  return iter->second();
+}
+
+}  // namespace benchharness
+
+#endif  // INDEX_ADAPTERS_H
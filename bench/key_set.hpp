@@ -0,0 +1,260 @@
+#ifndef KEY_SET_H
+#define KEY_SET_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Zero-copy dataset loading for the benchmarks: the key file is memory
+// mapped, and its keys are referenced by id through an offset index
+namespace benchharness {
+
+// A key in a mapped dataset, valid while its KeySet is
+struct KeyRef {
+  const char *data;
+  uint32_t len;
+
+  std::string str() const { return std::string(data, len); }
+
+  int compare(const KeyRef &other) const {
+    int cmp = memcmp(data, other.data, std::min(len, other.len));
+    if (cmp != 0) return cmp;
+    return (len < other.len) ? -1 : (len > other.len ? 1 : 0);
+  }
+  // Shorter than other and its prefix
+  bool isProperPrefixOf(const KeyRef &other) const { return len < other.len && memcmp(data, other.data, len) == 0; }
+
+  bool operator<(const KeyRef &other) const { return compare(other) < 0; }
+  bool operator==(const KeyRef &other) const { return len == other.len && memcmp(data, other.data, len) == 0; }
+};
+
+// Ids of keys in a KeySet; shuffles and samples are reorderings of these
+typedef std::vector<uint32_t> KeyIds;
+
+//------------------------------------------------------------------
+// The non-empty lines of a key file (without a trailing '\r'), in file
+// order. The offset index is built with one newline scan per thread and
+// cached next to the file (<file>.idx), keyed by the file's size and
+// modification time, so later runs map both files and parse nothing
+//------------------------------------------------------------------
+class KeySet {
+ public:
+  static const uint64_t kIndexMagic = 0x3158444954455359ULL;  // "YSETIDX1"
+
+  KeySet() = default;
+  ~KeySet() { close(); }
+  KeySet(const KeySet &) = delete;
+  KeySet &operator=(const KeySet &) = delete;
+
+  // num_threads = 0 means all the hardware threads
+  bool open(const std::string &file_name, const int num_threads = 0) {
+    close();
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+      ::close(fd);
+      return false;
+    }
+    size_ = (size_t)file_stat.st_size;
+    if (size_ > 0) {
+      void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+	::close(fd);
+	size_ = 0;
+	return false;
+      }
+      data_ = (const char *)data;
+      madvise(data, size_, MADV_WILLNEED);
+    }
+    ::close(fd);
+
+    IndexHeader header = {kIndexMagic, (uint64_t)size_, (uint64_t)file_stat.st_mtim.tv_sec,
+			  (uint64_t)file_stat.st_mtim.tv_nsec, 0};
+    std::string index_name = file_name + ".idx";
+    from_cache_ = readIndex(index_name, header);
+    if (!from_cache_) {
+      buildIndex(num_threads);
+      if (offsets_.size() > UINT32_MAX) {
+	close();
+	return false;
+      }
+      writeIndex(index_name, header);
+    }
+    return true;
+  }
+
+  void close() {
+    if (data_ != nullptr) munmap((void *)data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+    offsets_.clear();
+    lens_.clear();
+    from_cache_ = false;
+  }
+
+  int64_t size() const { return (int64_t)offsets_.size(); }
+  bool indexFromCache() const { return from_cache_; }
+
+  KeyRef key(const uint32_t id) const { return KeyRef{data_ + offsets_[id], lens_[id]}; }
+  std::string str(const uint32_t id) const { return key(id).str(); }
+
+  // The first num keys in file order; all of them if num is 0
+  KeyIds ids(const int64_t num = 0) const {
+    int64_t n = (num <= 0) ? size() : std::min(num, size());
+    KeyIds result(n);
+    for (int64_t i = 0; i < n; i++) result[i] = (uint32_t)i;
+    return result;
+  }
+
+  KeyIds shuffledIds(const uint64_t seed, const int64_t num = 0) const {
+    KeyIds result = ids(num);
+    std::mt19937_64 rng(seed);
+    std::shuffle(result.begin(), result.end(), rng);
+    return result;
+  }
+
+  // Every step-th of ids, starting from the first
+  static KeyIds sample(const KeyIds &ids, const int64_t step) {
+    KeyIds result;
+    for (int64_t i = 0; i < (int64_t)ids.size(); i += std::max(step, (int64_t)1)) result.push_back(ids[i]);
+    return result;
+  }
+
+  // Sorts by key; drops the later ids of equal keys if dedup
+  void sortIds(KeyIds *ids, const bool dedup) const {
+    std::sort(ids->begin(), ids->end(), [this](const uint32_t x, const uint32_t y) {
+      int cmp = key(x).compare(key(y));
+      return (cmp != 0) ? cmp < 0 : x < y;
+    });
+    if (dedup) {
+      ids->erase(std::unique(ids->begin(), ids->end(),
+			     [this](const uint32_t x, const uint32_t y) { return key(x) == key(y); }),
+		 ids->end());
+    }
+  }
+
+  // Copies for the APIs that take std::string
+  std::vector<std::string> strings(const KeyIds &ids) const {
+    std::vector<std::string> result;
+    result.reserve(ids.size());
+    for (uint32_t id : ids) result.push_back(str(id));
+    return result;
+  }
+
+  int64_t totalLength(const KeyIds &ids) const {
+    int64_t total_len = 0;
+    for (uint32_t id : ids) total_len += lens_[id];
+    return total_len;
+  }
+
+ private:
+  struct IndexHeader {
+    uint64_t magic;
+    uint64_t file_size;
+    uint64_t mtime_sec;
+    uint64_t mtime_nsec;
+    uint64_t num_keys;
+  };
+
+  // Keys of the lines that start in [begin, end)
+  void scanRange(const size_t begin, const size_t end, std::vector<uint64_t> *offsets,
+		 std::vector<uint32_t> *lens) const {
+    size_t pos = begin;
+    if (pos > 0 && data_[pos - 1] != '\n') {
+      const char *newline = (const char *)memchr(data_ + pos, '\n', size_ - pos);
+      pos = (newline == nullptr) ? size_ : (size_t)(newline - data_) + 1;
+    }
+    while (pos < end) {
+      const char *newline = (const char *)memchr(data_ + pos, '\n', size_ - pos);
+      size_t line_end = (newline == nullptr) ? size_ : (size_t)(newline - data_);
+      size_t len = line_end - pos;
+      if (len > 0 && data_[line_end - 1] == '\r') len--;
+      if (len > 0) {
+	offsets->push_back(pos);
+	lens->push_back((uint32_t)len);
+      }
+      pos = line_end + 1;
+    }
+  }
+
+  void buildIndex(int num_threads) {
+    if (num_threads <= 0) num_threads = std::max(1, (int)std::thread::hardware_concurrency());
+    // not worth a thread below a few MB
+    num_threads = (int)std::max((size_t)1, std::min((size_t)num_threads, size_ >> 22));
+    std::vector<std::vector<uint64_t> > offsets(num_threads);
+    std::vector<std::vector<uint32_t> > lens(num_threads);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.push_back(std::thread([&, t]() {
+	scanRange(size_ * t / num_threads, size_ * (t + 1) / num_threads, &offsets[t], &lens[t]);
+      }));
+    }
+    for (auto &thread : threads) thread.join();
+    for (int t = 0; t < num_threads; t++) {
+      offsets_.insert(offsets_.end(), offsets[t].begin(), offsets[t].end());
+      lens_.insert(lens_.end(), lens[t].begin(), lens[t].end());
+    }
+  }
+
+  bool readIndex(const std::string &index_name, const IndexHeader &expected) {
+    std::ifstream infile(index_name, std::ios::binary | std::ios::ate);
+    if (!infile.is_open()) return false;
+    uint64_t index_size = (uint64_t)infile.tellg();
+    infile.seekg(0);
+    IndexHeader header;
+    if (!infile.read((char *)&header, sizeof(header))) return false;
+    if (header.magic != expected.magic || header.file_size != expected.file_size ||
+	header.mtime_sec != expected.mtime_sec || header.mtime_nsec != expected.mtime_nsec)
+      return false;
+    // every key takes at least one byte of the file, and the index holds
+    // exactly num_keys offsets and lengths
+    if (header.num_keys > header.file_size ||
+	index_size != sizeof(header) + header.num_keys * (sizeof(uint64_t) + sizeof(uint32_t)))
+      return false;
+    offsets_.resize(header.num_keys);
+    lens_.resize(header.num_keys);
+    bool ok = infile.read((char *)offsets_.data(), header.num_keys * sizeof(uint64_t)) &&
+	      infile.read((char *)lens_.data(), header.num_keys * sizeof(uint32_t));
+    for (uint64_t i = 0; ok && i < header.num_keys; i++) ok = (offsets_[i] + lens_[i] <= size_);
+    if (!ok) {
+      offsets_.clear();
+      lens_.clear();
+    }
+    return ok;
+  }
+
+  // Best effort: the dataset directory may be read-only
+  void writeIndex(const std::string &index_name, IndexHeader header) const {
+    header.num_keys = offsets_.size();
+    std::string tmp_name = index_name + ".tmp";
+    std::ofstream outfile(tmp_name, std::ios::binary | std::ios::trunc);
+    if (!outfile.is_open()) return;
+    outfile.write((const char *)&header, sizeof(header));
+    outfile.write((const char *)offsets_.data(), offsets_.size() * sizeof(uint64_t));
+    outfile.write((const char *)lens_.data(), lens_.size() * sizeof(uint32_t));
+    outfile.close();
+    if (outfile.fail() || rename(tmp_name.c_str(), index_name.c_str()) != 0) unlink(tmp_name.c_str());
+  }
+
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  std::vector<uint64_t> offsets_;
+  std::vector<uint32_t> lens_;
+  bool from_cache_ = false;
+};
+
+}  // namespace benchharness
+
+#endif  // KEY_SET_H
@@ -0,0 +1,224 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "bench_harness.hpp"
+
+// Per-operation latency measurement for the benchmarks: a cycle counter,
+// HDR-style histograms and their percentiles, by key length
+namespace benchharness {
+
+// rdtsc where available, steady_clock nanoseconds elsewhere. Reading
+// it costs ~20 cycles, so timed sections should be one operation or more
+inline uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+	     std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Calibrated once against steady_clock (~20ms)
+inline double cyclesPerNs() {
+  static const double cycles_per_ns = []() {
+    auto start_time = std::chrono::steady_clock::now();
+    uint64_t start_cycles = readCycles();
+    auto end_time = start_time;
+    while (end_time - start_time < std::chrono::milliseconds(20)) end_time = std::chrono::steady_clock::now();
+    uint64_t cycles = readCycles() - start_cycles;
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
+    return cycles / ns;
+  }();
+  return cycles_per_ns;
+}
+
+//------------------------------------------------------------------
+// Log-linear histogram over uint64_t values (as in HdrHistogram): exact
+// below 2^kSubBucketBits, then kSubBucketCount / 2 linear sub-buckets per
+// power of two, i.e., values are kept within 1 / 16 relative error.
+// Recording is one shift and one increment
+//------------------------------------------------------------------
+class LatencyHistogram {
+ public:
+  static const int kSubBucketBits = 5;
+  static const int kSubBucketCount = 1 << kSubBucketBits;
+  static const int kHalfCount = kSubBucketCount / 2;
+  static const int kNumBuckets = (64 - kSubBucketBits + 2) * kHalfCount;
+
+  LatencyHistogram() : counts_(kNumBuckets, 0) {}
+
+  static int bucketOf(const uint64_t value) {
+    if (value < (uint64_t)kSubBucketCount) return (int)value;
+    int exponent = 63 - __builtin_clzll(value) - kSubBucketBits + 1;
+    return exponent * kHalfCount + (int)(value >> exponent);
+  }
+
+  // The largest value in the bucket
+  static uint64_t bucketMax(const int bucket) {
+    if (bucket < kSubBucketCount) return (uint64_t)bucket;
+    int exponent = bucket / kHalfCount - 1;
+    uint64_t sub_bucket = (uint64_t)(bucket - exponent * kHalfCount);
+    return ((sub_bucket + 1) << exponent) - 1;
+  }
+
+  void record(const uint64_t value) {
+    counts_[bucketOf(value)]++;
+    count_++;
+    sum_ += value;
+    if (value > max_) max_ = value;
+  }
+
+  void merge(const LatencyHistogram &other) {
+    for (int i = 0; i < kNumBuckets; i++) counts_[i] += other.counts_[i];
+    count_ += other.count_;
+    sum_ += other.sum_;
+    if (other.max_ > max_) max_ = other.max_;
+  }
+
+  void clear() {
+    counts_.assign(kNumBuckets, 0);
+    count_ = 0;
+    sum_ = 0;
+    max_ = 0;
+  }
+
+  uint64_t count() const { return count_; }
+  uint64_t max() const { return max_; }
+  double mean() const { return (count_ == 0) ? 0 : (double)sum_ / count_; }
+
+  // The smallest bucket bound that at least percentile% of the values
+  // are at or below (capped at the exact max); 0 if empty
+  uint64_t percentile(const double percentile) const {
+    if (count_ == 0) return 0;
+    uint64_t rank = (uint64_t)(percentile / 100 * count_ + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > count_) rank = count_;
+    uint64_t seen = 0;
+    for (int i = 0; i < kNumBuckets; i++) {
+      seen += counts_[i];
+      if (seen >= rank) return std::min(bucketMax(i), max_);
+    }
+    return max_;
+  }
+
+ private:
+  std::vector<uint64_t> counts_;
+  uint64_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t max_ = 0;
+};
+
+//------------------------------------------------------------------
+// One histogram per key-length range (in bytes), plus their union.
+// Long keys and keys with rare symbols make up the tail
+//------------------------------------------------------------------
+class KeyLengthHistograms {
+ public:
+  // upper bounds of the ranges; the last range is open
+  static const int kNumRanges = 6;
+
+  KeyLengthHistograms() : histograms_(kNumRanges) {}
+
+  static int rangeOf(const int key_len) {
+    static const int kRangeMax[kNumRanges - 1] = {8, 16, 32, 64, 128};
+    int range = 0;
+    while (range < kNumRanges - 1 && key_len > kRangeMax[range]) range++;
+    return range;
+  }
+
+  static std::string rangeName(const int range) {
+    static const char *kNames[kNumRanges] = {"1_8", "9_16", "17_32", "33_64", "65_128", "129_"};
+    return kNames[range];
+  }
+
+  void record(const int key_len, const uint64_t cycles) {
+    histograms_[rangeOf(key_len)].record(cycles);
+    all_.record(cycles);
+  }
+
+  void merge(const KeyLengthHistograms &other) {
+    for (int i = 0; i < kNumRanges; i++) histograms_[i].merge(other.histograms_[i]);
+    all_.merge(other.all_);
+  }
+
+  const LatencyHistogram &range(const int range) const { return histograms_[range]; }
+  const LatencyHistogram &all() const { return all_; }
+
+ private:
+  std::vector<LatencyHistogram> histograms_;
+  LatencyHistogram all_;
+};
+
+// The percentiles reported for every histogram
+static const double kReportedPercentiles[] = {50, 90, 99, 99.9};
+
+inline std::string percentileName(const double percentile) {
+  std::string name = formatDouble(percentile);
+  for (char &c : name)
+    if (c == '.') c = '_';
+  return "p" + name;
+}
+
+// Latency metrics in ns, one value per repetition: <name>_ns_<pXX> and
+// <name>_ns_max overall, and <name>_ns_<pXX>_len_<range> for each key
+// length range that has values
+class LatencyMetrics {
+ public:
+  void add(const std::string &name, const KeyLengthHistograms &histograms) {
+    double ns_per_cycle = 1 / cyclesPerNs();
+    addHistogram(name + "_ns", histograms.all(), ns_per_cycle, true);
+    for (int i = 0; i < KeyLengthHistograms::kNumRanges; i++) {
+      if (histograms.range(i).count() == 0) continue;
+      addHistogram(name + "_ns", histograms.range(i), ns_per_cycle, false,
+		   "_len_" + KeyLengthHistograms::rangeName(i));
+    }
+  }
+
+  void addTo(Record *record) const { series_.addTo(record); }
+
+ private:
+  void addHistogram(const std::string &prefix, const LatencyHistogram &histogram, const double ns_per_cycle,
+		    const bool with_max, const std::string &suffix = "") {
+    for (double percentile : kReportedPercentiles)
+      series_.add(prefix + "_" + percentileName(percentile) + suffix, histogram.percentile(percentile) * ns_per_cycle);
+    if (with_max) series_.add(prefix + "_max" + suffix, histogram.max() * ns_per_cycle);
+  }
+
+  MetricSeries series_;
+};
+
+// A table of the percentiles (in ns) by key length range
+inline void printLatencyReport(std::ostream &os, const std::string &name, const KeyLengthHistograms &histograms) {
+  double ns_per_cycle = 1 / cyclesPerNs();
+  os << name << " latency (ns)\n" << std::setw(10) << "key_len" << std::setw(12) << "count";
+  for (double percentile : kReportedPercentiles) os << std::setw(10) << percentileName(percentile);
+  os << std::setw(10) << "max" << "\n";
+  for (int i = 0; i <= KeyLengthHistograms::kNumRanges; i++) {
+    bool is_all = (i == KeyLengthHistograms::kNumRanges);
+    const LatencyHistogram &histogram = is_all ? histograms.all() : histograms.range(i);
+    if (histogram.count() == 0) continue;
+    os << std::setw(10) << (is_all ? std::string("all") : KeyLengthHistograms::rangeName(i)) << std::setw(12)
+       << histogram.count() << std::fixed << std::setprecision(0);
+    for (double percentile : kReportedPercentiles) os << std::setw(10) << histogram.percentile(percentile) * ns_per_cycle;
+    os << std::setw(10) << histogram.max() * ns_per_cycle << "\n";
+    os.unsetf(std::ios::fixed);
+    os << std::setprecision(6);
+  }
+}
+
+}  // namespace benchharness
+
+#endif  // LATENCY_HISTOGRAM_H
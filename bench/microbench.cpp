@@ -1,13 +1,24 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
 #include <sys/time.h>
 #include <time.h>
 #include <set>
 
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <set>
+#include <thread>
+#include "cache_info.hpp"
 #include "common.hpp"
 #include "encoder_factory.hpp"
+#include "encoder_profiler.hpp"
+#include "key_set.hpp"
+#include "latency_histogram.hpp"
+#include "perf_counters.hpp"
 #include "parameters.h"
 
 namespace microbench {
@@ -18,6 +29,7 @@ static const std::string file_url = "datasets/urls.txt";
 static const std::string file_email1 = "datasets/email_1.txt";
 static const std::string file_email2 = "datasets/email_2.txt";
 static const int kLongestCodeLen = 4096;
+static const uint64_t kShuffleSeed = 0;
 
 static int runALM = 1;
 static int kRunEmail = 0;
@@ -25,6 +37,14 @@ static int kRunWiki = 0;
 static int kRunUrl = 0;
 
 static bool runBatch = false;
+// time every key in a second pass and print percentiles by key length
+static int kMeasureLatency = 0;
+// print hardware counters for the build and the timed encode run
+static int kPerfCounters = 0;
+// threads of the encode scalability sweep (0 = all the allowed CPUs) and
+// the NUMA node to run them and build the encoder on (-1 = any)
+static int kMaxThreads = 0;
+static int kNumaNode = -1;
 //-------------------------------------------------------------
 // Workload IDs
 //-------------------------------------------------------------
@@ -133,6 +153,26 @@ static const std::string per_subdir = "percentage/";
 static const std::string file_per_email = output_dir + per_subdir + "per_cpr_lat.csv";
 std::ofstream output_per_cpr_lat;
 
+//------------------------------------------------------------
+// Encode Scalability
+//-----------------------------------------------------------
+static const std::string scalability_subdir = "scalability/";
+static const std::string file_scalability = output_dir + scalability_subdir + "encode_scalability.csv";
+std::ofstream output_scalability;
+
+//------------------------------------------------------------
+// Dictionary Size vs Cache
+//-----------------------------------------------------------
+static const std::string cache_sweep_subdir = "cache_sweep/";
+static const std::string file_cache_sweep = output_dir + cache_sweep_subdir + "cache_sweep.csv";
+std::ofstream output_cache_sweep;
+static const std::string file_cache_recommend = output_dir + cache_sweep_subdir + "cache_recommend.csv";
+std::ofstream output_cache_recommend;
+// the working set of a dictionary is what serves this share of lookups
+static const double kWorkingSetCoverage = 0.99;
+// keys profiled to find the hot entries
+static const int64_t kNumProfileKeys = 100000;
+
 double getNow() {
   struct timeval tv;
   gettimeofday(&tv, 0);
@@ -144,20 +184,13 @@ std::string uint64ToString(uint64_t key) {
   return std::string(reinterpret_cast<const char *>(&endian_swapped_key), 8);
 }
 
-int64_t loadKeys(const std::string &file_name, std::vector<std::string> &keys, std::vector<std::string> &keys_shuffle) {
-  std::ifstream infile(file_name);
-  std::string key;
-  int64_t total_len = 0;
-  int cnt = 0;
-  while (infile.good()) {
-    cnt++;
-    infile >> key;
-    keys.push_back(key);
-    keys_shuffle.push_back(key);
-    total_len += key.length();
-  }
-  std::random_shuffle(keys_shuffle.begin(), keys_shuffle.end());
-  return total_len;
+// The experiments only use the shuffled keys, so only they are copied
+int64_t loadKeys(const std::string &file_name, std::vector<std::string> &keys_shuffle) {
+  benchharness::KeySet key_set;
+  if (!key_set.open(file_name)) return 0;
+  benchharness::KeyIds ids = key_set.shuffledIds(kShuffleSeed);
+  keys_shuffle = key_set.strings(ids);
+  return key_set.totalLength(ids);
 }
 
 void printStr(std::string str) {
@@ -178,15 +211,80 @@ void getSampleKeys(const double sample_percent, std::vector<std::string> &sample
   }
 }
 
+// Per-key (per-pair, per-batch) latency of the same encode method
+void measureLatency(hope::Encoder *encoder, const std::vector<std::string> &enc_src_keys, const int encode_method,
+                    const int batch_size, uint8_t *buffer, uint8_t *lb, uint8_t *rb) {
+  benchharness::KeyLengthHistograms latency, decode_latency;
+  std::vector<std::string> enc_keys;
+  for (int i = 0; i < (int)enc_src_keys.size(); i++) {
+    int key_len = enc_src_keys[i].length();
+    if (encode_method == 0) {
+      uint64_t start = benchharness::readCycles();
+      int bit_len = encoder->encode(enc_src_keys[i], buffer);
+      uint64_t end = benchharness::readCycles();
+      latency.record(key_len, end - start);
+      std::string enc_key((const char *)buffer, (bit_len + 7) >> 3);
+      start = benchharness::readCycles();
+      encoder->decode(enc_key, bit_len, buffer);
+      end = benchharness::readCycles();
+      decode_latency.record(key_len, end - start);
+    } else if (encode_method == 1 && i + 1 < (int)enc_src_keys.size()) {
+      int l_len;
+      int r_len;
+      uint64_t start = benchharness::readCycles();
+      encoder->encodePair(enc_src_keys[i], enc_src_keys[i + 1], lb, rb, l_len, r_len);
+      uint64_t end = benchharness::readCycles();
+      latency.record(std::max(key_len, (int)enc_src_keys[i + 1].length()), end - start);
+      i++;
+    } else if (encode_method == 2 && i + batch_size <= (int)enc_src_keys.size()) {
+      enc_keys.clear();
+      uint64_t start = benchharness::readCycles();
+      encoder->encodeBatch(enc_src_keys, i, batch_size, enc_keys);
+      uint64_t end = benchharness::readCycles();
+      latency.record(key_len, end - start);
+      i += batch_size - 1;
+    }
+  }
+  static const char *kMethodNames[3] = {"encode", "encodePair", "encodeBatch"};
+  benchharness::printLatencyReport(std::cout, kMethodNames[encode_method], latency);
+  if (encode_method == 0) benchharness::printLatencyReport(std::cout, "decode", decode_latency);
+}
+
+// Get parameters from file to speed up building the encoder
+void getBuildParams(const int wkld_id, const int encoder_type, const int64_t dict_size_id, int64_t &input_dict_size,
+                    int &W) {
+  if (encoder_type == 3) {
+    input_dict_size = three_gram_input_dict_size[wkld_id][dict_size_id];
+  } else if (encoder_type == 4) {
+    input_dict_size = four_gram_input_dict_size[wkld_id][dict_size_id];
+  } else {
+    input_dict_size = dict_size_list[dict_size_id];
+  }
+
+  W = 0;
+  if (encoder_type == 5) {
+    W = ALM_W[wkld_id][dict_size_id];
+  }
+  if (encoder_type == 6) {
+    W = ALM_W_improved[wkld_id][dict_size_id];
+  }
+}
+
 void exec_helper(const int encoder_type, const int W, const int input_dict_size,
                  const std::vector<std::string> sample_keys, const std::vector<std::string> enc_src_keys,
                  const int64_t enc_src_len, int encode_method, const int batch_size, double &bt, double &tput,
                  double &lat, double &cpr, double &dict_size, double &mem) {
   hope::Encoder *encoder = hope::EncoderFactory::createEncoder(encoder_type, W);
+  std::unique_ptr<benchharness::PerfCounters> counters(kPerfCounters ? new benchharness::PerfCounters() : nullptr);
+  if (kPerfCounters) counters->start();
   double time_start = getNow();
   encoder->build(sample_keys, input_dict_size);
   double time_end = getNow();
   bt = time_end - time_start;
+  if (kPerfCounters) {
+    counters->stop();
+    benchharness::printPerfCounters(std::cout, "build", *counters, (double)sample_keys.size(), "sample_key");
+  }
 
   dict_size = encoder->numEntries();
   mem = encoder->memoryUse();
@@ -196,8 +294,9 @@ void exec_helper(const int encoder_type, const int W, const int input_dict_size,
   uint8_t *rb = new uint8_t[kLongestCodeLen];
   int64_t total_enc_len = 0;
 
-  time_start = getNow();
   std::vector<std::string> enc_keys;
+  if (kPerfCounters) counters->start();
+  time_start = getNow();
 
   // encode one string each time
   if (encode_method == 0) {
@@ -219,10 +318,15 @@ void exec_helper(const int encoder_type, const int W, const int input_dict_size,
     }
   }
   time_end = getNow();
+  if (kPerfCounters) {
+    counters->stop();
+    benchharness::printPerfCounters(std::cout, "encode", *counters, (double)enc_src_keys.size(), "key");
+  }
   double time_diff = time_end - time_start;
   tput = enc_src_keys.size() / time_diff / 1000000;  // in Mops/s
   lat = time_diff * 1000000000 / enc_src_len;        // in ns
   cpr = (enc_src_len * 8.0) / total_enc_len;
+  if (kMeasureLatency) measureLatency(encoder, enc_src_keys, encode_method, batch_size, buffer, lb, rb);
   delete[] buffer;
   delete lb;
   delete rb;
@@ -245,23 +349,9 @@ void exec(const int expt_id, const int wkld_id, const int encoder_type, const in
   int64_t sample_enc_src_len = 0;
   getSampleKeys(sample_percent, sample_keys, keys_shuffle, sample_enc_src_len);
 
-  // Get parameters from file to speed up building the encoder
   int64_t input_dict_size = 0;
-  if (encoder_type == 3) {
-    input_dict_size = three_gram_input_dict_size[wkld_id][dict_size_id];
-  } else if (encoder_type == 4) {
-    input_dict_size = four_gram_input_dict_size[wkld_id][dict_size_id];
-  } else {
-    input_dict_size = dict_size_list[dict_size_id];
-  }
-
   int W = 0;
-  if (encoder_type == 5) {
-    W = ALM_W[wkld_id][dict_size_id];
-  }
-  if (encoder_type == 6) {
-    W = ALM_W_improved[wkld_id][dict_size_id];
-  }
+  getBuildParams(wkld_id, encoder_type, dict_size_id, input_dict_size, W);
 
   std::vector<std::string> enc_src_keys;
   int64_t enc_src_len = 0;
@@ -328,6 +418,236 @@ void exec(const int expt_id, const int wkld_id, const int encoder_type, const in
     output_per_cpr_lat << lat << "\n";
   }
 }
+
+// CPUs this process may run on, only those of numa_node if it is not
+// negative (read from sysfs, so libnuma is not needed)
+std::vector<int> getCpuList(const int numa_node) {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    for (int cpu = 0; cpu < (int)std::thread::hardware_concurrency() && cpu < CPU_SETSIZE; cpu++)
+      CPU_SET(cpu, &allowed);
+  }
+  std::set<int> node_cpus;
+  if (numa_node >= 0) {
+    std::ifstream infile("/sys/devices/system/node/node" + std::to_string(numa_node) + "/cpulist");
+    std::string range;
+    // e.g., 0-7,16-23
+    while (std::getline(infile, range, ',')) {
+      int first = 0;
+      int last = 0;
+      int num_read = sscanf(range.c_str(), "%d-%d", &first, &last);
+      if (num_read == 1) last = first;
+      for (int cpu = first; num_read >= 1 && cpu <= last; cpu++) node_cpus.insert(cpu);
+    }
+  }
+  std::vector<int> cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &allowed) && (numa_node < 0 || node_cpus.count(cpu) > 0)) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+bool pinThread(const std::vector<int> &cpus) {
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int cpu : cpus) CPU_SET(cpu, &cpu_set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+}
+
+struct ScalabilityResult {
+  double mops;  // of all the threads
+  double thread_mops_avg;
+  double thread_mops_min;
+  // every thread encoded the keys to the same number of bits
+  bool consistent;
+};
+
+// Every thread encodes all of enc_src_keys with the shared encoder, each
+// from its own offset, so that the work per thread stays the same as
+// threads are added. Thread t is pinned to cpus[t % cpus.size()]. Threads
+// time themselves and write their results once at the end, so that the
+// harness itself shares no cache lines while they run
+ScalabilityResult runEncodeThreads(const hope::Encoder *encoder, const std::vector<std::string> &enc_src_keys,
+                                   const std::vector<int> &cpus, const int num_threads) {
+  int64_t n = (int64_t)enc_src_keys.size();
+  std::vector<double> thread_sec(num_threads, 0);
+  std::vector<int64_t> thread_enc_len(num_threads, 0);
+  std::atomic<int> num_ready(0);
+  std::atomic<bool> go(false);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.push_back(std::thread([&, t]() {
+      pinThread(std::vector<int>(1, cpus[t % cpus.size()]));
+      std::vector<uint8_t> buffer(kLongestCodeLen);
+      int64_t begin = n * t / num_threads;
+      int64_t total_enc_len = 0;
+      num_ready++;
+      while (!go.load()) std::this_thread::yield();
+      double time_start = getNow();
+      for (int64_t i = begin; i < n; i++) total_enc_len += encoder->encode(enc_src_keys[i], buffer.data());
+      for (int64_t i = 0; i < begin; i++) total_enc_len += encoder->encode(enc_src_keys[i], buffer.data());
+      thread_sec[t] = getNow() - time_start;
+      thread_enc_len[t] = total_enc_len;
+    }));
+  }
+  while (num_ready.load() < num_threads) std::this_thread::yield();
+  double time_start = getNow();
+  go = true;
+  for (auto &thread : threads) thread.join();
+  double time_diff = getNow() - time_start;
+
+  ScalabilityResult result;
+  result.mops = n * num_threads / time_diff / 1000000;
+  result.thread_mops_avg = 0;
+  result.thread_mops_min = 0;
+  result.consistent = true;
+  for (int t = 0; t < num_threads; t++) {
+    double thread_mops = n / thread_sec[t] / 1000000;
+    result.thread_mops_avg += thread_mops / num_threads;
+    if (t == 0 || thread_mops < result.thread_mops_min) result.thread_mops_min = thread_mops;
+    result.consistent &= (thread_enc_len[t] == thread_enc_len[0]);
+  }
+  return result;
+}
+
+// Encodes with 1, 2, 4, ... kMaxThreads threads sharing one encoder. The
+// per-thread efficiency is a thread's throughput over the single-thread
+// one; it stays near 1 until memory bandwidth runs out, unless the
+// threads contend on something
+void execScalability(const int wkld_id, const int encoder_type, const int64_t dict_size_id,
+                     const double sample_percent, const std::vector<std::string> &keys_shuffle,
+                     const std::vector<int> &cpus) {
+  std::vector<std::string> sample_keys;
+  int64_t sample_enc_src_len = 0;
+  getSampleKeys(sample_percent, sample_keys, keys_shuffle, sample_enc_src_len);
+  int64_t input_dict_size = 0;
+  int W = 0;
+  getBuildParams(wkld_id, encoder_type, dict_size_id, input_dict_size, W);
+  hope::Encoder *encoder = hope::EncoderFactory::createEncoder(encoder_type, W);
+  encoder->build(sample_keys, input_dict_size);
+  int dict_size = encoder->numEntries();
+
+  std::cout << "Encoder Type = " << encoder_type << ", Dict Size = " << dict_size << std::endl;
+  int max_threads = (kMaxThreads > 0) ? kMaxThreads : (int)cpus.size();
+  double base_thread_mops = 0;
+  for (int num_threads = 1;; num_threads = std::min(num_threads * 2, max_threads)) {
+    ScalabilityResult result = runEncodeThreads(encoder, keys_shuffle, cpus, num_threads);
+    if (num_threads == 1) base_thread_mops = result.thread_mops_avg;
+    double efficiency_avg = result.thread_mops_avg / base_thread_mops;
+    double efficiency_min = result.thread_mops_min / base_thread_mops;
+    std::cout << "Threads = " << num_threads << ": Throughput = " << result.mops
+              << " Mops/s, Per Thread = " << result.thread_mops_avg << " Mops/s, Efficiency = " << efficiency_avg
+              << " (min " << efficiency_min << ")"
+              << ((num_threads > (int)cpus.size()) ? " [more threads than CPUs]" : "") << std::endl;
+    if (!result.consistent) std::cout << "ERROR: THREADS ENCODED THE KEYS DIFFERENTLY!" << std::endl;
+    output_scalability << wkld_id << "," << encoder_type << "," << dict_size << "," << num_threads << ","
+                       << result.mops << "," << result.thread_mops_avg << "," << efficiency_avg << ","
+                       << efficiency_min << "\n";
+    if (num_threads >= max_threads) break;
+  }
+  delete encoder;
+}
+
+struct CachePoint {
+  int encoder_type;
+  int64_t dict_size;
+  double cpr;
+  double lat;
+  int64_t mem;
+  int64_t working_set;
+};
+
+// Builds the encoder, times encoding all the keys and profiles the first
+// kNumProfileKeys of them to find the working set of its dictionary
+CachePoint execCacheSweep(const int wkld_id, const int encoder_type, const int64_t dict_size_id,
+                          const double sample_percent, const std::vector<std::string> &keys_shuffle,
+                          const std::vector<benchharness::CacheLevel> &levels) {
+  std::vector<std::string> sample_keys;
+  int64_t sample_enc_src_len = 0;
+  getSampleKeys(sample_percent, sample_keys, keys_shuffle, sample_enc_src_len);
+  int64_t input_dict_size = 0;
+  int W = 0;
+  getBuildParams(wkld_id, encoder_type, dict_size_id, input_dict_size, W);
+  hope::Encoder *encoder = hope::EncoderFactory::createEncoder(encoder_type, W);
+  encoder->setKeepSymbols(true);
+  encoder->build(sample_keys, input_dict_size);
+
+  uint8_t *buffer = new uint8_t[kLongestCodeLen];
+  int64_t enc_src_len = 0;
+  int64_t total_enc_len = 0;
+  for (const std::string &key : keys_shuffle) enc_src_len += key.length();
+  double time_start = getNow();
+  for (const std::string &key : keys_shuffle) total_enc_len += encoder->encode(key, buffer);
+  double time_diff = getNow() - time_start;
+  delete[] buffer;
+
+  hope::EncoderProfiler profiler(encoder);
+  int64_t num_profile_keys = std::min((int64_t)keys_shuffle.size(), kNumProfileKeys);
+  for (int64_t i = 0; i < num_profile_keys; i++) profiler.profile(keys_shuffle[i]);
+
+  CachePoint point;
+  point.encoder_type = encoder_type;
+  point.dict_size = encoder->numEntries();
+  point.cpr = (enc_src_len * 8.0) / total_enc_len;
+  point.lat = time_diff * 1000000000 / enc_src_len;  // in ns
+  point.mem = encoder->memoryUse();
+  int line_bytes = levels.empty() ? benchharness::kDefaultCacheLineBytes : levels[0].line_bytes;
+  point.working_set = benchharness::workingSetBytes(point.mem, point.dict_size,
+                                                    profiler.numEntriesCovering(kWorkingSetCoverage), line_bytes);
+  delete encoder;
+
+  int level = benchharness::fittingLevel(levels, point.working_set);
+  std::string tier = (level < (int)levels.size()) ? levels[level].name : "DRAM";
+  std::cout << "Encoder Type = " << encoder_type << ", Dict Size = " << point.dict_size << ", CPR = " << point.cpr
+            << ", Latency = " << point.lat << " ns/char, Memory = " << point.mem
+            << ", Working Set = " << point.working_set << " (" << tier << ")" << std::endl;
+  output_cache_sweep << wkld_id << "," << encoder_type << "," << point.dict_size << "," << point.cpr << ","
+                     << point.lat << "," << point.mem << "," << point.working_set << "," << tier << "\n";
+  return point;
+}
+
+// For every encoder type: the dictionary sizes at which its working set
+// stops fitting in each cache level, and the largest one that still fits
+void reportCacheTiers(const int wkld_id, const std::vector<benchharness::CacheLevel> &levels,
+                      const std::vector<CachePoint> &points) {
+  std::set<int> encoder_types;
+  for (const CachePoint &point : points) encoder_types.insert(point.encoder_type);
+  for (int encoder_type : encoder_types) {
+    std::vector<CachePoint> curve;
+    for (const CachePoint &point : points) {
+      if (point.encoder_type == encoder_type) curve.push_back(point);
+    }
+    std::sort(curve.begin(), curve.end(),
+              [](const CachePoint &x, const CachePoint &y) { return x.dict_size < y.dict_size; });
+    std::cout << "Encoder Type = " << encoder_type << std::endl;
+    for (const benchharness::CacheLevel &level : levels) {
+      int64_t max_dict_size = 0;
+      double max_cpr = 0;
+      double max_lat = 0;
+      int64_t crossing = 0;
+      for (const CachePoint &point : curve) {
+        if (point.working_set <= level.size_bytes) {
+          max_dict_size = point.dict_size;
+          max_cpr = point.cpr;
+          max_lat = point.lat;
+        } else if (crossing == 0) {
+          crossing = point.dict_size;
+        }
+      }
+      std::cout << "  " << level.name << " (" << level.size_bytes << " B): ";
+      if (max_dict_size > 0)
+        std::cout << "recommended max dict size = " << max_dict_size << " (CPR = " << max_cpr
+                  << ", Latency = " << max_lat << " ns/char)";
+      else
+        std::cout << "no dictionary fits";
+      if (crossing > 0) std::cout << ", falls out at dict size " << crossing;
+      std::cout << std::endl;
+      output_cache_recommend << wkld_id << "," << encoder_type << "," << level.name << "," << level.size_bytes << ","
+                             << max_dict_size << "," << crossing << "\n";
+    }
+  }
+}
 }  // namespace microbench
 
 using namespace microbench;
@@ -338,10 +658,16 @@ int main(int argc, char *argv[]) {
   kRunEmail = (int)atoi(argv[3]);
   kRunWiki = (int)atoi(argv[4]);
   kRunUrl = (int)atoi(argv[5]);
+  if (argc > 6) kMeasureLatency = (int)atoi(argv[6]);
+  if (argc > 7) kPerfCounters = (int)atoi(argv[7]);
+  if (argc > 8) kMaxThreads = (int)atoi(argv[8]);
+  if (argc > 9) kNumaNode = (int)atoi(argv[9]);
+  // the keys and the encoders are then allocated on the node's memory
+  if (kNumaNode >= 0 && !pinThread(getCpuList(kNumaNode))) {
+    std::cout << "Cannot run on NUMA node " << kNumaNode << std::endl;
+    return 1;
+  }
 
-  std::vector<std::string> emails;
-  std::vector<std::string> emails1;
-  std::vector<std::string> emails2;
   std::vector<std::string> emails_shuffle;
   std::vector<std::string> emails1_shuffle;
   std::vector<std::string> emails2_shuffle;
@@ -350,24 +676,22 @@ int main(int argc, char *argv[]) {
   int64_t total_len_email2 = 0;
 
   if (kRunEmail) {
-    loadKeys(file_email, emails, emails_shuffle);
-    loadKeys(file_email1, emails1, emails1_shuffle);
-    loadKeys(file_email2, emails2, emails2_shuffle);
+    loadKeys(file_email, emails_shuffle);
+    loadKeys(file_email1, emails1_shuffle);
+    loadKeys(file_email2, emails2_shuffle);
   }
 
-  std::vector<std::string> wikis;
   std::vector<std::string> wikis_shuffle;
   int64_t total_len_wiki = 0;
 
   if (kRunWiki) {
-    loadKeys(file_wiki, wikis, wikis_shuffle);
+    loadKeys(file_wiki, wikis_shuffle);
   }
 
-  std::vector<std::string> urls;
   std::vector<std::string> urls_shuffle;
   int64_t total_len_url = 0;
   if (kRunUrl) {
-    loadKeys(file_url, urls, urls_shuffle);
+    loadKeys(file_url, urls_shuffle);
   }
 
   if (expt_id == 0) {
@@ -736,6 +1060,75 @@ int main(int argc, char *argv[]) {
     std::cout << "---------------Dataset 2, Dictionary 1-----------------" << std::endl;
     exec_helper(encoder_type, W, input_dict_size, sample1_keys, emails2_shuffle, total_len_email2, encode_method,
                 batch_size, bt, tput, lat, cpr, dict_size, mem);
+  } else if (expt_id == 10) {
+    //-------------------------------------------------------------
+    // Encode Scalability; Expt ID = 10
+    //-------------------------------------------------------------
+    std::cout << "------------------------------------------------" << std::endl;
+    std::cout << "Encode Scalability; Expt ID = 10" << std::endl;
+    std::cout << "------------------------------------------------" << std::endl;
+    std::vector<int> cpus = getCpuList(kNumaNode);
+    if (cpus.empty()) {
+      std::cout << "No CPUs to run on" << std::endl;
+      return 1;
+    }
+    output_scalability.open(file_scalability);
+    output_scalability << "wkld_id,encoder_type,dict_size,threads,mops,thread_mops,efficiency,efficiency_min\n";
+
+    int sample_percent = 1;
+    int stop_method = (runALM == 1) ? 7 : 5;
+    int run_wkld[3] = {kRunEmail, kRunWiki, kRunUrl};
+    std::vector<std::string> *wkld_keys[3] = {&emails_shuffle, &wikis_shuffle, &urls_shuffle};
+    for (int wkld_id = kEmail; wkld_id <= kUrl; wkld_id++) {
+      if (!run_wkld[wkld_id]) continue;
+      execScalability(wkld_id, 1, 0, sample_percent, *wkld_keys[wkld_id], cpus);
+      execScalability(wkld_id, 2, 6, sample_percent, *wkld_keys[wkld_id], cpus);
+      for (int ds = 0; ds < 7; ds++) {
+        for (int et = 3; et < stop_method; et++)
+          execScalability(wkld_id, et, ds, sample_percent, *wkld_keys[wkld_id], cpus);
+      }
+      for (int ds = 7; ds < 9; ds++) {
+        for (int et = 4; et < stop_method; et++)
+          execScalability(wkld_id, et, ds, sample_percent, *wkld_keys[wkld_id], cpus);
+      }
+    }
+    output_scalability.close();
+  } else if (expt_id == 11) {
+    //-------------------------------------------------------------
+    // Dictionary Size vs Cache; Expt ID = 11
+    //-------------------------------------------------------------
+    std::cout << "------------------------------------------------" << std::endl;
+    std::cout << "Dictionary Size vs Cache; Expt ID = 11" << std::endl;
+    std::cout << "------------------------------------------------" << std::endl;
+    std::vector<benchharness::CacheLevel> levels = benchharness::readCacheLevels();
+    for (const benchharness::CacheLevel &level : levels)
+      std::cout << level.name << " = " << level.size_bytes << " B, line = " << level.line_bytes << " B" << std::endl;
+    output_cache_sweep.open(file_cache_sweep);
+    output_cache_sweep << "wkld_id,encoder_type,dict_size,cpr,lat_ns_per_char,memory_bytes,working_set_bytes,tier\n";
+    output_cache_recommend.open(file_cache_recommend);
+    output_cache_recommend << "wkld_id,encoder_type,tier,cache_bytes,max_dict_size,falls_out_at\n";
+
+    int sample_percent = 1;
+    int stop_method = (runALM == 1) ? 7 : 5;
+    int run_wkld[3] = {kRunEmail, kRunWiki, kRunUrl};
+    std::vector<std::string> *wkld_keys[3] = {&emails_shuffle, &wikis_shuffle, &urls_shuffle};
+    for (int wkld_id = kEmail; wkld_id <= kUrl; wkld_id++) {
+      if (!run_wkld[wkld_id]) continue;
+      std::vector<CachePoint> points;
+      points.push_back(execCacheSweep(wkld_id, 1, 0, sample_percent, *wkld_keys[wkld_id], levels));
+      points.push_back(execCacheSweep(wkld_id, 2, 6, sample_percent, *wkld_keys[wkld_id], levels));
+      for (int ds = 0; ds < 7; ds++) {
+        for (int et = 3; et < stop_method; et++)
+          points.push_back(execCacheSweep(wkld_id, et, ds, sample_percent, *wkld_keys[wkld_id], levels));
+      }
+      for (int ds = 7; ds < 9; ds++) {
+        for (int et = 4; et < stop_method; et++)
+          points.push_back(execCacheSweep(wkld_id, et, ds, sample_percent, *wkld_keys[wkld_id], levels));
+      }
+      reportCacheTiers(wkld_id, levels, points);
+    }
+    output_cache_sweep.close();
+    output_cache_recommend.close();
   }
   return 0;
 }
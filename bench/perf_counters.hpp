@@ -0,0 +1,173 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "bench_harness.hpp"
+
+// Hardware performance counters for the benchmark phases, through
+// perf_event_open. Optional: events the kernel or the (virtual) machine
+// does not expose are skipped, and on other platforms none are available
+namespace benchharness {
+
+class PerfCounters {
+ public:
+  enum Event { kCycles = 0, kInstructions, kL1dMisses, kLlcMisses, kDtlbMisses, kBranchMisses, kTaskClock, kNumEvents };
+
+  static const char *eventName(const int event) {
+    static const char *kNames[kNumEvents] = {"cycles",      "instructions", "l1d_misses", "llc_misses",
+					     "dtlb_misses", "branch_misses", "task_clock_ns"};
+    return kNames[event];
+  }
+
+  // Counts user-space events of this process and of the threads it
+  // creates after construction (inherited counts are added as they exit)
+  PerfCounters() {
+    for (int i = 0; i < kNumEvents; i++) {
+      fds_[i] = openEvent(i);
+      values_[i] = 0;
+    }
+  }
+
+  ~PerfCounters() {
+#ifdef __linux__
+    for (int i = 0; i < kNumEvents; i++)
+      if (fds_[i] >= 0) close(fds_[i]);
+#endif
+  }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  bool available(const int event) const { return fds_[event] >= 0; }
+
+  // Whether any hardware event (i.e., other than the task clock) opened
+  bool hardwareAvailable() const {
+    for (int i = 0; i < kTaskClock; i++)
+      if (available(i)) return true;
+    return false;
+  }
+
+  void start() {
+#ifdef __linux__
+    for (int i = 0; i < kNumEvents; i++) {
+      if (fds_[i] < 0) continue;
+      ioctl(fds_[i], PERF_EVENT_IOC_RESET, 0);
+      ioctl(fds_[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  // Reads the counts since start(), scaled up by enabled / running time
+  // when the kernel had to multiplex the counters
+  void stop() {
+#ifdef __linux__
+    for (int i = 0; i < kNumEvents; i++) {
+      if (fds_[i] < 0) continue;
+      ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+      uint64_t data[3];  // value, time enabled, time running
+      values_[i] = 0;
+      if (read(fds_[i], data, sizeof(data)) != (ssize_t)sizeof(data) || data[2] == 0) continue;
+      values_[i] = (data[2] < data[1]) ? (double)data[0] * data[1] / data[2] : (double)data[0];
+    }
+#endif
+  }
+
+  double value(const int event) const { return values_[event]; }
+
+  // The available counts of the last start() / stop() divided by num_ops,
+  // as (<prefix>_<event>_per_<unit>, value), plus <prefix>_ipc
+  std::vector<std::pair<std::string, double> > perOp(const std::string &prefix, const double num_ops,
+						      const std::string &unit) const {
+    std::vector<std::pair<std::string, double> > metrics;
+    if (num_ops <= 0) return metrics;
+    for (int i = 0; i < kNumEvents; i++) {
+      if (!available(i)) continue;
+      metrics.push_back(std::make_pair(prefix + "_" + eventName(i) + "_per_" + unit, values_[i] / num_ops));
+    }
+    if (available(kCycles) && available(kInstructions) && values_[kCycles] > 0)
+      metrics.push_back(std::make_pair(prefix + "_ipc", values_[kInstructions] / values_[kCycles]));
+    return metrics;
+  }
+
+ private:
+  static int openEvent(const int event) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    switch (event) {
+      case kCycles:
+	attr.config = PERF_COUNT_HW_CPU_CYCLES;
+	break;
+      case kInstructions:
+	attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+	break;
+      case kBranchMisses:
+	attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+	break;
+      case kTaskClock:
+	attr.type = PERF_TYPE_SOFTWARE;
+	attr.config = PERF_COUNT_SW_TASK_CLOCK;
+	break;
+      default:
+	attr.type = PERF_TYPE_HW_CACHE;
+	attr.config = cacheConfig(event == kL1dMisses ? PERF_COUNT_HW_CACHE_L1D
+				  : event == kLlcMisses ? PERF_COUNT_HW_CACHE_LL
+							: PERF_COUNT_HW_CACHE_DTLB);
+    }
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    (void)event;
+    return -1;
+#endif
+  }
+
+#ifdef __linux__
+  static uint64_t cacheConfig(const uint64_t cache) {
+    return cache | ((uint64_t)PERF_COUNT_HW_CACHE_OP_READ << 8) | ((uint64_t)PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  }
+#endif
+
+  int fds_[kNumEvents];
+  double values_[kNumEvents];
+};
+
+// One line of the available counts per op, e.g., for microbench
+inline void printPerfCounters(std::ostream &os, const std::string &name, const PerfCounters &counters,
+			      const double num_ops, const std::string &unit) {
+  os << name << " per " << unit << ":";
+  for (const auto &metric : counters.perOp(name, num_ops, unit)) {
+    std::string event = metric.first.substr(name.size() + 1);
+    size_t suffix = event.rfind("_per_");
+    if (suffix != std::string::npos) event = event.substr(0, suffix);
+    os << " " << event << "=" << std::fixed << std::setprecision(2) << metric.second;
+  }
+  os.unsetf(std::ios::fixed);
+  os << std::setprecision(6);
+  if (!counters.hardwareAvailable()) os << " (hardware counters unavailable)";
+  os << "\n";
+}
+
+}  // namespace benchharness
+
+#endif  // PERF_COUNTERS_H
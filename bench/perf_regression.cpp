@@ -0,0 +1,222 @@
+#include <stdint.h>
+#include <sys/time.h>
+
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "bench_harness.hpp"
+#include "encoder_factory.hpp"
+#include "key_set.hpp"
+#include "regression_check.hpp"
+
+// Usage: perf_regression [--option=value ...]; see --help
+// A fast performance regression suite over the small datasets under
+// datasets/. For every encoder type (and, for the ngram and ALM ones,
+// every size in kDictSizes), builds the encoder on a sample of each
+// dataset --reps times and encodes all the keys. The baseline is taken
+// with more repetitions (kBaselineReps) than a check, so that its
+// standard deviations are not underestimated. It measures the build
+// time, encode ns/char, compression rate and memory, and compares them
+// with the committed baseline (regression_check.hpp). Exits with 1 on a
+// regression; configurations with a timing regression are measured a
+// second time first. With --update=1 it writes the measurements as the
+// new baseline instead.
+namespace perfregression {
+
+static const char *kDatasets[3] = {"words", "wikis", "urls"};
+static const int kDictSizes[3] = {1024, 8192, 65536};
+static const int64_t kNumSampleKeys = 10000;
+static const int kBaselineReps = 10;
+static const int kMaxEncodeLen = 8192;
+
+double getNow() {
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+void addOptions(benchharness::Options *options) {
+  options->add("datasets", "datasets", "directory of words.txt, wikis.txt and urls.txt");
+  options->add("baseline", "bench/regression_baseline.csv", "baseline file to check against (or to write)");
+  options->add("update", "0", "1 to write the measurements as the new baseline instead of checking");
+  options->add("output", "", "file to also write the measurements to, in the baseline format");
+  options->add("reps", "3", "repetitions of every build and encode run (at least 10 with --update=1)");
+  options->add("check_timing", "1", "0 to check only the compression rate and memory");
+  options->add("verbose", "0", "1 to print every comparison, not only the changed ones");
+}
+
+void addEntry(const std::string &config, const std::string &metric, const std::vector<double> &values,
+	      std::vector<benchharness::BaselineEntry> *entries) {
+  benchharness::Stats stats = benchharness::computeStats(values);
+  entries->push_back(benchharness::BaselineEntry{config, metric, stats.median, sqrt(stats.variance)});
+}
+
+// ns per char of a byte-wise FNV-1a hash over the keys: a reference for
+// the speed of the machine, timed next to every build and encode run
+double calibrate(const std::vector<std::string> &keys) {
+  static volatile uint64_t sink = 0;
+  int64_t num_chars = 0;
+  uint64_t hash = 14695981039346656037ULL;
+  double time_start = getNow();
+  for (const std::string &key : keys) {
+    for (char c : key) hash = (hash ^ (uint8_t)c) * 1099511628211ULL;
+    num_chars += key.length();
+  }
+  double time_diff = getNow() - time_start;
+  sink = sink + hash;
+  return time_diff * 1000000000 / num_chars;
+}
+
+std::string configName(const std::string &dataset, const int encoder_type, const int dict_size) {
+  return dataset + "/" + std::to_string(encoder_type) + "/" + std::to_string(dict_size);
+}
+
+void measure(const std::string &dataset, const std::vector<std::string> &keys,
+	     const std::vector<std::string> &sample_keys, const int encoder_type, const int dict_size,
+	     const int reps, std::vector<benchharness::BaselineEntry> *entries) {
+  std::string config = configName(dataset, encoder_type, dict_size);
+  int64_t num_chars = 0;
+  for (const std::string &key : keys) num_chars += key.length();
+
+  std::vector<double> calibration_ns_per_char, build_sec, encode_ns_per_char, compression_rate, memory_bytes;
+  std::vector<uint8_t> buffer(kMaxEncodeLen);
+  for (int rep = 0; rep < reps; rep++) {
+    calibration_ns_per_char.push_back(calibrate(keys));
+    hope::Encoder *encoder = hope::EncoderFactory::createEncoder(encoder_type);
+    double time_start = getNow();
+    encoder->build(sample_keys, dict_size);
+    build_sec.push_back(getNow() - time_start);
+    memory_bytes.push_back((double)encoder->memoryUse());
+
+    int64_t total_enc_len = 0;
+    time_start = getNow();
+    for (const std::string &key : keys) total_enc_len += encoder->encode(key, buffer.data());
+    encode_ns_per_char.push_back((getNow() - time_start) * 1000000000 / num_chars);
+    compression_rate.push_back(num_chars * 8.0 / total_enc_len);
+    delete encoder;
+  }
+  addEntry(config, benchharness::kCalibrationMetric, calibration_ns_per_char, entries);
+  addEntry(config, "build_sec", build_sec, entries);
+  addEntry(config, "encode_ns_per_char", encode_ns_per_char, entries);
+  addEntry(config, "compression_rate", compression_rate, entries);
+  addEntry(config, "memory_bytes", memory_bytes, entries);
+  std::cerr << config << ": CPR = " << benchharness::computeStats(compression_rate).median
+	    << ", encode = " << benchharness::computeStats(encode_ns_per_char).median << " ns/char" << std::endl;
+}
+
+// Every configuration of the suite, in order
+struct Config {
+  int dataset_id;
+  int encoder_type;
+  int dict_size;
+};
+
+std::vector<Config> allConfigs() {
+  std::vector<Config> configs;
+  for (int d = 0; d < 3; d++) {
+    // the single and double char dictionaries have a fixed size; the
+    // limits are the ones microbench builds them with
+    configs.push_back(Config{d, 1, kDictSizes[0]});
+    configs.push_back(Config{d, 2, 65536});
+    for (int dict_size : kDictSizes) {
+      for (int encoder_type = 3; encoder_type <= 6; encoder_type++) configs.push_back(Config{d, encoder_type, dict_size});
+    }
+  }
+  return configs;
+}
+
+}  // namespace perfregression
+
+using namespace perfregression;
+
+int main(int argc, char *argv[]) {
+  benchharness::Options options;
+  addOptions(&options);
+  std::string error;
+  if (!options.parse(argc, argv, &error) || options.helpRequested()) {
+    if (!error.empty()) std::cerr << error << std::endl;
+    std::cerr << "Usage: " << argv[0] << " [--option=value ...]\n";
+    options.printHelp(std::cerr);
+    return error.empty() ? 0 : 1;
+  }
+  int reps = std::max(1, (int)options.getInt("reps"));
+  bool update = (options.getInt("update") != 0);
+  if (update) reps = std::max(reps, kBaselineReps);
+
+  std::vector<benchharness::BaselineEntry> baseline;
+  if (!update) {
+    std::ifstream infile(options.get("baseline"));
+    if (!infile.is_open() || !benchharness::RegressionChecker::readBaseline(infile, &baseline, &error)) {
+      std::cerr << "Cannot read baseline " << options.get("baseline") << " " << error << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<std::vector<std::string> > datasets;
+  std::vector<std::vector<std::string> > samples;
+  for (const char *dataset : kDatasets) {
+    benchharness::KeySet key_set;
+    std::string file_name = options.get("datasets") + "/" + dataset + ".txt";
+    if (!key_set.open(file_name) || key_set.size() == 0) {
+      std::cerr << "Cannot load keys from " << file_name << std::endl;
+      return 1;
+    }
+    benchharness::KeyIds ids = key_set.ids();
+    datasets.push_back(key_set.strings(ids));
+    samples.push_back(key_set.strings(benchharness::KeySet::sample(ids, key_set.size() / kNumSampleKeys)));
+  }
+
+  std::vector<Config> configs = allConfigs();
+  std::vector<benchharness::BaselineEntry> current;
+  for (const Config &config : configs) {
+    measure(kDatasets[config.dataset_id], datasets[config.dataset_id], samples[config.dataset_id],
+	    config.encoder_type, config.dict_size, reps, &current);
+  }
+  if (update) {
+    std::ofstream outfile(options.get("baseline"));
+    benchharness::RegressionChecker::writeBaseline(outfile, current);
+    std::cout << "Wrote " << current.size() << " baseline entries to " << options.get("baseline") << std::endl;
+    return outfile.good() ? 0 : 1;
+  }
+
+  benchharness::RegressionChecker checker(baseline, options.getInt("check_timing") != 0);
+  std::vector<benchharness::RegressionChecker::Result> results = checker.check(current);
+  // a timing regression has to show up again in a second measurement
+  std::set<std::string> retry_configs;
+  for (const auto &result : results) {
+    const benchharness::MetricPolicy *policy = benchharness::findPolicy(result.metric);
+    if (result.verdict == benchharness::RegressionChecker::kRegressed && policy->timing)
+      retry_configs.insert(result.config);
+  }
+  if (!retry_configs.empty()) {
+    std::cerr << "Measuring " << retry_configs.size() << " configurations again" << std::endl;
+    std::vector<benchharness::BaselineEntry> retried;
+    for (const Config &config : configs) {
+      std::string name = configName(kDatasets[config.dataset_id], config.encoder_type, config.dict_size);
+      std::vector<benchharness::BaselineEntry> entries;
+      if (retry_configs.count(name) > 0) {
+	measure(kDatasets[config.dataset_id], datasets[config.dataset_id], samples[config.dataset_id],
+		config.encoder_type, config.dict_size, reps, &entries);
+      } else {
+	for (const benchharness::BaselineEntry &entry : current) {
+	  if (entry.config == name) entries.push_back(entry);
+	}
+      }
+      retried.insert(retried.end(), entries.begin(), entries.end());
+    }
+    current.swap(retried);
+    results = checker.check(current);
+  }
+
+  if (!options.get("output").empty()) {
+    std::ofstream outfile(options.get("output"));
+    benchharness::RegressionChecker::writeBaseline(outfile, current);
+  }
+  benchharness::RegressionChecker::printResults(std::cout, results, options.getInt("verbose") != 0);
+  int num_failures = benchharness::RegressionChecker::numFailures(results);
+  std::cout << results.size() << " checks, " << num_failures << " failed" << std::endl;
+  return (num_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+#include <stdlib.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "encoder_factory.hpp"
+#include "encoder_profiler.hpp"
+
+// Usage: profile_encoder <build_key_file> <workload_key_file> <encoder_type> <dict_size> [num_entries] [json]
+// Builds the encoder on a uniform sample of the build keys (one per line),
+// then profiles it on every workload key and prints the effective and
+// entropy-bound compression rates and the hottest and coldest dictionary
+// entries; as JSON if the last argument is 1. A workload that compresses
+// much worse than the build estimate has drifted from the sample.
+static const int64_t kSampleSize = 100000;
+
+int main(int argc, char *argv[]) {
+  if (argc < 5) {
+    std::cout << "Usage: " << argv[0]
+	      << " <build_key_file> <workload_key_file> <encoder_type> <dict_size> [num_entries] [json]" << std::endl;
+    return 1;
+  }
+  int encoder_type = atoi(argv[3]);
+  int64_t dict_size = atoll(argv[4]);
+  int num_entries = (argc > 5) ? atoi(argv[5]) : 20;
+  bool as_json = (argc > 6) && (atoi(argv[6]) != 0);
+  if (encoder_type < 1 || encoder_type > 6) {
+    std::cout << "Unknown encoder type " << encoder_type << std::endl;
+    return 1;
+  }
+
+  hope::Encoder *encoder = hope::EncoderFactory::createEncoder(encoder_type);
+  encoder->setKeepSymbols(true);
+  encoder->setResetPeakRss(true);
+  if (!encoder->buildFromFile(argv[1], dict_size, kSampleSize)) {
+    std::cout << "Cannot build from " << argv[1] << std::endl;
+    return 1;
+  }
+  std::ifstream infile(argv[2]);
+  if (!infile.is_open()) {
+    std::cout << "Cannot open " << argv[2] << std::endl;
+    return 1;
+  }
+  hope::EncoderProfiler profiler(encoder);
+  std::string key;
+  while (std::getline(infile, key)) {
+    if (!key.empty()) profiler.profile(key);
+  }
+
+  const hope::BuildStats &stats = encoder->buildStats();
+  if (as_json) {
+    std::cout << "{\"build\":" << stats.toJson() << ",\"profile\":" << profiler.toJson(num_entries) << "}" << std::endl;
+  } else {
+    std::cout << "Build: " << stats.num_intervals << " intervals, sample compression rate "
+	      << stats.sample_compression_rate << std::endl;
+    profiler.printReport(std::cout, num_entries);
+  }
+  delete encoder;
+  return 0;
+}
@@ -0,0 +1,205 @@
+#ifndef REGRESSION_CHECK_H
+#define REGRESSION_CHECK_H
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench_harness.hpp"
+
+// Baselines and the regression checks of the performance regression
+// suite (perf_regression.cpp)
+namespace benchharness {
+
+// One measured metric of one configuration (e.g., "wikis/3/4096")
+struct BaselineEntry {
+  std::string config;
+  std::string metric;
+  double median;
+  // standard deviation over the repetitions; 0 for exact metrics
+  double stddev;
+};
+
+//------------------------------------------------------------------
+// How far a metric may move before it counts as a regression. The
+// allowed change is tolerance * baseline plus kNoiseFactor times the
+// larger of the two standard deviations, and never below min_delta.
+// Timing metrics are first scaled by the ratio of the configuration's
+// calibration metric (a reference loop timed next to it) between the two
+// runs, so a baseline taken on another machine, or a machine that slows
+// down during the run, does not fail the check. As that ratio is itself
+// measured, their allowed change also grows by kNoiseFactor times the
+// relative standard deviation of the calibration, of the noisier run
+//------------------------------------------------------------------
+struct MetricPolicy {
+  const char *metric;
+  bool higher_is_better;
+  bool timing;
+  double tolerance;
+  double min_delta;
+};
+
+static const double kNoiseFactor = 3;
+static const char *const kCalibrationMetric = "calibration_ns_per_char";
+
+inline const std::vector<MetricPolicy> &metricPolicies() {
+  static const std::vector<MetricPolicy> kPolicies = {
+      {"compression_rate", true, false, 0.001, 0},
+      {"memory_bytes", false, false, 0.01, 0},
+      {"encode_ns_per_char", false, true, 0.25, 0},
+      {"build_sec", false, true, 0.5, 0.01},
+  };
+  return kPolicies;
+}
+
+inline const MetricPolicy *findPolicy(const std::string &metric) {
+  for (const MetricPolicy &policy : metricPolicies()) {
+    if (metric == policy.metric) return &policy;
+  }
+  return nullptr;
+}
+
+class RegressionChecker {
+ public:
+  enum Verdict { kUnchanged = 0, kImproved, kRegressed, kNew, kMissing };
+
+  struct Result {
+    std::string config;
+    std::string metric;
+    Verdict verdict;
+    double baseline;  // scaled by the calibration ratio for timing metrics
+    double current;
+    double allowed_delta;
+  };
+
+  static const char *verdictName(const Verdict verdict) {
+    static const char *kNames[5] = {"ok", "improved", "REGRESSED", "new", "MISSING"};
+    return kNames[verdict];
+  }
+
+  // CSV rows of config,metric,median,stddev under a header line
+  static bool readBaseline(std::istream &is, std::vector<BaselineEntry> *entries, std::string *error) {
+    std::string line;
+    int line_num = 0;
+    while (std::getline(is, line)) {
+      line_num++;
+      if (line.empty() || line_num == 1) continue;
+      std::vector<std::string> fields;
+      std::stringstream ss(line);
+      std::string field;
+      while (std::getline(ss, field, ',')) fields.push_back(field);
+      if (fields.size() != 4) {
+	*error = "line " + std::to_string(line_num) + ": expected config,metric,median,stddev";
+	return false;
+      }
+      entries->push_back(BaselineEntry{fields[0], fields[1], atof(fields[2].c_str()), atof(fields[3].c_str())});
+    }
+    return true;
+  }
+
+  static void writeBaseline(std::ostream &os, const std::vector<BaselineEntry> &entries) {
+    os << "config,metric,median,stddev\n";
+    for (const BaselineEntry &entry : entries) {
+      os << entry.config << "," << entry.metric << "," << formatDouble(entry.median) << ","
+	 << formatDouble(entry.stddev) << "\n";
+    }
+  }
+
+  RegressionChecker(const std::vector<BaselineEntry> &baseline, const bool check_timing)
+      : baseline_(baseline), check_timing_(check_timing) {}
+
+  // Compares every current entry with its baseline; baseline entries
+  // that were not measured are reported as missing
+  std::vector<Result> check(const std::vector<BaselineEntry> &current) const {
+    std::vector<Result> results;
+    for (const BaselineEntry &entry : current) {
+      const MetricPolicy *policy = findPolicy(entry.metric);
+      if (policy == nullptr || (policy->timing && !check_timing_)) continue;
+      const BaselineEntry *base = find(baseline_, entry.config, entry.metric);
+      Result result = {entry.config, entry.metric, kNew, 0, entry.median, 0};
+      if (base != nullptr) {
+	double scale = policy->timing ? calibrationRatio(current, entry.config) : 1;
+	double calibration_noise = policy->timing ? calibrationNoise(current, entry.config) : 0;
+	result.baseline = base->median * scale;
+	result.allowed_delta =
+	    std::max((policy->tolerance + kNoiseFactor * calibration_noise) * fabs(result.baseline) +
+			 kNoiseFactor * std::max(base->stddev * scale, entry.stddev),
+		     policy->min_delta);
+	double gain = policy->higher_is_better ? entry.median - result.baseline : result.baseline - entry.median;
+	if (gain < -result.allowed_delta)
+	  result.verdict = kRegressed;
+	else if (gain > result.allowed_delta)
+	  result.verdict = kImproved;
+	else
+	  result.verdict = kUnchanged;
+      }
+      results.push_back(result);
+    }
+    for (const BaselineEntry &base : baseline_) {
+      const MetricPolicy *policy = findPolicy(base.metric);
+      if (policy == nullptr || (policy->timing && !check_timing_)) continue;
+      if (find(current, base.config, base.metric) == nullptr)
+	results.push_back(Result{base.config, base.metric, kMissing, base.median, 0, 0});
+    }
+    return results;
+  }
+
+  // Current over baseline calibration of a configuration; 1 if unknown
+  double calibrationRatio(const std::vector<BaselineEntry> &current, const std::string &config) const {
+    const BaselineEntry *base = find(baseline_, config, kCalibrationMetric);
+    const BaselineEntry *cur = find(current, config, kCalibrationMetric);
+    if (base == nullptr || cur == nullptr || base->median <= 0 || cur->median <= 0) return 1;
+    return cur->median / base->median;
+  }
+
+  // Larger relative standard deviation of the configuration's
+  // calibration in the two runs; 0 if unknown
+  double calibrationNoise(const std::vector<BaselineEntry> &current, const std::string &config) const {
+    const BaselineEntry *entries[2] = {find(baseline_, config, kCalibrationMetric),
+				       find(current, config, kCalibrationMetric)};
+    double noise = 0;
+    for (const BaselineEntry *entry : entries) {
+      if (entry != nullptr && entry->median > 0) noise = std::max(noise, entry->stddev / entry->median);
+    }
+    return noise;
+  }
+
+  static int numFailures(const std::vector<Result> &results) {
+    int num_failures = 0;
+    for (const Result &result : results) num_failures += (result.verdict == kRegressed || result.verdict == kMissing);
+    return num_failures;
+  }
+
+  // Every result if verbose, else only the ones that changed
+  static void printResults(std::ostream &os, const std::vector<Result> &results, const bool verbose) {
+    for (const Result &result : results) {
+      if (!verbose && result.verdict == kUnchanged) continue;
+      os << std::left << std::setw(10) << verdictName(result.verdict) << std::setw(20) << result.config
+	 << std::setw(20) << result.metric << " baseline = " << result.baseline << ", current = " << result.current
+	 << ", allowed change = " << result.allowed_delta << "\n";
+    }
+  }
+
+ private:
+  static const BaselineEntry *find(const std::vector<BaselineEntry> &entries, const std::string &config,
+				   const std::string &metric) {
+    for (const BaselineEntry &entry : entries) {
+      if (entry.config == config && entry.metric == metric) return &entry;
+    }
+    return nullptr;
+  }
+
+  std::vector<BaselineEntry> baseline_;
+  bool check_timing_;
+};
+
+}  // namespace benchharness
+
+#endif  // REGRESSION_CHECK_H
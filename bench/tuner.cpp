@@ -0,0 +1,44 @@
+#include <stdlib.h>
+
+#include <fstream>
+#include <iostream>
+
+#include "encoder_tuner.hpp"
+
+// Usage: tuner <key_file> <memory_budget_bytes> [latency_budget_ns_per_key] [sample_size]
+// Reads one key per line, keeps a uniform sample of the keys and prints
+// the measured candidates and the chosen encoder configuration.
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    std::cout << "Usage: " << argv[0]
+	      << " <key_file> <memory_budget_bytes> [latency_budget_ns_per_key] [sample_size]" << std::endl;
+    return 1;
+  }
+  int64_t memory_budget = atoll(argv[2]);
+  double latency_budget = (argc > 3) ? atof(argv[3]) : 0;
+  int64_t sample_size = (argc > 4) ? atoll(argv[4]) : hope::EncoderTuner::kDefaultTrainSize * 10;
+
+  std::ifstream infile(argv[1]);
+  if (!infile.is_open()) {
+    std::cout << "Cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+  hope::KeySampler sampler(sample_size);
+  sampler.addKeys(infile);
+  std::cout << "Read " << sampler.numKeys() << " keys, sampled "
+	    << sampler.getSample().size() << std::endl;
+
+  hope::EncoderTuner tuner(memory_budget, latency_budget);
+  hope::EncoderConfig best;
+  bool found = tuner.tune(sampler.getSample(), &best);
+  tuner.printReport(std::cout);
+  if (!found) {
+    std::cout << "No configuration within the budgets" << std::endl;
+    return 2;
+  }
+  std::cout << "Best: " << hope::EncoderTuner::encoderName(best.encoder_type)
+	    << " (type " << best.encoder_type << "), dictionary size limit " << best.dict_size_limit;
+  if (best.W > 0) std::cout << ", W " << best.W;
+  std::cout << std::endl;
+  return 0;
+}
@@ -0,0 +1,232 @@
+#ifndef WORKLOAD_GENERATOR_H
+#define WORKLOAD_GENERATOR_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// YCSB-style workloads generated in memory, deterministically from a
+// seed. The key choosers and the operation mix follow YCSB's
+// CoreWorkload, so that the workloads have the distributions of the
+// specs in workload_gen/workload_spec. A workload is a stream of
+// operations on the ids of record_count load keys: read or scan key_id.
+namespace workloadgen {
+
+enum Distribution { kUniform = 0, kZipfian = 1, kLatest = 2 };
+
+enum OpType { kRead = 0, kScan = 1 };
+
+struct Operation {
+  OpType type;
+  int64_t key_id;
+  // 0 for reads
+  int scan_len;
+};
+
+// The CoreWorkload properties that the specs use
+struct WorkloadSpec {
+  int64_t record_count = 0;
+  int64_t operation_count = 0;
+  double read_proportion = 1;
+  double scan_proportion = 0;
+  Distribution request_distribution = kZipfian;
+  int max_scan_length = 100;
+  Distribution scan_length_distribution = kUniform;
+};
+
+static const double kZipfianConstant = 0.99;
+// YCSB scrambles a zipfian over 10^10 items, with its zeta precomputed
+static const int64_t kScrambledItemCount = 10000000000LL;
+static const double kScrambledZetan = 26.46902820178302;
+
+// 64-bit FNV-1a over the bytes of val, as YCSB's Utils.FNVhash64
+inline int64_t fnvHash64(int64_t val) {
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  for (int i = 0; i < 8; i++) {
+    hash ^= (uint64_t)(val & 0xFF);
+    hash *= 1099511628211ULL;
+    val >>= 8;
+  }
+  int64_t ret = (int64_t)hash;
+  return ret < 0 ? -ret : ret;
+}
+
+// Fixed bit recipes, so that a seed gives the same workload everywhere
+class Random {
+ public:
+  explicit Random(const uint64_t seed) : rng_(seed) {}
+
+  // In [0, 1)
+  double nextDouble() { return (rng_() >> 11) * (1.0 / 9007199254740992.0); }
+
+  // In [0, n)
+  int64_t nextInt(const int64_t n) { return (int64_t)(((unsigned __int128)rng_() * (uint64_t)n) >> 64); }
+
+ private:
+  std::mt19937_64 rng_;
+};
+
+// Zipfian over [min, max], the most popular item first (Gray et al.)
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(const int64_t min, const int64_t max, const double zetan = 0)
+      : base_(min), items_(max - min + 1), theta_(kZipfianConstant) {
+    zeta2theta_ = zeta(2, theta_);
+    zetan_ = (zetan > 0) ? zetan : zeta(items_, theta_);
+    alpha_ = 1.0 / (1.0 - theta_);
+    eta_ = (1 - pow(2.0 / items_, 1 - theta_)) / (1 - zeta2theta_ / zetan_);
+    half_pow_theta_ = 1.0 + pow(0.5, theta_);
+  }
+
+  int64_t next(Random &rng) const {
+    double u = rng.nextDouble();
+    double uz = u * zetan_;
+    if (uz < 1.0) return base_;
+    if (uz < half_pow_theta_) return base_ + 1;
+    return base_ + (int64_t)(items_ * pow(eta_ * u - eta_ + 1, alpha_));
+  }
+
+ private:
+  static double zeta(const int64_t n, const double theta) {
+    double sum = 0;
+    for (int64_t i = 0; i < n; i++) sum += 1 / pow(i + 1, theta);
+    return sum;
+  }
+
+  int64_t base_;
+  int64_t items_;
+  double theta_;
+  double zeta2theta_;
+  double zetan_;
+  double alpha_;
+  double eta_;
+  double half_pow_theta_;
+};
+
+// Chooses the key ids of the operations: uniform, zipfian with the
+// popular keys scattered over the key space, or zipfian on the most
+// recently inserted keys
+class KeyChooser {
+ public:
+  KeyChooser(const Distribution distribution, const int64_t record_count)
+      : distribution_(distribution), record_count_(record_count),
+	zipfian_((distribution == kZipfian) ? ZipfianGenerator(0, kScrambledItemCount - 1, kScrambledZetan)
+					    : ZipfianGenerator(0, (distribution == kLatest) ? record_count - 1 : 0)) {}
+
+  int64_t next(Random &rng) const {
+    if (distribution_ == kZipfian) return fnvHash64(zipfian_.next(rng)) % record_count_;
+    if (distribution_ == kLatest) return record_count_ - 1 - zipfian_.next(rng);
+    return rng.nextInt(record_count_);
+  }
+
+ private:
+  Distribution distribution_;
+  int64_t record_count_;
+  ZipfianGenerator zipfian_;
+};
+
+class WorkloadGenerator {
+ public:
+  WorkloadGenerator(const WorkloadSpec &spec, const uint64_t seed)
+      : spec_(spec), rng_(seed), key_chooser_(spec.request_distribution, spec.record_count),
+	scan_len_zipfian_(1, spec.scan_length_distribution == kZipfian ? spec.max_scan_length : 1) {}
+
+  Operation next() {
+    Operation op;
+    double total = spec_.read_proportion + spec_.scan_proportion;
+    op.type = (rng_.nextDouble() * total < spec_.read_proportion) ? kRead : kScan;
+    op.key_id = key_chooser_.next(rng_);
+    op.scan_len = 0;
+    if (op.type == kScan) {
+      if (spec_.scan_length_distribution == kZipfian)
+	op.scan_len = (int)scan_len_zipfian_.next(rng_);
+      else
+	op.scan_len = 1 + (int)rng_.nextInt(spec_.max_scan_length);
+    }
+    return op;
+  }
+
+ private:
+  WorkloadSpec spec_;
+  Random rng_;
+  KeyChooser key_chooser_;
+  ZipfianGenerator scan_len_zipfian_;
+};
+
+inline Distribution parseDistribution(const std::string &name) {
+  if (name == "uniform") return kUniform;
+  if (name == "latest") return kLatest;
+  return kZipfian;
+}
+
+// Reads the properties of a YCSB workload file; the others are ignored
+inline bool loadSpec(const std::string &file_name, WorkloadSpec *spec) {
+  std::ifstream infile(file_name);
+  if (!infile.is_open()) return false;
+  std::string line;
+  while (std::getline(infile, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    size_t pos = line.find('=');
+    if (pos == std::string::npos) continue;
+    std::string name = line.substr(0, pos);
+    std::string value = line.substr(pos + 1);
+    value.erase(value.find_last_not_of(" \t\r") + 1);
+    if (name == "recordcount")
+      spec->record_count = atoll(value.c_str());
+    else if (name == "operationcount")
+      spec->operation_count = atoll(value.c_str());
+    else if (name == "readproportion")
+      spec->read_proportion = atof(value.c_str());
+    else if (name == "scanproportion")
+      spec->scan_proportion = atof(value.c_str());
+    else if (name == "requestdistribution")
+      spec->request_distribution = parseDistribution(value);
+    else if (name == "maxscanlength")
+      spec->max_scan_length = atoi(value.c_str());
+    else if (name == "scanlengthdistribution")
+      spec->scan_length_distribution = parseDistribution(value);
+  }
+  return true;
+}
+
+// The load keys: record_count keys spread evenly over the dataset. Key
+// is std::string, or a key id (benchharness::KeySet) to copy no strings
+template <class Key>
+void selectLoadKeys(const std::vector<Key> &dataset_keys, const int64_t record_count, std::vector<Key> &load_keys) {
+  int64_t num_keys = std::min(record_count, (int64_t)dataset_keys.size());
+  if (num_keys == 0) return;
+  int64_t gap = (int64_t)dataset_keys.size() / num_keys;
+  for (int64_t i = 0; i < num_keys; i++) load_keys.push_back(dataset_keys[i * gap]);
+}
+
+// The load keys of the randint workloads: YCSB's hashed key numbers
+inline void selectRandintLoadKeys(const int64_t record_count, std::vector<std::string> &load_keys) {
+  for (int64_t i = 0; i < record_count; i++) load_keys.push_back(std::to_string(fnvHash64(i)));
+}
+
+// The keys of spec.operation_count operations on load_keys (in load
+// order) and, if scan_lens is given, the scan lengths (0 for reads)
+template <class Key>
+void generateTxns(const WorkloadSpec &spec, const uint64_t seed, const std::vector<Key> &load_keys,
+		  std::vector<Key> &txn_keys, std::vector<int> *scan_lens) {
+  WorkloadSpec load_spec = spec;
+  load_spec.record_count = (int64_t)load_keys.size();
+  WorkloadGenerator generator(load_spec, seed);
+  txn_keys.reserve(txn_keys.size() + spec.operation_count);
+  if (scan_lens != nullptr) scan_lens->reserve(scan_lens->size() + spec.operation_count);
+  for (int64_t i = 0; i < spec.operation_count; i++) {
+    Operation op = generator.next();
+    txn_keys.push_back(load_keys[op.key_id]);
+    if (scan_lens != nullptr) scan_lens->push_back(op.scan_len);
+  }
+}
+
+}  // namespace workloadgen
+
+#endif  // WORKLOAD_GENERATOR_H
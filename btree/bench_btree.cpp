@@ -7,23 +7,21 @@
 
 #include "btree_map.hpp"
 #include "encoder_factory.hpp"
+#include "key_set.hpp"
+#include "packed_key.hpp"
 #include "parameters.h"
-
-static const uint64_t kNumEmailRecords = 25000000;
-static const uint64_t kNumWikiRecords = 14000;
-static const uint64_t kNumUrlRecords = 5000;
-static const uint64_t kNumTxns = 10000000;
+#include "workload_generator.hpp"
 
 static const std::string file_load_email = "workloads/load_email";
 static const std::string file_load_wiki = "workloads/load_wiki";
 static const std::string file_load_url = "workloads/load_url";
 
-static const std::string file_txn_email = "workloads/txn_email_zipfian";
-static const std::string file_txn_email_len = "workloads/scan_len_email_zipfian";
-static const std::string file_txn_wiki = "workloads/txn_wiki_zipfian";
-static const std::string file_txn_wiki_len = "workloads/scan_len_wiki_zipfian";
-static const std::string file_txn_url = "workloads/txn_url_zipfian";
-static const std::string file_txn_url_len = "workloads/scan_len_url_zipfian";
+// YCSB workload E on the load keys, generated in memory from the specs
+// that gen_workload uses
+static const std::string file_spec_email = "workload_gen/workload_spec/workloade_email_zipfian";
+static const std::string file_spec_wiki = "workload_gen/workload_spec/workloade_wiki_zipfian";
+static const std::string file_spec_url = "workload_gen/workload_spec/workloade_url_zipfian";
+static const uint64_t kWorkloadSeed = 0;
 
 // for pretty print
 static const char *kGreen = "\033[0;32m";
@@ -33,6 +31,8 @@ static int kRunALM = 1;
 static int kRunEmail = 0;
 static int kRunWiki = 0;
 static bool kRunUrl = 0;
+// 0: std::string keys; 8 or 16: tlx::PackedKey<kPackedKeyLen> keys
+static int kPackedKeyLen = 0;
 static const double kSamplePercent = 1;
 static std::string endStr = std::string(255, char(255));
 
@@ -99,130 +99,105 @@ double getNow() {
   return tv.tv_sec + tv.tv_usec / 1000000.0;
 }
 
-void loadKeysFromFile(const std::string &file_name, const uint64_t num_records, std::vector<std::string> &keys) {
-  std::ifstream infile(file_name);
-  std::string key;
-  uint64_t count = 0;
-  while (count < num_records && infile.good()) {
-    infile >> key;
-    keys.push_back(key);
-    count++;
-  }
-}
-
-void loadLensInt(const std::string &file_name, const uint64_t num_records, std::vector<int> &keys) {
-  std::ifstream infile(file_name);
-  int key;
-  uint64_t count = 0;
-  while (count < num_records && infile.good()) {
-    infile >> key;
-    keys.push_back(key);
-    count++;
-  }
-}
-
 void loadWorkload(int wkld_id, std::vector<std::string> &insert_keys, std::vector<std::string> &insert_keys_sample,
                   std::vector<std::string> &txn_keys, std::vector<int> &scan_key_lens) {
-  std::vector<std::string> load_keys;
-  if (wkld_id == kEmail)
-    loadKeysFromFile(file_load_email, kNumEmailRecords, load_keys);
-  else if (wkld_id == kWiki)
-    loadKeysFromFile(file_load_wiki, kNumWikiRecords, load_keys);
-  else if (wkld_id == kUrl)
-    loadKeysFromFile(file_load_url, kNumUrlRecords, load_keys);
-  else
+  std::string file_name, spec_file_name;
+  if (wkld_id == kEmail) {
+    file_name = file_load_email;
+    spec_file_name = file_spec_email;
+  } else if (wkld_id == kWiki) {
+    file_name = file_load_wiki;
+    spec_file_name = file_spec_wiki;
+  } else if (wkld_id == kUrl) {
+    file_name = file_load_url;
+    spec_file_name = file_spec_url;
+  } else {
     return;
-
-  std::sort(load_keys.begin(), load_keys.end());
-  for (int i = 0; i < (int)load_keys.size() - 1; i++) {
-    int key_len = load_keys[i].length();
-    int next_key_len = load_keys[i + 1].length();
-    if (key_len < next_key_len) {
-      std::string next_prefix = load_keys[i + 1].substr(0, key_len);
-      if (load_keys[i].compare(next_prefix) != 0) insert_keys.push_back(load_keys[i]);
-    } else {
-      insert_keys.push_back(load_keys[i]);
-    }
   }
-  insert_keys.push_back(load_keys[load_keys.size() - 1]);
+  workloadgen::WorkloadSpec spec;
+  if (!workloadgen::loadSpec(spec_file_name, &spec)) {
+    std::cout << "Cannot read workload spec " << spec_file_name << std::endl;
+    return;
+  }
+  // the keys stay in the mapped file; only the ones used are copied
+  benchharness::KeySet key_set;
+  if (!key_set.open(file_name)) return;
+  benchharness::KeyIds load_ids = key_set.ids(spec.record_count);
+  if (load_ids.empty()) return;
+
+  benchharness::KeyIds txn_ids;
+  workloadgen::generateTxns(spec, kWorkloadSeed, load_ids, txn_ids, &scan_key_lens);
+  txn_keys = key_set.strings(txn_ids);
+
+  key_set.sortIds(&load_ids, false);
+  // keys that are a prefix of the next one are left out
+  benchharness::KeyIds insert_ids;
+  for (int64_t i = 0; i < (int64_t)load_ids.size() - 1; i++) {
+    if (!key_set.key(load_ids[i]).isProperPrefixOf(key_set.key(load_ids[i + 1]))) insert_ids.push_back(load_ids[i]);
+  }
+  insert_ids.push_back(load_ids.back());
+  insert_keys = key_set.strings(insert_ids);
 
-  load_keys.clear();
   std::random_shuffle(insert_keys.begin(), insert_keys.end());
 
   for (int i = 0; i < (int)insert_keys.size(); i += int(100 / kSamplePercent)) {
     insert_keys_sample.push_back(insert_keys[i]);
   }
 
-  if (wkld_id == kEmail) {
-    loadKeysFromFile(file_txn_email, kNumTxns, txn_keys);
-    loadLensInt(file_txn_email_len, kNumTxns, scan_key_lens);
-  } else if (wkld_id == kWiki) {
-    loadKeysFromFile(file_txn_wiki, kNumTxns, txn_keys);
-    loadLensInt(file_txn_wiki_len, kNumTxns, scan_key_lens);
-  } else if (wkld_id == kUrl) {
-    loadKeysFromFile(file_txn_url, kNumTxns, txn_keys);
-    loadLensInt(file_txn_url_len, kNumTxns, scan_key_lens);
-  }
-
   std::cout << "insert_keys size = " << insert_keys.size() << std::endl;
   std::cout << "insert_keys_sample size = " << insert_keys_sample.size() << std::endl;
   std::cout << "txn_keys size = " << txn_keys.size() << std::endl;
   std::cout << "scan_key_lens size = " << scan_key_lens.size() << std::endl;
 }
 
-void exec(const int expt_id, const int wkld_id, const bool is_point, const bool is_compressed, const int encoder_type,
-          const int64_t dict_size_id, const std::vector<std::string> &insert_keys,
-          const std::vector<std::string> &insert_keys_sample, const std::vector<std::string> &txn_keys,
-          const std::vector<int> &scan_key_lens) {
-  hope::Encoder *encoder = nullptr;
-  uint8_t *buffer = new uint8_t[8192];
-  std::vector<std::pair<std::string, std::string> > enc_insert_keys;
-
-  int64_t input_dict_size = dict_size_list[dict_size_id];
-  if (encoder_type == 3) {
-    input_dict_size = three_gram_input_dict_size[wkld_id][dict_size_id];
-  } else if (encoder_type == 4) {
-    input_dict_size = four_gram_input_dict_size[wkld_id][dict_size_id];
-  }
-
-  int W = 0;
-  if (encoder_type == 5) W = ALM_W[wkld_id][dict_size_id];
-  if (encoder_type == 6) W = ALM_W_improved[wkld_id][dict_size_id];
-
-  int64_t total_key_size = 0;
-  double start_time = getNow();
-  if (is_compressed) {
-    encoder = hope::EncoderFactory::createEncoder(encoder_type, W);
-    encoder->build(insert_keys_sample, input_dict_size);
-  }
-
-  for (int i = 0; i < (int)insert_keys.size(); i++) {
-    std::string encode_str;
-    if (is_compressed) {
-      int enc_len = encoder->encode(insert_keys[i], buffer);
-      int enc_len_round = (enc_len + 7) >> 3;
-      encode_str = std::string((const char *)buffer, enc_len_round);
-      total_key_size += enc_len_round;
-    } else {
-      encode_str = insert_keys[i];
-      total_key_size += insert_keys[i].size();
-    }
-    enc_insert_keys.push_back(std::make_pair(insert_keys[i], encode_str));
-  }
-
+// Key types for the B+tree: the encoded keys as std::string, or as
+// tlx::PackedKey<N> with the bytes past N in an arena
+struct StringKeys {
+  typedef std::string key_type;
   typedef tlx::btree_map<std::string, uint64_t, std::less<std::string> > btree_type;
+  // estimated node size
+  static const int64_t kNodeSize = 256;
+
+  static const std::string &makeKey(const std::string &key, tlx::PackedKeyArena *arena = nullptr) { return key; }
+  static std::string makeKey(const char *key, int len) { return std::string(key, len); }
+  // std::string keys live on the heap
+  static int64_t keySize(int64_t enc_key_size, const tlx::PackedKeyArena &arena) { return enc_key_size; }
+};
+
+template <int N>
+struct PackedKeys {
+  typedef tlx::PackedKey<N> key_type;
+  typedef tlx::btree_map<key_type, uint64_t, tlx::packed_key_less<N> > btree_type;
+  static const int64_t kNodeSize = btree_type::traits::node_size;
+
+  static key_type makeKey(const std::string &key, tlx::PackedKeyArena *arena = nullptr) {
+    return key_type(key.data(), key.size(), arena);
+  }
+  static key_type makeKey(const char *key, int len) { return key_type(key, len); }
+  // only the bytes past N are outside the nodes
+  static int64_t keySize(int64_t enc_key_size, const tlx::PackedKeyArena &arena) { return arena.size(); }
+};
+
+// Inserts the encoded keys and runs the transactions
+template <class Keys>
+void runBTree(const bool is_point, const bool is_compressed, hope::Encoder *encoder, uint8_t *buffer,
+              std::vector<std::pair<std::string, std::string> > &enc_insert_keys,
+              const std::vector<std::string> &txn_keys, const std::vector<int> &scan_key_lens, double start_time,
+              const int64_t enc_key_size, double &insert_time, double &exec_time, double &mem) {
+  typedef typename Keys::btree_type btree_type;
   btree_type *bt = new btree_type();
+  tlx::PackedKeyArena arena;
   double insert_start_time = getNow();
   for (int i = 0; i < (int)enc_insert_keys.size(); i++) {
     std::pair<std::string, std::string> *tmp_pair = &enc_insert_keys[i];
     if (is_compressed) {
       encoder->encode(tmp_pair->first, buffer);
     }
-    bt->insert2(tmp_pair->second, (uint64_t) & (tmp_pair->second));
+    bt->insert2(Keys::makeKey(tmp_pair->second, &arena), (uint64_t) & (tmp_pair->second));
   }
 
   double end_time = getNow();
-  double insert_time = end_time - insert_start_time;
+  insert_time = end_time - insert_start_time;
   double build_time = end_time - start_time;
   std::cout << "Insert time = " << insert_time << std::endl;
   std::cout << "Build time = " << build_time << std::endl;
@@ -231,16 +206,19 @@ void exec(const int expt_id, const int wkld_id, const bool is_point, const bool
   std::cout << "leaves = " << bt->get_stats().leaves << std::endl;
   std::cout << "inner_nodes = " << bt->get_stats().inner_nodes << std::endl;
   std::cout << "avgfill = " << bt->get_stats().avgfill_leaves() << std::endl;
-  std::cout << "btree size = " << (256 * bt->get_stats().nodes()) << std::endl;
+  // key bytes outside the nodes
+  int64_t total_key_size = Keys::keySize(enc_key_size, arena);
+  std::cout << "btree size = " << (Keys::kNodeSize * bt->get_stats().nodes()) << std::endl;
   std::cout << "total key size = " << total_key_size << std::endl;
 
-  int64_t btree_size = 256 * bt->get_stats().nodes();
+  int64_t btree_size = Keys::kNodeSize * bt->get_stats().nodes();
   double encoder_mem = 0;
   if (encoder != nullptr) encoder_mem = encoder->memoryUse();
-  double mem = (btree_size + total_key_size + encoder_mem) / 1000000.0;
+  mem = (btree_size + total_key_size + encoder_mem) / 1000000.0;
   std::cout << kGreen << "Mem = " << kNoColor << mem << std::endl;
 
   // execute transactions =======================================
+  const typename Keys::key_type &end_key = Keys::makeKey(endStr);
   uint64_t sum = 0;
   uint64_t TIDs[120];
   start_time = getNow();
@@ -249,13 +227,12 @@ void exec(const int expt_id, const int wkld_id, const bool is_point, const bool
       for (int i = 0; i < (int)txn_keys.size(); i++) {
         int enc_len = encoder->encode(txn_keys[i], buffer);
         int enc_len_round = (enc_len + 7) >> 3;
-        std::string enc_key = std::string((const char *)buffer, enc_len_round);
-        btree_type::const_iterator iter = bt->find(enc_key);
+        typename btree_type::const_iterator iter = bt->find(Keys::makeKey((const char *)buffer, enc_len_round));
         sum += (iter->second);
       }
     } else {
       for (int i = 0; i < (int)txn_keys.size(); i++) {
-        btree_type::const_iterator iter = bt->find(txn_keys[i]);
+        typename btree_type::const_iterator iter = bt->find(Keys::makeKey(txn_keys[i]));
         sum += (iter->second);
       }
     }
@@ -265,10 +242,9 @@ void exec(const int expt_id, const int wkld_id, const bool is_point, const bool
         int enc_len = 0;
         enc_len = encoder->encode(txn_keys[i], buffer);
         int enc_len_round = (enc_len + 7) >> 3;
-        std::string left_key = std::string((const char *)buffer, enc_len_round);
-        btree_type::const_iterator iter = bt->lower_bound(left_key);
+        typename btree_type::const_iterator iter = bt->lower_bound(Keys::makeKey((const char *)buffer, enc_len_round));
         int cnt = 0;
-        while (iter != bt->end() && iter.key().compare(endStr) < 0 && cnt < scan_key_lens[i]) {
+        while (iter != bt->end() && iter.key() < end_key && cnt < scan_key_lens[i]) {
           TIDs[cnt] = iter->second;
           ++iter;
           ++cnt;
@@ -277,9 +253,9 @@ void exec(const int expt_id, const int wkld_id, const bool is_point, const bool
       std::cout << "Finish Uncompressed Range Query" << std::endl;
     } else {
       for (int i = 0; i < (int)txn_keys.size(); i++) {
-        btree_type::const_iterator iter = bt->lower_bound(txn_keys[i]);
+        typename btree_type::const_iterator iter = bt->lower_bound(Keys::makeKey(txn_keys[i]));
         int cnt = 0;
-        while (iter != bt->end() && iter.key().compare(endStr) < 0 && cnt < scan_key_lens[i]) {
+        while (iter != bt->end() && iter.key() < end_key && cnt < scan_key_lens[i]) {
           TIDs[cnt] = iter->second;
           ++iter;
           ++cnt;
@@ -289,19 +265,73 @@ void exec(const int expt_id, const int wkld_id, const bool is_point, const bool
     }
   }
   end_time = getNow();
-  double exec_time = end_time - start_time;
+  exec_time = end_time - start_time;
+  std::cout << TIDs[0] << std::endl;
+
+  delete bt;
+}
+
+void exec(const int expt_id, const int wkld_id, const bool is_point, const bool is_compressed, const int encoder_type,
+          const int64_t dict_size_id, const std::vector<std::string> &insert_keys,
+          const std::vector<std::string> &insert_keys_sample, const std::vector<std::string> &txn_keys,
+          const std::vector<int> &scan_key_lens) {
+  hope::Encoder *encoder = nullptr;
+  uint8_t *buffer = new uint8_t[8192];
+  std::vector<std::pair<std::string, std::string> > enc_insert_keys;
+
+  int64_t input_dict_size = dict_size_list[dict_size_id];
+  if (encoder_type == 3) {
+    input_dict_size = three_gram_input_dict_size[wkld_id][dict_size_id];
+  } else if (encoder_type == 4) {
+    input_dict_size = four_gram_input_dict_size[wkld_id][dict_size_id];
+  }
+
+  int W = 0;
+  if (encoder_type == 5) W = ALM_W[wkld_id][dict_size_id];
+  if (encoder_type == 6) W = ALM_W_improved[wkld_id][dict_size_id];
+
+  int64_t total_key_size = 0;
+  double start_time = getNow();
+  if (is_compressed) {
+    encoder = hope::EncoderFactory::createEncoder(encoder_type, W);
+    encoder->build(insert_keys_sample, input_dict_size);
+  }
+
+  for (int i = 0; i < (int)insert_keys.size(); i++) {
+    std::string encode_str;
+    if (is_compressed) {
+      int enc_len = encoder->encode(insert_keys[i], buffer);
+      int enc_len_round = (enc_len + 7) >> 3;
+      encode_str = std::string((const char *)buffer, enc_len_round);
+      total_key_size += enc_len_round;
+    } else {
+      encode_str = insert_keys[i];
+      total_key_size += insert_keys[i].size();
+    }
+    enc_insert_keys.push_back(std::make_pair(insert_keys[i], encode_str));
+  }
+
+  double insert_time = 0;
+  double exec_time = 0;
+  double mem = 0;
+  if (kPackedKeyLen == 8)
+    runBTree<PackedKeys<8> >(is_point, is_compressed, encoder, buffer, enc_insert_keys, txn_keys, scan_key_lens,
+                            start_time, total_key_size, insert_time, exec_time, mem);
+  else if (kPackedKeyLen == 16)
+    runBTree<PackedKeys<16> >(is_point, is_compressed, encoder, buffer, enc_insert_keys, txn_keys, scan_key_lens,
+                             start_time, total_key_size, insert_time, exec_time, mem);
+  else
+    runBTree<StringKeys>(is_point, is_compressed, encoder, buffer, enc_insert_keys, txn_keys, scan_key_lens,
+                         start_time, total_key_size, insert_time, exec_time, mem);
   double iput = enc_insert_keys.size() / insert_time / 1000000;  // Mops/sec
   double tput = txn_keys.size() / exec_time / 1000000;           // Mops/sec
   std::cout << kGreen << "Insert Througput = " << kNoColor << iput << "\n";
   std::cout << kGreen << "Lookup Throughput = " << kNoColor << tput << "\n";
   double lookup_lat = (exec_time * 1000000) / txn_keys.size();  // us
   double insert_lat = (insert_time * 1000000) / enc_insert_keys.size();
-  std::cout << TIDs[0] << std::endl;
   std::cout << kGreen << "Insert Latency = " << kNoColor << insert_lat << "\n";
   std::cout << kGreen << "Lookup Latency = " << kNoColor << lookup_lat << "\n";
 
-  delete bt;
-
   if (expt_id == 0) {
     if (wkld_id == kEmail) {
       output_lookuplat_email_btree << lookup_lat << "\n";
@@ -446,6 +476,11 @@ int main(int argc, char *argv[]) {
   kRunEmail = (int)atoi(argv[3]);
   kRunWiki = (int)atoi(argv[4]);
   kRunUrl = (int)atoi(argv[5]);
+  if (argc > 6) kPackedKeyLen = (int)atoi(argv[6]);
+  if (kPackedKeyLen != 0 && kPackedKeyLen != 8 && kPackedKeyLen != 16) {
+    std::cerr << "Unsupported packed key length " << argv[6] << " (use 0, 8 or 16)" << std::endl;
+    return 1;
+  }
 
   //-------------------------------------------------------------
   // Init Workloads
@@ -0,0 +1,205 @@
+/*******************************************************************************
+ * packed_key.hpp
+ *
+ * A fixed-width key type for storing HOPE-encoded keys in tlx B+ trees.
+ ******************************************************************************/
+
+#ifndef TLX_CONTAINER_PACKED_KEY_HEADER
+#define TLX_CONTAINER_PACKED_KEY_HEADER
+
+#include "btree.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace tlx {
+
+//! \addtogroup tlx_container_btree
+//! \{
+
+/*!
+ * Holds the bytes that PackedKeys keep out of line. Bytes are only freed
+ * with the arena, so it must outlive every tree that holds its keys.
+ */
+class PackedKeyArena
+{
+public:
+    //! Chunks grow from min_chunk_size up to max_chunk_size
+    static const size_t min_chunk_size = 1 << 12;
+    static const size_t max_chunk_size = 1 << 20;
+
+    PackedKeyArena()
+        : cur_(nullptr), left_(0), next_chunk_size_(min_chunk_size),
+          size_(0) { }
+
+    ~PackedKeyArena() {
+        for (size_t i = 0; i < chunks_.size(); ++i)
+            delete[] chunks_[i];
+    }
+
+    PackedKeyArena(const PackedKeyArena&) = delete;
+    PackedKeyArena& operator = (const PackedKeyArena&) = delete;
+
+    //! Copies len bytes of str into the arena
+    const char * copy(const char* str, size_t len) {
+        if (len > left_) {
+            size_t chunk_size = next_chunk_size_ < len ? len : next_chunk_size_;
+            cur_ = new char[chunk_size];
+            left_ = chunk_size;
+            chunks_.push_back(cur_);
+            if (next_chunk_size_ < max_chunk_size)
+                next_chunk_size_ *= 2;
+        }
+        char* dest = cur_;
+        std::memcpy(dest, str, len);
+        cur_ += len;
+        left_ -= len;
+        size_ += len;
+        return dest;
+    }
+
+    //! Number of bytes handed out
+    size_t size() const { return size_; }
+
+private:
+    std::vector<char*> chunks_;
+    char* cur_;
+    size_t left_;
+    size_t next_chunk_size_;
+    size_t size_;
+};
+
+/*!
+ * A byte string key of any length whose first N bytes are stored inline as
+ * big-endian 64-bit words, zero padded. Ordering is lexicographic on the
+ * bytes, like std::string, but keys whose first N bytes differ are ordered
+ * by one or two integer compares. This fits HOPE-encoded keys, which are
+ * short and whose leading bytes are dense.
+ *
+ * Bytes past the first N live in a side buffer: in a PackedKeyArena for
+ * keys stored in a tree, or in the caller's buffer for lookup keys.
+ */
+template <int N>
+class PackedKey
+{
+    static_assert(N > 0 && N % 8 == 0, "N must be a positive multiple of 8");
+
+public:
+    //! Number of inline words
+    static const int num_words = N / 8;
+
+    PackedKey() : tail_(nullptr), len_(0) {
+        for (int i = 0; i < num_words; ++i) words_[i] = 0;
+    }
+
+    //! A key over len bytes of str. With an arena, the bytes past the first
+    //! N are copied into it; without one, the key points into str, which
+    //! must then outlive the key (enough for lookups).
+    PackedKey(const char* str, size_t len, PackedKeyArena* arena = nullptr)
+        : tail_(nullptr), len_(static_cast<uint32_t>(len)) {
+        for (int i = 0; i < num_words; ++i) {
+            uint64_t word = 0;
+            size_t offset = i * 8;
+            if (offset + 8 <= len)
+                std::memcpy(&word, str + offset, 8);
+            else if (offset < len)
+                std::memcpy(&word, str + offset, len - offset);
+            words_[i] = __builtin_bswap64(word);
+        }
+        if (len > N)
+            tail_ = arena ? arena->copy(str + N, len - N) : str + N;
+    }
+
+    explicit PackedKey(const std::string& str, PackedKeyArena* arena = nullptr)
+        : PackedKey(str.data(), str.size(), arena) { }
+
+    //! Length in bytes
+    size_t size() const { return len_; }
+
+    //! True if the key has bytes out of line
+    bool has_tail() const { return len_ > N; }
+
+    std::string to_string() const {
+        std::string str(len_, 0);
+        for (int i = 0; i < num_words && i * 8 < (int)len_; ++i) {
+            uint64_t word = __builtin_bswap64(words_[i]);
+            size_t len = len_ - i * 8 < 8 ? len_ - i * 8 : 8;
+            std::memcpy(&str[i * 8], &word, len);
+        }
+        if (has_tail())
+            std::memcpy(&str[N], tail_, len_ - N);
+        return str;
+    }
+
+    //! Three-way comparison, like std::string::compare
+    int compare(const PackedKey& b) const {
+        for (int i = 0; i < num_words; ++i) {
+            if (words_[i] != b.words_[i])
+                return words_[i] < b.words_[i] ? -1 : 1;
+        }
+        // equal inline words with the zero padding mean that the shorter
+        // key is a prefix of the longer one, unless both go on out of line
+        if (has_tail() && b.has_tail()) {
+            uint32_t len = (len_ < b.len_ ? len_ : b.len_) - N;
+            int cmp = std::memcmp(tail_, b.tail_, len);
+            if (cmp != 0)
+                return cmp;
+        }
+        return len_ < b.len_ ? -1 : (len_ == b.len_ ? 0 : 1);
+    }
+
+    bool operator < (const PackedKey& b) const {
+        // most keys differ in the first word
+        if (words_[0] != b.words_[0])
+            return words_[0] < b.words_[0];
+        return compare(b) < 0;
+    }
+
+    bool operator == (const PackedKey& b) const {
+        return compare(b) == 0;
+    }
+
+private:
+    uint64_t words_[num_words];
+    const char* tail_;
+    uint32_t len_;
+};
+
+//! Comparator for PackedKeys; the same order as std::less<std::string> on
+//! the key bytes.
+template <int N>
+struct packed_key_less {
+    bool operator () (const PackedKey<N>& a, const PackedKey<N>& b) const {
+        return a < b;
+    }
+};
+
+/*!
+ * Traits for trees keyed by PackedKey. A PackedKey compare is about as cheap
+ * as an integer compare, so nodes are three times the default 256 bytes
+ * (a lower tree) and are still scanned linearly.
+ */
+template <int N, typename Value>
+struct btree_default_traits<PackedKey<N>, Value> {
+    static const bool self_verify = false;
+    static const bool debug = false;
+
+    //! Estimated size of a node in bytes
+    static const int node_size = 768;
+
+    static const int leaf_slots =
+        TLX_BTREE_MAX(8, node_size / (sizeof(Value)));
+    static const int inner_slots =
+        TLX_BTREE_MAX(8, node_size / (sizeof(PackedKey<N>) + sizeof(void*)));
+
+    //! Linear search in all the nodes of node_size
+    static const size_t binsearch_threshold = 1024;
+};
+
+//! \}
+
+} // namespace tlx
+
+#endif // !TLX_CONTAINER_PACKED_KEY_HEADER
@@ -0,0 +1,161 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "btree_map.hpp"
+#include "encoder_factory.hpp"
+#include "packed_key.hpp"
+
+namespace packedkeytest {
+
+static const std::string kWordFilePath = "../../../datasets/words.txt";
+static const int kWordTestSize = 234369;
+static const int kRandomTestSize = 100000;
+static const int kEncoderType = 3;
+static const int kDictSizeLimit = 10000;
+static std::vector<std::string> words;
+
+class PackedKeyUnitTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {}
+  virtual void TearDown() {}
+};
+
+int sign(const int cmp) { return (cmp > 0) - (cmp < 0); }
+
+// Short keys over a small alphabet that includes the zero byte, so that
+// prefixes, zero padding and tails all show up often
+std::vector<std::string> randomKeys() {
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<> len_dis(0, 40);
+  std::uniform_int_distribution<> byte_dis(0, 3);
+  std::vector<std::string> keys;
+  for (int i = 0; i < kRandomTestSize; i++) {
+    std::string key(len_dis(gen), 0);
+    for (int j = 0; j < (int)key.length(); j++) key[j] = (char)byte_dis(gen);
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+template <int N>
+void checkOrder(const std::vector<std::string> &keys) {
+  tlx::PackedKeyArena arena;
+  std::vector<tlx::PackedKey<N>> packed_keys;
+  for (int i = 0; i < (int)keys.size(); i++) {
+    packed_keys.push_back(tlx::PackedKey<N>(keys[i], &arena));
+    ASSERT_EQ(keys[i], packed_keys[i].to_string());
+  }
+  for (int i = 1; i < (int)keys.size(); i++) {
+    int cmp = keys[i - 1].compare(keys[i]);
+    ASSERT_EQ(sign(cmp), sign(packed_keys[i - 1].compare(packed_keys[i])));
+    ASSERT_EQ(cmp < 0, packed_keys[i - 1] < packed_keys[i]);
+    ASSERT_EQ(cmp > 0, packed_keys[i] < packed_keys[i - 1]);
+    ASSERT_EQ(cmp == 0, packed_keys[i - 1] == packed_keys[i]);
+  }
+}
+
+TEST_F(PackedKeyUnitTest, compareTest) {
+  std::vector<std::string> keys = randomKeys();
+  checkOrder<8>(keys);
+  checkOrder<16>(keys);
+  checkOrder<8>(words);
+  checkOrder<16>(words);
+}
+
+// Keys that only differ in the zero padding or past the inline bytes
+TEST_F(PackedKeyUnitTest, paddingTest) {
+  std::string a("abc", 3);
+  std::string b("abc\0", 4);
+  std::string c("abcdefgh\0\0", 10);
+  std::string d("abcdefgh\0\1", 10);
+  tlx::PackedKey<8> ka(a), kb(b), kc(c), kd(d);
+  EXPECT_TRUE(ka < kb);
+  EXPECT_FALSE(kb < ka);
+  EXPECT_TRUE(kc < kd);
+  EXPECT_FALSE(kc == kd);
+  EXPECT_TRUE(kc.has_tail());
+  EXPECT_FALSE(kb.has_tail());
+  // lookup keys point into the caller's buffer
+  tlx::PackedKey<8> lookup(d.data(), d.length());
+  EXPECT_TRUE(lookup == kd);
+}
+
+template <int N>
+void checkMap(const std::vector<std::string> &keys) {
+  typedef tlx::btree_map<tlx::PackedKey<N>, uint64_t, tlx::packed_key_less<N>> BTreeMap;
+  tlx::PackedKeyArena arena;
+  BTreeMap *bt = new BTreeMap();
+  std::vector<uint64_t> order(keys.size());
+  for (uint64_t i = 0; i < order.size(); i++) order[i] = i;
+  std::shuffle(order.begin(), order.end(), std::mt19937(0));
+  for (uint64_t i : order) bt->insert(std::make_pair(tlx::PackedKey<N>(keys[i], &arena), i));
+  ASSERT_EQ(keys.size(), bt->size());
+
+  for (uint64_t i = 0; i < keys.size(); i++) {
+    auto iter = bt->find(tlx::PackedKey<N>(keys[i].data(), keys[i].length()));
+    ASSERT_TRUE(iter != bt->end());
+    ASSERT_EQ(i, iter->second);
+  }
+
+  // keys are sorted, so a scan visits them by index
+  uint64_t i = 0;
+  for (auto iter = bt->begin(); iter != bt->end(); ++iter, ++i) ASSERT_EQ(i, iter->second);
+  ASSERT_EQ(keys.size(), i);
+
+  // lower_bound of a key that is not in the tree
+  for (uint64_t j = 0; j + 1 < keys.size(); j += 97) {
+    std::string probe = keys[j];
+    probe.push_back('\0');
+    auto iter = bt->lower_bound(tlx::PackedKey<N>(probe.data(), probe.length()));
+    if (keys[j + 1] == probe) continue;
+    ASSERT_TRUE(iter != bt->end());
+    ASSERT_EQ(j + 1, iter->second);
+  }
+  delete bt;
+}
+
+TEST_F(PackedKeyUnitTest, btreeWordTest) {
+  checkMap<8>(words);
+  checkMap<16>(words);
+}
+
+TEST_F(PackedKeyUnitTest, btreeEncodedWordTest) {
+  hope::Encoder *encoder = hope::EncoderFactory::createEncoder(kEncoderType);
+  encoder->build(words, kDictSizeLimit);
+  std::vector<std::string> enc_keys;
+  uint8_t buffer[256];
+  for (int i = 0; i < (int)words.size(); i++) {
+    int len = (encoder->encode(words[i], buffer) + 7) >> 3;
+    enc_keys.push_back(std::string((const char *)buffer, len));
+  }
+  // padding can map neighboring words to the same encoded key
+  enc_keys.erase(std::unique(enc_keys.begin(), enc_keys.end()), enc_keys.end());
+  checkMap<8>(enc_keys);
+  delete encoder;
+}
+
+void loadWordList() {
+  std::ifstream infile(kWordFilePath);
+  std::string key;
+  int count = 0;
+  while (infile.good() && count < kWordTestSize) {
+    infile >> key;
+    words.push_back(key);
+    count++;
+  }
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+}
+
+}  // namespace packedkeytest
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  packedkeytest::loadWordList();
+  return RUN_ALL_TESTS();
+}
@@ -33,21 +33,27 @@ int main() {
     encoder->build(key_samples, 5000); // 2nd para is dictionary size limit
 
     // compress all keys
+    // encoded keys are bit strings, zero padded to whole bytes
     std::vector<std::string> enc_keys;
+    std::vector<int> enc_bit_lens;
     int64_t total_enc_len = 0;
     uint8_t *buffer = new uint8_t[1024];
     for (int i = 0; i < (int)keys.size(); i++) {
 	int bit_len = encoder->encode(keys[i], buffer);
 	total_enc_len += bit_len;
 	enc_keys.push_back(std::string((const char *)buffer, (bit_len + 7) / 8));
+	enc_bit_lens.push_back(bit_len);
     }
 
     double cpr_rate =  total_key_len / (total_enc_len + 0.0);
     std::cout << "Compression Rate = " << cpr_rate << std::endl;
 
-    // verify the order-preserving property of HOPE
+    // verify the order-preserving property of HOPE; the padded bytes
+    // can tie, so compare on the exact bit lengths
+    // (hope::toCanonicalKey gives a byte form that never ties)
     for (int i = 0; i < (int)keys.size() - 1; i++) {
-	int cmp = enc_keys[i].compare(enc_keys[i + 1]);
+	int cmp = hope::compareEncodedKeys((const uint8_t *)enc_keys[i].data(), enc_bit_lens[i],
+					   (const uint8_t *)enc_keys[i + 1].data(), enc_bit_lens[i + 1]);
 	if (cmp >= 0) {
 	    std::cout << "Order-Preserving property violated!" << std::endl;
 	    return -1;
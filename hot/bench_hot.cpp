@@ -337,9 +337,9 @@ void exec(const int expt_id, const int wkld_id, const bool is_point,
     std::string tmp_str;
     for (int i = 0; i < (int)insert_keys.size(); i++) {
         if (is_compressed) {
-            int enc_len = encoder->encode(insert_keys[i], buffer);
-            int enc_len_round = (enc_len + 7) >> 3;
-            tmp_str = std::string((const char*)buffer, enc_len_round);
+            // HOT keys are C strings, so the encoded keys must not hold zero bytes
+            int enc_len = encoder->encodeZeroFree(insert_keys[i], buffer);
+            tmp_str = std::string((const char*)buffer, enc_len);
         } else {
             tmp_str = insert_keys[i];
         }
@@ -355,7 +355,7 @@ void exec(const int expt_id, const int wkld_id, const bool is_point,
     for (int i = 0; i < (int)cstr_enc_insert_keys.size(); i++) {
         std::pair<std::string, char*>* tmp_pair = &cstr_enc_insert_keys[i];
         if (is_compressed) {
-            encoder->encode(tmp_pair->first, buffer);
+            encoder->encodeZeroFree(tmp_pair->first, buffer);
         }
         ht->insert(tmp_pair->second);
     }
@@ -405,10 +405,8 @@ void exec(const int expt_id, const int wkld_id, const bool is_point,
     if (is_point) { // point query
         if (is_compressed) {
             for (int i = 0; i < (int)txn_keys.size(); i++) {
-                int enc_len = encoder->encode(txn_keys[i], buffer);
-                int enc_len_round = (enc_len + 7) >> 3;
-                std::string enc_key = std::string((const char*)buffer, enc_len_round);
-                sum += ht->lookup(reinterpret_cast<const char*>(enc_key.c_str())).mIsValid;
+                encoder->encodeZeroFree(txn_keys[i], buffer);
+                sum += ht->lookup(reinterpret_cast<const char*>(buffer)).mIsValid;
 	        }
 	    } else {
 	        for (int i = 0; i < (int)txn_keys.size(); i++) {
@@ -419,12 +417,8 @@ void exec(const int expt_id, const int wkld_id, const bool is_point,
         std::string endStr = std::string(255, char(255));
         if (is_compressed) {
             for (int i = 0; i < (int)txn_keys.size(); i++) {
-                int enc_len = 0;
-
-	            enc_len = encoder->encode(txn_keys[i], buffer);
-                int enc_len_round = (enc_len + 7) >> 3;
-                std::string left_key = std::string((const char*)buffer, enc_len_round);
-                hot_type::const_iterator iter = ht->lower_bound((const char*)(left_key.c_str()));
+                encoder->encodeZeroFree(txn_keys[i], buffer);
+                hot_type::const_iterator iter = ht->lower_bound((const char*)buffer);
                 int cnt = 0;
                 while (iter != ht->end() && endStr.compare(*iter) > 0
                     && cnt < scan_key_lens[i]) {
@@ -0,0 +1,162 @@
+#ifndef BUILD_STATS_H
+#define BUILD_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+
+namespace hope {
+
+enum BuildPhase { kSymbolSelect = 0, kCodeAssign, kDictBuild, kNumBuildPhases };
+
+// Peak resident set size of the process in bytes (VmHWM); -1 if unknown
+inline int64_t peakRssBytes() {
+#ifdef __linux__
+  FILE *file = fopen("/proc/self/status", "r");
+  if (file == nullptr) return -1;
+  char line[256];
+  int64_t kb = -1;
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    if (strncmp(line, "VmHWM:", 6) == 0) {
+      long long value = 0;
+      if (sscanf(line + 6, "%lld", &value) == 1) kb = value;
+      break;
+    }
+  }
+  fclose(file);
+  return (kb < 0) ? -1 : kb * 1024;
+#else
+  return -1;
+#endif
+}
+
+// Restarts the peak RSS from the current RSS (Linux >= 4.0). Returns
+// false if it cannot, in which case the peak stays the process's peak
+inline bool resetPeakRss() {
+#ifdef __linux__
+  FILE *file = fopen("/proc/self/clear_refs", "w");
+  if (file == nullptr) return false;
+  bool ok = (fputs("5", file) >= 0);
+  return (fclose(file) == 0) && ok;
+#else
+  return false;
+#endif
+}
+
+// What the last Encoder::build did: wall time and peak RSS of each
+// phase, and the shape of the dictionary it produced
+struct BuildStats {
+  static const char *phaseName(const int phase) {
+    static const char *kNames[kNumBuildPhases] = {"symbol_select", "code_assign", "dict_build"};
+    return kNames[phase];
+  }
+
+  double phase_sec[kNumBuildPhases] = {0, 0, 0};
+  // peak RSS of the process during the phase with Encoder::setResetPeakRss;
+  // otherwise (or if it cannot be reset) the process's peak so far. -1 if
+  // unknown
+  int64_t phase_peak_rss_bytes[kNumBuildPhases] = {-1, -1, -1};
+  double total_sec = 0;
+  int64_t num_sample_keys = 0;
+  // distinct symbols seen in the sample (e.g., ngrams or blended
+  // strings) that the selector chose the intervals from
+  int64_t num_candidate_symbols = 0;
+  // dictionary entries
+  int64_t num_intervals = 0;
+  // over the dictionary entries, in bits
+  double avg_code_len = 0;
+  int max_code_len = 0;
+  // the code assigner's estimate over the sample, taking the interval
+  // boundaries as the symbols; 0 if unknown
+  double sample_compression_rate = 0;
+
+  void setCodeLens(const Code *codes, const int64_t num_codes) {
+    int64_t total_len = 0;
+    max_code_len = 0;
+    for (int64_t i = 0; i < num_codes; i++) {
+      total_len += codes[i].len;
+      if (codes[i].len > max_code_len) max_code_len = codes[i].len;
+    }
+    avg_code_len = (num_codes == 0) ? 0 : (double)total_len / num_codes;
+  }
+
+  void setCodeLens(const std::vector<SymbolCode> &symbol_code_list) {
+    std::vector<Code> codes;
+    for (const SymbolCode &symbol_code : symbol_code_list) codes.push_back(symbol_code.second);
+    setCodeLens(codes.data(), (int64_t)codes.size());
+  }
+
+  // (name, value) of every field, e.g., symbol_select_sec
+  std::vector<std::pair<std::string, double> > metrics() const {
+    std::vector<std::pair<std::string, double> > metrics;
+    for (int i = 0; i < kNumBuildPhases; i++)
+      metrics.push_back(std::make_pair(std::string(phaseName(i)) + "_sec", phase_sec[i]));
+    for (int i = 0; i < kNumBuildPhases; i++)
+      metrics.push_back(
+	  std::make_pair(std::string(phaseName(i)) + "_peak_rss_bytes", (double)phase_peak_rss_bytes[i]));
+    metrics.push_back(std::make_pair("total_sec", total_sec));
+    metrics.push_back(std::make_pair("num_sample_keys", (double)num_sample_keys));
+    metrics.push_back(std::make_pair("num_candidate_symbols", (double)num_candidate_symbols));
+    metrics.push_back(std::make_pair("num_intervals", (double)num_intervals));
+    metrics.push_back(std::make_pair("avg_code_len", avg_code_len));
+    metrics.push_back(std::make_pair("max_code_len", (double)max_code_len));
+    metrics.push_back(std::make_pair("sample_compression_rate", sample_compression_rate));
+    return metrics;
+  }
+
+  std::string toJson() const {
+    std::ostringstream os;
+    os.precision(10);
+    os << "{";
+    std::vector<std::pair<std::string, double> > all = metrics();
+    for (size_t i = 0; i < all.size(); i++) os << (i == 0 ? "" : ",") << "\"" << all[i].first << "\":" << all[i].second;
+    os << "}";
+    return os.str();
+  }
+
+  void print(std::ostream &os) const {
+    for (const auto &metric : metrics()) os << metric.first << " = " << metric.second << "\n";
+  }
+};
+
+// Fills a BuildStats phase by phase while an encoder builds. Resets the
+// process's peak RSS at every phase only if reset_peak_rss is set
+class BuildStatsRecorder {
+ public:
+  BuildStatsRecorder(BuildStats *stats, const int64_t num_sample_keys, const bool reset_peak_rss = false)
+      : stats_(stats), reset_peak_rss_(reset_peak_rss) {
+    *stats_ = BuildStats();
+    stats_->num_sample_keys = num_sample_keys;
+    start_time_ = getNow();
+    phase_start_time_ = start_time_;
+    if (reset_peak_rss_) resetPeakRss();
+  }
+
+  // The phase ran since the previous endPhase (or the construction)
+  void endPhase(const BuildPhase phase) {
+    double now = getNow();
+    stats_->phase_sec[phase] = now - phase_start_time_;
+    stats_->phase_peak_rss_bytes[phase] = peakRssBytes();
+    stats_->total_sec = now - start_time_;
+    if (reset_peak_rss_) resetPeakRss();
+    phase_start_time_ = getNow();
+  }
+
+ private:
+  BuildStats *stats_;
+  bool reset_peak_rss_;
+  double start_time_;
+  double phase_start_time_;
+};
+
+}  // namespace hope
+
+#endif  // BUILD_STATS_H
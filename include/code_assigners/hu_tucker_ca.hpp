@@ -1,6 +1,8 @@
 #ifndef HU_TUCKER_CA_H
 #define HU_TUCKER_CA_H
 
+#include <stdint.h>
+
 #include <queue>
 
 #include "code_assigner.hpp"
@@ -28,6 +30,10 @@ class HuTuckerCA : public CodeAssigner {
   ~HuTuckerCA();
   bool assignCodes(const std::vector<SymbolFreq> &symbol_freq_list,
 		   std::vector<SymbolCode> *symbol_code_list);
+  // Same as above for symbols that are only known by their order;
+  // code_list[i] is the code of the symbol with frequency freq_list[i]
+  bool assignCodes(const std::vector<int64_t> &freq_list,
+		   std::vector<Code> *code_list);
   int getCodeLen() const;
   double getCompressionRate() const;
 
@@ -67,9 +73,24 @@ bool HuTuckerCA::assignCodes(const std::vector<SymbolFreq> &symbol_freq_list, st
   return true;
 }
 
+bool HuTuckerCA::assignCodes(const std::vector<int64_t> &freq_list, std::vector<Code> *code_list) {
+  clear();
+  if (freq_list.size() < 2) return false;
+  freq_list_ = freq_list;
+  genOptimalCodeLen();
+  buildBinaryTree();
+
+  for (int i = 0; i < (int)freq_list_.size(); i++) {
+    code_list->push_back(lookup(i));
+  }
+  return true;
+}
+
 int HuTuckerCA::getCodeLen() const { return -1; }
 
 double HuTuckerCA::getCompressionRate() const {
+  // symbol lengths are unknown without the symbols
+  if (symbol_list_.size() != freq_list_.size()) return 0;
   int64_t freq_sum = 0;
   for (int i = 0; i < (int)freq_list_.size(); i++) {
     freq_sum += freq_list_[i];
@@ -99,79 +120,74 @@ void HuTuckerCA::loadInput(const std::vector<SymbolFreq> &symbol_freq_list) {
   }
 }
 
+// Optimal alphabetic code lengths by the Garsia-Wachs algorithm, which
+// yields the same total code length as the first phase of Hu-Tucker.
+// The working sequence is kept as a stack that, in practice, stays
+// short, so this runs in near-linear time instead of quadratic.
 void HuTuckerCA::genOptimalCodeLen() {
   int n = (int)freq_list_.size();
-  int64_t maxp = 1;
-  std::vector<int> L, s, d;
-  std::vector<int64_t> P;
-  for (int k = 0; k < n; k++) {
-    L.push_back(0);
-    P.push_back(freq_list_[k]);
-    maxp += freq_list_[k];
-  }
-
-  for (int m = 0; m < n - 1; m++) {
-    int i = 0, i1 = 0, i2 = 0;
-    int64_t pmin = maxp;
-    int sumL = -1;
-    while (i < n - 1) {
-      if (P[i] == 0) {
-        i++;
-        continue;
-      }
-      int j1 = i, j2 = -1;
-      int64_t min1 = P[i], min2 = maxp;
-      int minL1 = L[i], minL2 = -1;
-
-      int j = 0;
-      for (j = i + 1; j < n; j++) {
-        if (P[j] == 0) continue;
-        if (P[j] < min1 || (P[j] == min1 && L[j] < minL1)) {
-          min2 = min1;
-          j2 = j1;
-          minL2 = minL1;
-          min1 = P[j];
-          j1 = j;
-          minL1 = L[j];
-        } else if (P[j] < min2 || (P[j] == min2 && L[j] < minL2)) {
-          min2 = P[j];
-          j2 = j;
-          minL2 = L[j];
-        }
-        if (L[j] == 0) break;
-      }
-
-      int64_t pt = P[j1] + P[j2];
-      int sumLt = L[j1] + L[j2];
-      if (pt < pmin || (pt == pmin && sumLt < sumL)) {
-        pmin = pt;
-        sumL = sumLt;
-        i1 = j1;
-        i2 = j2;
+  code_len_list_.assign(n, 0);
+  if (n < 2) return;
+
+  // nodes 0 to n-1 are the symbols; combined nodes are appended
+  std::vector<int> parent(2 * n - 1, -1);
+  int num_nodes = n;
+  // (weight, node id); the bottom entry is a sentinel heavier than any
+  std::vector<std::pair<int64_t, int> > stack;
+  stack.push_back(std::make_pair(INT64_MAX, -1));
+
+  // combines stack[k - 1] and stack[k] and moves the result left past
+  // the lighter entries; returns its new position
+  auto combine_at = [&](int k) {
+    int64_t weight = stack[k - 1].first + stack[k].first;
+    int node = num_nodes++;
+    parent[stack[k - 1].second] = node;
+    parent[stack[k].second] = node;
+    stack.erase(stack.begin() + k);
+    int j = k - 1;
+    for (; stack[j - 1].first < weight; j--) {
+      stack[j] = stack[j - 1];
+    }
+    stack[j] = std::make_pair(weight, node);
+    return j;
+  };
+  // combines at k, then restores stack[i - 2] > stack[i] to the left of
+  // every moved entry; pending holds, for the entries still to be
+  // checked, the number of stack entries from them to the top
+  std::vector<int> pending;
+  auto combine = [&](int k) {
+    int j = combine_at(k);
+    while (true) {
+      if (j >= 3 && stack[j - 2].first <= stack[j].first) {
+        pending.push_back((int)stack.size() - j);
+        j = combine_at(j - 1);
+      } else if (!pending.empty()) {
+        j = (int)stack.size() - pending.back();
+        pending.pop_back();
+      } else {
+        break;
       }
-      i = j;
     }
+  };
 
-    if (i1 > i2) {
-      int tmp = i1;
-      i1 = i2;
-      i2 = tmp;
+  for (int k = 0; k < n; k++) {
+    assert(freq_list_[k] > 0);
+    stack.push_back(std::make_pair(freq_list_[k], k));
+    while (stack.size() >= 4 && stack[stack.size() - 3].first <= stack[stack.size() - 1].first) {
+      combine((int)stack.size() - 2);
     }
-    s.push_back(i1);
-    d.push_back(i2);
-    P[i1] = pmin;
-    P[i2] = 0;
-    L[i1] = sumL + 1;
   }
-
-  L[s[n - 2]] = 0;
-  for (int m = n - 2; m >= 0; m--) {
-    L[s[m]] += 1;
-    L[d[m]] = L[s[m]];
+  while (stack.size() > 2) {
+    combine((int)stack.size() - 1);
   }
 
+  // parents are created after their children
+  std::vector<int> depth(num_nodes, 0);
+  for (int node = num_nodes - 2; node >= 0; node--) {
+    depth[node] = depth[parent[node]] + 1;
+  }
   for (int k = 0; k < n; k++) {
-    code_len_list_.push_back(L[k]);
+    code_len_list_[k] = depth[k];
   }
 }
 
@@ -15,9 +15,6 @@
 // The current decoder implementation is experimental and less optimized
 #define INCLUDE_DECODE 1
 
-// For benchmark only
-// #define PRINT_BUILD_TIME_BREAKDOWN 1
-
 // For batch encoding benchmark only
 // #define BATCH_DRY_ENCODE 1
 
@@ -59,38 +56,6 @@ double getNow() {
   return tv.tv_sec + tv.tv_usec / 1000000.0;
 }
 
-void setStopWatch(double &cur_time, int msg_select) {
-#ifdef PRINT_BUILD_TIME_BREAKDOWN
-  std::cout << "------------------------Build ";
-  if (msg_select == 1)
-    std::cout << "SingleChar";
-  else if (msg_select == 2)
-    std::cout << "DoubleChar";
-  else if (msg_select == 3 || msg_select == 4)
-    std::cout << msg_select << "-Gram";
-  else if (msg_select == 5)
-    std::cout << "ALM";
-  else if (msg_select == 6)
-    std::cout << "ALM-Improved";
-  std::cout << " Encoder-----------------------" << std::endl;
-#endif
-  cur_time = getNow();
-}
-
-void printElapsedTime(double &cur_time, int msg_select) {
-#ifdef PRINT_BUILD_TIME_BREAKDOWN
-  double elapsed_time = getNow() - cur_time;
-  if (msg_select == 0)
-    std::cout << "Symbol Select ";
-  else if (msg_select == 1)
-    std::cout << "Code Assign ";
-  else if (msg_select == 2)
-    std::cout << "Build Dictionary ";
-  std::cout << "time = " << elapsed_time << std::endl;
-#endif
-  cur_time = getNow();
-}
-
 }  // namespace hope
 
 #endif  // COMMON_H
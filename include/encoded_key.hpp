@@ -0,0 +1,109 @@
+#ifndef ENCODED_KEY_H
+#define ENCODED_KEY_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+
+#include "zero_free.hpp"
+
+namespace hope {
+
+// An encoded key is a bit string: encode() writes its bits to a buffer,
+// zero padded to whole bytes, and returns its bit length. HOPE preserves
+// order on the bit strings, where a prefix sorts before its extensions.
+//
+// Indexes store the padded bytes, which keep the order but not strictly:
+// keys whose codes only differ in trailing zero bits (e.g., 1 and 10)
+// pad to the same bytes. This header has the exact comparison, a
+// byte form that is strictly ordered, and the bounds to use for raw-key
+// ranges over padded bytes.
+
+inline int byteLen(const int bit_len) { return (bit_len + 7) >> 3; }
+
+// Compares two encoded keys on their exact bit lengths, like memcmp
+inline int compareEncodedKeys(const uint8_t *a, const int a_bit_len,
+			      const uint8_t *b, const int b_bit_len) {
+  int bit_len = a_bit_len < b_bit_len ? a_bit_len : b_bit_len;
+  int num_bytes = bit_len >> 3;
+  int cmp = memcmp(a, b, num_bytes);
+  if (cmp != 0) return cmp;
+  int num_bits = bit_len & 7;
+  if (num_bits > 0) {
+    uint8_t mask = (uint8_t)(0xFF << (8 - num_bits));
+    int a_byte = a[num_bytes] & mask;
+    int b_byte = b[num_bytes] & mask;
+    if (a_byte != b_byte) return a_byte - b_byte;
+  }
+  return (a_bit_len > b_bit_len) - (a_bit_len < b_bit_len);
+}
+
+//------------------------------------------------------------------
+// Canonical form: the padded bytes escaped as in zero_free.hpp, a zero
+// byte and the number of bits used in the last byte (1-8; 0 for an
+// empty key). It is one-to-one and memcmp orders it exactly like
+// compareEncodedKeys: padded bytes that differ order the keys as the
+// bits do, the zero byte sorts a key before the keys it is a byte
+// prefix of, and the bit count sorts the ones that pad to the same bytes.
+// It takes two bytes more than the padded bytes, plus the escapes
+//------------------------------------------------------------------
+
+// buffer may be enc_key and needs room for 2 * byteLen(bit_len) + 2
+// bytes. Returns the canonical length
+inline int toCanonicalKey(const uint8_t *enc_key, const int bit_len, uint8_t *buffer) {
+  int byte_len = byteLen(bit_len);
+  memmove(buffer, enc_key, byte_len);
+  int num_last_bits = (bit_len == 0) ? 0 : ((bit_len - 1) & 7) + 1;
+  if (byte_len > 0) buffer[byte_len - 1] &= (uint8_t)(0xFF << (8 - num_last_bits));
+  int len = escapeZeroBytes(buffer, byte_len);
+  buffer[len + 1] = (uint8_t)num_last_bits;
+  return len + 2;
+}
+
+inline std::string toCanonicalKey(const uint8_t *enc_key, const int bit_len) {
+  std::string key(2 * byteLen(bit_len) + 2, 0);
+  key.resize(toCanonicalKey(enc_key, bit_len, (uint8_t *)&key[0]));
+  return key;
+}
+
+// Reverses toCanonicalKey. buffer may be key. Returns the bit length
+inline int fromCanonicalKey(const uint8_t *key, const int len, uint8_t *buffer) {
+  int byte_len = unescapeZeroBytes(key, len - 2, buffer);
+  return (byte_len == 0) ? 0 : ((byte_len - 1) << 3) + key[len - 1];
+}
+
+//------------------------------------------------------------------
+// Range bounds over padded bytes. The encoded keys of a raw-key range
+// lie between the encoded bounds, but a key can pad to a bound's bytes
+// without being equal to it, so an exclusive raw bound stays exclusive
+// only where that cannot happen:
+// - left: a code above enc(l) pads to enc(l)'s bytes only if enc(l)
+//   ends inside a byte (it extends enc(l) with zero bits)
+// - right: a code below enc(r) pads to enc(r)'s bytes only if enc(r)
+//   ends with a zero bit that is not the first bit of its byte (enc(r)
+//   extends it with zero bits)
+// Both are then the tightest bounds on the padded bytes
+//------------------------------------------------------------------
+
+struct EncodedBound {
+  int bit_len;
+  // Whether the padded bytes of the bound are part of the range
+  bool inclusive;
+
+  int byteLen() const { return hope::byteLen(bit_len); }
+};
+
+inline bool paddedLeftInclusive(const int bit_len, const bool inclusive) {
+  return inclusive || (bit_len & 7) != 0;
+}
+
+inline bool paddedRightInclusive(const uint8_t *enc_key, const int bit_len, const bool inclusive) {
+  if (inclusive || (bit_len & 7) == 1 || bit_len == 0) return inclusive;
+  int last_bit = bit_len - 1;
+  return ((enc_key[last_bit >> 3] >> (7 - (last_bit & 7))) & 1) == 0;
+}
+
+}  // namespace hope
+
+#endif  // ENCODED_KEY_H
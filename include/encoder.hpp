@@ -2,11 +2,29 @@
 #define ENCODER_H
 
 #include <assert.h>
+#include <fstream>
 #include <string>
 #include <vector>
 
+#include "build_stats.hpp"
+#include "encoded_key.hpp"
+#include "key_sampler.hpp"
+#include "zero_free.hpp"
+
 namespace hope {
 
+// The smallest key above every key that starts with prefix: the prefix
+// without its trailing 0xFF bytes, with the last byte incremented.
+// Returns false if there is none (the prefix is empty or all 0xFF)
+inline bool prefixSuccessor(const std::string &prefix, std::string *successor) {
+  int len = (int)prefix.length();
+  while (len > 0 && (uint8_t)prefix[len - 1] == 0xFF) len--;
+  if (len == 0) return false;
+  successor->assign(prefix, 0, len);
+  (*successor)[len - 1] = (char)((uint8_t)prefix[len - 1] + 1);
+  return true;
+}
+
 class Encoder {
  public:
   virtual ~Encoder(){};
@@ -14,6 +32,21 @@ class Encoder {
   virtual bool build(const std::vector<std::string> &key_list,
 		     const int64_t dict_size_limit) = 0;
 
+  // Build from a stream of keys with bounded memory
+  // The dictionary is built from a uniform sample of at most
+  // sample_size_limit keys drawn in one pass over [first, last)
+  template <typename InputIt>
+  bool buildFromStream(InputIt first, InputIt last,
+		       const int64_t dict_size_limit,
+		       const int64_t sample_size_limit,
+		       const uint64_t seed = 0);
+
+  // Same as buildFromStream, reading one key per line from file_name
+  bool buildFromFile(const std::string &file_name,
+		     const int64_t dict_size_limit,
+		     const int64_t sample_size_limit,
+		     const uint64_t seed = 0);
+
   virtual int encode(const std::string &key, uint8_t *buffer) const = 0;
 
   // Encode a pair of keys at the same time
@@ -21,6 +54,28 @@ class Encoder {
 			  uint8_t *l_buffer, uint8_t *r_buffer,
                           int &l_enc_len, int &r_enc_len) const = 0;
 
+  // Encode the bounds of a raw-key range for an index over padded bytes.
+  // Sets the bounds' bit lengths and whether their bytes are in the
+  // range, so that the byte range is the tightest one that covers every
+  // key in the raw range (see encoded_key.hpp)
+  void encodeRange(const std::string &l_key, const bool l_inclusive,
+		   const std::string &r_key, const bool r_inclusive,
+		   uint8_t *l_buffer, uint8_t *r_buffer,
+		   EncodedBound *l_bound, EncodedBound *r_bound) const {
+    encodePair(l_key, r_key, l_buffer, r_buffer, l_bound->bit_len, r_bound->bit_len);
+    l_bound->inclusive = paddedLeftInclusive(l_bound->bit_len, l_inclusive);
+    r_bound->inclusive = paddedRightInclusive(r_buffer, r_bound->bit_len, r_inclusive);
+  }
+
+  // Encode the bounds of the keys that start with prefix, i.e., the raw
+  // range [prefix, prefixSuccessor(prefix)), with the same rules as
+  // encodeRange. The dictionary intervals cover every string, so a key's
+  // last symbol may run past the prefix and the bounds still hold.
+  // Returns false if the range has no upper bound; hi_bound is then unset
+  bool encodePrefixRange(const std::string &prefix,
+			 uint8_t *lo_buffer, uint8_t *hi_buffer,
+			 EncodedBound *lo_bound, EncodedBound *hi_bound) const;
+
   // Encode a batch of keys
   // The algorithm is faster than encoding the keys individually
   // because the common prefixes of the keys are only encoded once
@@ -28,14 +83,107 @@ class Encoder {
 			      int start_id, int batch_size,
                               std::vector<std::string> &enc_keys) = 0;
 
+  // Encode a key with no zero bytes and a terminating zero, for indexes
+  // that store keys as C strings (e.g., HOT). Keys keep their order (see
+  // zero_free.hpp). buffer needs room for 2 * ((bit length + 7) / 8) + 1
+  // bytes. Returns the length in bytes without the terminator
+  int encodeZeroFree(const std::string &key, uint8_t *buffer) const {
+    return escapeZeroBytes(buffer, (encode(key, buffer) + 7) >> 3);
+  }
+
+  // Batch version of encodeZeroFree; returns the total escaped length.
+  // std::string::c_str() supplies the terminators
+  int64_t encodeBatchZeroFree(const std::vector<std::string> &ori_keys,
+			      int start_id, int batch_size,
+			      std::vector<std::string> &enc_keys);
+
   virtual int decode(const std::string &enc_key,
 		     const int bit_len, uint8_t *buffer) const = 0;
 
   virtual int numEntries() const = 0;
 
   virtual int64_t memoryUse() const = 0;
+
+  // For EncoderProfiler: the code of the dictionary entry that key_str
+  // (zero-terminated, key_len bytes) starts with; prefix_len is set to
+  // the number of bytes the entry consumes
+  virtual Code lookupSymbol(const char *key_str, const int key_len, int &prefix_len) const = 0;
+
+  // For EncoderProfiler: the dictionary entries (left boundary, code) in
+  // order. Returns false if they were not kept (see setKeepSymbols)
+  virtual bool getSymbolCodes(std::vector<SymbolCode> *symbol_code_list) const = 0;
+
+  // Keep the dictionary entries of the next builds for getSymbolCodes.
+  // Only the n-gram encoders drop them otherwise
+  void setKeepSymbols(const bool keep_symbols) { keep_symbols_ = keep_symbols; }
+
+  // Number of threads used by build; 0 means all the hardware threads.
+  // The built dictionary does not depend on it
+  void setNumThreads(const int num_threads) { num_threads_ = num_threads; }
+
+  // Restart the process's peak RSS (VmHWM) at every build phase, so that
+  // buildStats() has the peak of each phase rather than of the process.
+  // This clears process-wide state (/proc/self/clear_refs), so it is off
+  // by default and meant for the benchmarks
+  void setResetPeakRss(const bool reset_peak_rss) { reset_peak_rss_ = reset_peak_rss; }
+
+  // Phase times, peak memory and dictionary shape of the last build
+  const BuildStats &buildStats() const { return build_stats_; }
+
+ protected:
+  int num_threads_ = 0;
+  bool keep_symbols_ = false;
+  bool reset_peak_rss_ = false;
+  BuildStats build_stats_;
 };
 
+template <typename InputIt>
+bool Encoder::buildFromStream(InputIt first, InputIt last,
+			      const int64_t dict_size_limit,
+			      const int64_t sample_size_limit,
+			      const uint64_t seed) {
+  KeySampler sampler(sample_size_limit, seed);
+  sampler.addKeys(first, last);
+  return build(sampler.getSample(), dict_size_limit);
+}
+
+bool Encoder::encodePrefixRange(const std::string &prefix,
+				uint8_t *lo_buffer, uint8_t *hi_buffer,
+				EncodedBound *lo_bound, EncodedBound *hi_bound) const {
+  std::string successor;
+  if (!prefixSuccessor(prefix, &successor)) {
+    lo_bound->bit_len = encode(prefix, lo_buffer);
+    lo_bound->inclusive = true;
+    return false;
+  }
+  encodeRange(prefix, true, successor, false, lo_buffer, hi_buffer, lo_bound, hi_bound);
+  return true;
+}
+
+int64_t Encoder::encodeBatchZeroFree(const std::vector<std::string> &ori_keys,
+				     int start_id, int batch_size,
+				     std::vector<std::string> &enc_keys) {
+  size_t first = enc_keys.size();
+  encodeBatch(ori_keys, start_id, batch_size, enc_keys);
+  int64_t total_len = 0;
+  for (size_t i = first; i < enc_keys.size(); i++) {
+    escapeZeroBytes(enc_keys[i]);
+    total_len += enc_keys[i].length();
+  }
+  return total_len;
+}
+
+bool Encoder::buildFromFile(const std::string &file_name,
+			    const int64_t dict_size_limit,
+			    const int64_t sample_size_limit,
+			    const uint64_t seed) {
+  std::ifstream infile(file_name);
+  if (!infile.is_open()) return false;
+  KeySampler sampler(sample_size_limit, seed);
+  sampler.addKeys(infile);
+  return build(sampler.getSample(), dict_size_limit);
+}
+
 }  // namespace hope
 
 #endif  // ENCODER_H
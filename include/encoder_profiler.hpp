@@ -0,0 +1,253 @@
+#ifndef ENCODER_PROFILER_H
+#define ENCODER_PROFILER_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "encoder.hpp"
+
+namespace hope {
+
+// What one dictionary entry did over the profiled keys
+struct SymbolProfile {
+  std::string symbol;  // left boundary of the interval
+  Code code;
+  int64_t hits;
+  int64_t bits;   // emitted, i.e., hits * code length
+  int64_t bytes;  // of the keys the entry consumed
+};
+
+//------------------------------------------------------------------
+// Profiles a built encoder on a workload: splits every key into the
+// dictionary entries that encode it, the same way encode does, and
+// counts hits, emitted bits and consumed bytes per entry. Comparing the
+// effective compression rate with BuildStats::sample_compression_rate and
+// the entropy bound tells how far the keys have drifted from the sample.
+// Encoding itself is not slowed down: keys are split a second time
+//------------------------------------------------------------------
+class EncoderProfiler {
+ public:
+  // Entries come from Encoder::getSymbolCodes; if the encoder did not keep
+  // them, entries are added as they are hit (and cold ones are unknown)
+  explicit EncoderProfiler(const Encoder *encoder) : encoder_(encoder) {
+    std::vector<SymbolCode> symbol_code_list;
+    has_all_entries_ = encoder_->getSymbolCodes(&symbol_code_list);
+    for (const SymbolCode &symbol_code : symbol_code_list) addEntry(symbol_code.first, symbol_code.second);
+  }
+
+  void profile(const std::string &key) {
+    const char *key_str = key.c_str();
+    int key_len = (int)key.length();
+    int pos = 0;
+    while (pos < key_len) {
+      int prefix_len = 0;
+      Code code = encoder_->lookupSymbol(key_str + pos, key_len - pos, prefix_len);
+      // a dictionary may consume less than one byte at the end of a key
+      if (prefix_len <= 0) prefix_len = key_len - pos;
+      prefix_len = std::min(prefix_len, key_len - pos);
+      auto iter = entry_ids_.find(codeKey(code));
+      int entry_id = (iter == entry_ids_.end()) ? addEntry(key.substr(pos, prefix_len), code) : iter->second;
+      SymbolProfile &entry = entries_[entry_id];
+      entry.hits++;
+      entry.bits += code.len;
+      entry.bytes += prefix_len;
+      pos += prefix_len;
+    }
+    num_keys_++;
+  }
+
+  void profile(const std::vector<std::string> &keys) {
+    for (const std::string &key : keys) profile(key);
+  }
+
+  void clear() {
+    for (SymbolProfile &entry : entries_) entry.hits = entry.bits = entry.bytes = 0;
+    num_keys_ = 0;
+  }
+
+  bool hasAllEntries() const { return has_all_entries_; }
+  int64_t numKeys() const { return num_keys_; }
+  const std::vector<SymbolProfile> &entries() const { return entries_; }
+
+  int64_t numHits() const {
+    int64_t hits = 0;
+    for (const SymbolProfile &entry : entries_) hits += entry.hits;
+    return hits;
+  }
+
+  int64_t numBits() const {
+    int64_t bits = 0;
+    for (const SymbolProfile &entry : entries_) bits += entry.bits;
+    return bits;
+  }
+
+  int64_t numBytes() const {
+    int64_t bytes = 0;
+    for (const SymbolProfile &entry : entries_) bytes += entry.bytes;
+    return bytes;
+  }
+
+  int64_t numColdEntries() const {
+    int64_t num_cold = 0;
+    for (const SymbolProfile &entry : entries_) num_cold += (entry.hits == 0);
+    return num_cold;
+  }
+
+  // The fewest entries that serve at least fraction of the hits: the ones
+  // a cache has to hold for that share of the lookups to hit it
+  int64_t numEntriesCovering(const double fraction) const {
+    std::vector<int64_t> hits;
+    int64_t total_hits = 0;
+    for (const SymbolProfile &entry : entries_) {
+      if (entry.hits == 0) continue;
+      hits.push_back(entry.hits);
+      total_hits += entry.hits;
+    }
+    std::sort(hits.begin(), hits.end(), std::greater<int64_t>());
+    double target = std::min(std::max(fraction, 0.0), 1.0) * total_hits;
+    int64_t covered = 0;
+    int64_t num_entries = 0;
+    while (num_entries < (int64_t)hits.size() && covered < target) covered += hits[num_entries++];
+    return num_entries;
+  }
+
+  // Key bits over encoded bits, without the padding to whole bytes
+  double compressionRate() const {
+    int64_t bits = numBits();
+    return (bits == 0) ? 0 : numBytes() * 8.0 / bits;
+  }
+
+  // Entropy of the entry hit distribution, in bits per symbol: no prefix
+  // code over these intervals averages fewer bits per symbol
+  double entropy() const {
+    int64_t hits = numHits();
+    double entropy = 0;
+    for (const SymbolProfile &entry : entries_) {
+      if (entry.hits == 0) continue;
+      double p = (double)entry.hits / hits;
+      entropy -= p * log2(p);
+    }
+    return entropy;
+  }
+
+  // The compression rate of an entropy-optimal code over the same
+  // intervals; the gap to compressionRate() is what retraining the codes
+  // (without changing the intervals) could at most recover
+  double entropyBoundCompressionRate() const {
+    double bits = entropy() * numHits();
+    return (bits <= 0) ? 0 : numBytes() * 8.0 / bits;
+  }
+
+  // The num entries with the most hits (ties by order)
+  std::vector<SymbolProfile> hottest(const int num) const { return ranked(num, true); }
+
+  // The num entries with the fewest hits, unhit ones first
+  std::vector<SymbolProfile> coldest(const int num) const { return ranked(num, false); }
+
+  // Summary and the num hottest and coldest entries
+  void printReport(std::ostream &os, const int num) const {
+    os << "keys = " << numKeys() << ", symbols = " << numHits() << ", entries = " << entries_.size()
+       << (has_all_entries_ ? "" : " (hit ones only)") << ", cold entries = " << numColdEntries() << "\n";
+    os << "compression rate = " << compressionRate() << ", entropy = " << entropy()
+       << " bits/symbol, entropy bound compression rate = " << entropyBoundCompressionRate() << "\n";
+    printEntries(os, "hottest", hottest(num));
+    printEntries(os, "coldest", coldest(num));
+  }
+
+  std::string toJson(const int num) const {
+    std::ostringstream os;
+    os.precision(10);
+    os << "{\"num_keys\":" << numKeys() << ",\"num_symbols\":" << numHits() << ",\"num_entries\":" << entries_.size()
+       << ",\"has_all_entries\":" << (has_all_entries_ ? "true" : "false") << ",\"num_cold_entries\":" << numColdEntries()
+       << ",\"compression_rate\":" << compressionRate() << ",\"entropy_bits_per_symbol\":" << entropy()
+       << ",\"entropy_bound_compression_rate\":" << entropyBoundCompressionRate();
+    os << ",\"hottest\":";
+    entriesToJson(os, hottest(num));
+    os << ",\"coldest\":";
+    entriesToJson(os, coldest(num));
+    os << "}";
+    return os.str();
+  }
+
+  // Printable form of a symbol: \xNN for the other bytes
+  static std::string escapeSymbol(const std::string &symbol) {
+    std::string escaped;
+    for (char c : symbol) {
+      uint8_t u = (uint8_t)c;
+      if (u >= 0x20 && u < 0x7F && c != '\\' && c != '"') {
+	escaped += c;
+      } else {
+	char hex[5];
+	snprintf(hex, sizeof(hex), "\\x%02x", u);
+	escaped += hex;
+      }
+    }
+    return escaped;
+  }
+
+ private:
+  static uint64_t codeKey(const Code code) { return ((uint64_t)(uint32_t)code.code << 8) | (uint8_t)code.len; }
+
+  int addEntry(const std::string &symbol, const Code code) {
+    int entry_id = (int)entries_.size();
+    entries_.push_back(SymbolProfile{symbol, code, 0, 0, 0});
+    entry_ids_[codeKey(code)] = entry_id;
+    return entry_id;
+  }
+
+  std::vector<SymbolProfile> ranked(const int num, const bool hottest) const {
+    std::vector<int> ids(entries_.size());
+    for (int i = 0; i < (int)ids.size(); i++) ids[i] = i;
+    int num_ranked = std::min(std::max(num, 0), (int)ids.size());
+    std::partial_sort(ids.begin(), ids.begin() + num_ranked, ids.end(), [&](const int x, const int y) {
+      if (entries_[x].hits != entries_[y].hits)
+	return hottest ? entries_[x].hits > entries_[y].hits : entries_[x].hits < entries_[y].hits;
+      return x < y;
+    });
+    std::vector<SymbolProfile> result;
+    for (int i = 0; i < num_ranked; i++) result.push_back(entries_[ids[i]]);
+    return result;
+  }
+
+  static void printEntries(std::ostream &os, const std::string &name, const std::vector<SymbolProfile> &entries) {
+    os << name << "\n" << std::setw(24) << "symbol" << std::setw(10) << "code_len" << std::setw(12) << "hits"
+       << std::setw(14) << "bits" << std::setw(14) << "bytes" << "\n";
+    for (const SymbolProfile &entry : entries) {
+      os << std::setw(24) << escapeSymbol(entry.symbol) << std::setw(10) << (int)entry.code.len << std::setw(12)
+	 << entry.hits << std::setw(14) << entry.bits << std::setw(14) << entry.bytes << "\n";
+    }
+  }
+
+  static void entriesToJson(std::ostream &os, const std::vector<SymbolProfile> &entries) {
+    os << "[";
+    for (size_t i = 0; i < entries.size(); i++) {
+      const SymbolProfile &entry = entries[i];
+      std::string symbol;
+      for (char c : escapeSymbol(entry.symbol)) symbol += (c == '\\') ? std::string("\\\\") : std::string(1, c);
+      os << (i == 0 ? "" : ",") << "{\"symbol\":\"" << symbol
+	 << "\",\"code_len\":" << (int)entry.code.len << ",\"hits\":" << entry.hits << ",\"bits\":" << entry.bits
+	 << ",\"bytes\":" << entry.bytes << "}";
+    }
+    os << "]";
+  }
+
+  const Encoder *encoder_;
+  bool has_all_entries_ = false;
+  std::vector<SymbolProfile> entries_;
+  std::unordered_map<uint64_t, int> entry_ids_;
+  int64_t num_keys_ = 0;
+};
+
+}  // namespace hope
+
+#endif  // ENCODER_PROFILER_H
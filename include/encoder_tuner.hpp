@@ -0,0 +1,266 @@
+#ifndef ENCODER_TUNER_H
+#define ENCODER_TUNER_H
+
+#include <limits.h>
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "encoder_factory.hpp"
+#include "key_sampler.hpp"
+
+namespace hope {
+
+// One encoder configuration and how it did on the tuning sample
+typedef struct {
+  int encoder_type;
+  int64_t dict_size_limit;
+  int W;  // only used by the ALM encoders
+  int num_entries;
+  int64_t memory;
+  double cpr;         // compression rate
+  double latency;     // encode latency in ns per key
+  double build_time;  // in seconds
+  bool within_budget;
+  bool pareto_optimal;
+} EncoderConfig;
+
+// Picks an encoder type and dictionary size for a key set under a
+// dictionary memory budget and an encode latency budget.
+// Every candidate is built on a small uniform subsample of the keys and
+// measured on a second one. Among the candidates within both budgets,
+// the one with the highest compression rate is chosen (ties go to the
+// lower latency, then to the smaller dictionary).
+class EncoderTuner {
+ public:
+  static const int64_t kDefaultTrainSize = 10000;
+  static const int64_t kDefaultEvalSize = 10000;
+  static const int64_t kDefaultMinDictSize = 1024;
+  static const int64_t kDefaultMaxDictSize = 65536;
+
+  // memory_budget: in bytes; latency_budget: in ns per key, 0 means no limit
+  EncoderTuner(const int64_t memory_budget, const double latency_budget);
+  ~EncoderTuner(){};
+
+  // Encoder types (see EncoderFactory) to try; all of them by default
+  void setEncoderTypes(const std::vector<int> &encoder_types) { encoder_types_ = encoder_types; }
+
+  // Dictionary size limits to try: min_dict_size, 2 * min_dict_size, ...
+  void setDictSizeRange(const int64_t min_dict_size, const int64_t max_dict_size);
+
+  // Number of keys used to build and to measure each candidate
+  void setSampleSize(const int64_t train_size, const int64_t eval_size);
+
+  void setSeed(const uint64_t seed) { seed_ = seed; }
+
+  // Returns false if no candidate is within the budgets
+  bool tune(const std::vector<std::string> &key_list, EncoderConfig *best_config);
+
+  const std::vector<EncoderConfig> &getCandidates() const { return candidates_; }
+
+  void printReport(std::ostream &os) const;
+
+  // Creates an encoder of the tuned configuration (not yet built)
+  static Encoder *createEncoder(const EncoderConfig &config);
+
+  static std::string encoderName(const int encoder_type);
+
+ private:
+  void evaluate(const int encoder_type, const int64_t dict_size_limit,
+		const std::vector<std::string> &train_keys,
+		const std::vector<std::string> &eval_keys,
+		EncoderConfig *config) const;
+  void markParetoOptimal();
+  // Returns true if x is at least as good as y everywhere and better somewhere
+  static bool dominates(const EncoderConfig &x, const EncoderConfig &y);
+  static bool isBetter(const EncoderConfig &x, const EncoderConfig &y);
+
+  int64_t memory_budget_;
+  double latency_budget_;
+  std::vector<int> encoder_types_;
+  int64_t min_dict_size_;
+  int64_t max_dict_size_;
+  int64_t train_size_;
+  int64_t eval_size_;
+  uint64_t seed_;
+  int W_;
+  std::vector<EncoderConfig> candidates_;
+};
+
+EncoderTuner::EncoderTuner(const int64_t memory_budget, const double latency_budget)
+    : memory_budget_(memory_budget),
+      latency_budget_(latency_budget),
+      encoder_types_({1, 2, 3, 4, 5, 6}),
+      min_dict_size_(kDefaultMinDictSize),
+      max_dict_size_(kDefaultMaxDictSize),
+      train_size_(kDefaultTrainSize),
+      eval_size_(kDefaultEvalSize),
+      seed_(0),
+      W_(0) {}
+
+void EncoderTuner::setDictSizeRange(const int64_t min_dict_size, const int64_t max_dict_size) {
+  assert(min_dict_size > 0);
+  min_dict_size_ = min_dict_size;
+  max_dict_size_ = max_dict_size;
+}
+
+void EncoderTuner::setSampleSize(const int64_t train_size, const int64_t eval_size) {
+  train_size_ = train_size;
+  eval_size_ = eval_size;
+}
+
+bool EncoderTuner::tune(const std::vector<std::string> &key_list, EncoderConfig *best_config) {
+  candidates_.clear();
+  if (key_list.empty()) return false;
+  KeySampler train_sampler(train_size_, seed_);
+  KeySampler eval_sampler(eval_size_, seed_ + 1);
+  train_sampler.addKeys(key_list.begin(), key_list.end());
+  eval_sampler.addKeys(key_list.begin(), key_list.end());
+  const std::vector<std::string> &train_keys = train_sampler.getSample();
+  const std::vector<std::string> &eval_keys = eval_sampler.getSample();
+
+  // The ALM symbol selectors binary search W in [0, 2W]; a W around
+  // the total length of the training keys keeps the dictionary sizes
+  // tried here inside that range
+  int64_t train_len = train_sampler.totalKeyLen() * (int64_t)train_keys.size() / train_sampler.numKeys();
+  W_ = (int)std::min<int64_t>(std::max<int64_t>(train_len, 1000), INT_MAX / 2);
+
+  for (int encoder_type : encoder_types_) {
+    for (int64_t dict_size = min_dict_size_; dict_size <= max_dict_size_; dict_size *= 2) {
+      EncoderConfig config;
+      evaluate(encoder_type, dict_size, train_keys, eval_keys, &config);
+      candidates_.push_back(config);
+      // the single and double char dictionaries have a fixed size
+      if (encoder_type == 1 || encoder_type == 2) break;
+      // dictionary memory grows with its size; doubling it again
+      // would not fit either
+      if (config.memory > memory_budget_ / 2) break;
+    }
+  }
+  markParetoOptimal();
+
+  const EncoderConfig *best = nullptr;
+  for (const auto &config : candidates_) {
+    if (!config.within_budget) continue;
+    if (best == nullptr || isBetter(config, *best)) best = &config;
+  }
+  if (best == nullptr) return false;
+  *best_config = *best;
+  return true;
+}
+
+void EncoderTuner::evaluate(const int encoder_type, const int64_t dict_size_limit,
+			    const std::vector<std::string> &train_keys,
+			    const std::vector<std::string> &eval_keys,
+			    EncoderConfig *config) const {
+  config->encoder_type = encoder_type;
+  config->dict_size_limit = dict_size_limit;
+  config->W = (encoder_type == 5 || encoder_type == 6) ? W_ : 0;
+  Encoder *encoder = createEncoder(*config);
+  double start_time = getNow();
+  encoder->build(train_keys, dict_size_limit);
+  config->build_time = getNow() - start_time;
+  config->num_entries = encoder->numEntries();
+  config->memory = encoder->memoryUse();
+
+  int64_t total_len = 0;
+  int64_t total_enc_len = 0;
+  int max_key_len = 0;
+  for (const auto &key : eval_keys) {
+    total_len += (int64_t)key.length();
+    max_key_len = std::max(max_key_len, (int)key.length());
+  }
+  // a code is at most 32 bits
+  uint8_t *buffer = new uint8_t[max_key_len * 4 + 64];
+  // take the fastest of a few runs to filter out noise
+  static const int kNumRuns = 3;
+  double min_time = 0;
+  for (int run = 0; run < kNumRuns; run++) {
+    total_enc_len = 0;
+    start_time = getNow();
+    for (const auto &key : eval_keys) {
+      total_enc_len += encoder->encode(key, buffer);
+    }
+    double time = getNow() - start_time;
+    if (run == 0 || time < min_time) min_time = time;
+  }
+  delete[] buffer;
+  delete encoder;
+
+  config->cpr = (total_enc_len == 0) ? 0 : (total_len * 8.0) / total_enc_len;
+  config->latency = eval_keys.empty() ? 0 : min_time * 1e9 / eval_keys.size();
+  config->within_budget = (config->memory <= memory_budget_) &&
+			  (latency_budget_ <= 0 || config->latency <= latency_budget_);
+  config->pareto_optimal = false;
+}
+
+void EncoderTuner::markParetoOptimal() {
+  for (auto &x : candidates_) {
+    x.pareto_optimal = true;
+    for (const auto &y : candidates_) {
+      if (dominates(y, x)) {
+        x.pareto_optimal = false;
+        break;
+      }
+    }
+  }
+}
+
+bool EncoderTuner::dominates(const EncoderConfig &x, const EncoderConfig &y) {
+  if (x.cpr < y.cpr || x.latency > y.latency || x.memory > y.memory) return false;
+  return x.cpr > y.cpr || x.latency < y.latency || x.memory < y.memory;
+}
+
+bool EncoderTuner::isBetter(const EncoderConfig &x, const EncoderConfig &y) {
+  if (x.cpr != y.cpr) return x.cpr > y.cpr;
+  if (x.latency != y.latency) return x.latency < y.latency;
+  return x.memory < y.memory;
+}
+
+Encoder *EncoderTuner::createEncoder(const EncoderConfig &config) {
+  if (config.encoder_type == 5 || config.encoder_type == 6)
+    return EncoderFactory::createEncoder(config.encoder_type, config.W);
+  return EncoderFactory::createEncoder(config.encoder_type);
+}
+
+std::string EncoderTuner::encoderName(const int encoder_type) {
+  if (encoder_type == 1)
+    return "Single-Char";
+  else if (encoder_type == 2)
+    return "Double-Char";
+  else if (encoder_type == 3)
+    return "3-Grams";
+  else if (encoder_type == 4)
+    return "4-Grams";
+  else if (encoder_type == 5)
+    return "ALM";
+  else if (encoder_type == 6)
+    return "ALM-Improved";
+  return "Unknown";
+}
+
+void EncoderTuner::printReport(std::ostream &os) const {
+  os << "Memory budget = " << memory_budget_ << " bytes, latency budget = ";
+  if (latency_budget_ > 0)
+    os << latency_budget_ << " ns/key" << std::endl;
+  else
+    os << "none" << std::endl;
+  os << std::left << std::setw(14) << "encoder" << std::right << std::setw(10) << "dict_size"
+     << std::setw(10) << "entries" << std::setw(12) << "memory" << std::setw(8) << "cpr"
+     << std::setw(12) << "ns/key" << std::setw(10) << "build_s" << "  budget pareto" << std::endl;
+  for (const auto &config : candidates_) {
+    os << std::left << std::setw(14) << encoderName(config.encoder_type) << std::right
+       << std::setw(10) << config.dict_size_limit << std::setw(10) << config.num_entries
+       << std::setw(12) << config.memory << std::fixed << std::setprecision(3)
+       << std::setw(8) << config.cpr << std::setprecision(1) << std::setw(12) << config.latency
+       << std::setprecision(2) << std::setw(10) << config.build_time << std::defaultfloat
+       << std::setw(8) << (config.within_budget ? "yes" : "no")
+       << std::setw(7) << (config.pareto_optimal ? "yes" : "no") << std::endl;
+  }
+}
+
+}  // namespace hope
+
+#endif  // ENCODER_TUNER_H
@@ -32,6 +32,9 @@ class ALMEncoder : public Encoder {
 
   int numEntries() const;
   int64_t memoryUse() const;
+
+  Code lookupSymbol(const char *key_str, const int key_len, int &prefix_len) const;
+  bool getSymbolCodes(std::vector<SymbolCode> *symbol_code_list) const;
   std::vector<SymbolCode> getSymbolCodeList() { return symbol_code_list; } // for test
 
  private:
@@ -44,22 +47,27 @@ class ALMEncoder : public Encoder {
 
 bool ALMEncoder::build(const std::vector<std::string> &key_list,
 			     const int64_t dict_size_limit) {
-  double cur_time = 0;
-  setStopWatch(cur_time, 5);
+  BuildStatsRecorder recorder(&build_stats_, (int64_t)key_list.size(), reset_peak_rss_);
 
   std::vector<SymbolFreq> symbol_freq_list;
+  ThreadPool pool(num_threads_);
   SymbolSelector *symbol_selector = SymbolSelectorFactory::createSymbolSelector(5);
+  symbol_selector->setThreadPool(&pool);
   reinterpret_cast<ALMSS *>(symbol_selector)->setW(W);
   symbol_selector->selectSymbols(key_list, dict_size_limit, &symbol_freq_list);
-  printElapsedTime(cur_time, 0);
+  build_stats_.num_candidate_symbols = symbol_selector->numCandidates();
+  recorder.endPhase(kSymbolSelect);
 
   CodeAssigner *code_assigner = CodeAssignerFactory::createCodeAssigner(kCaType);
   code_assigner->assignCodes(symbol_freq_list, &symbol_code_list);
-  printElapsedTime(cur_time, 1);
+  build_stats_.sample_compression_rate = code_assigner->getCompressionRate();
+  recorder.endPhase(kCodeAssign);
 
   dict_ = DictionaryFactory::createDictionary(5);
   bool ret_val = dict_->build(symbol_code_list);
-  printElapsedTime(cur_time, 2);
+  recorder.endPhase(kDictBuild);
+  build_stats_.num_intervals = (int64_t)symbol_code_list.size();
+  build_stats_.setCodeLens(symbol_code_list);
 
   delete symbol_selector;
   delete code_assigner;
@@ -127,6 +135,15 @@ int ALMEncoder::numEntries() const { return dict_->numEntries(); }
 
 int64_t ALMEncoder::memoryUse() const { return dict_->memoryUse(); }
 
+Code ALMEncoder::lookupSymbol(const char *key_str, const int key_len, int &prefix_len) const {
+  return dict_->lookup(key_str, key_len, prefix_len);
+}
+
+bool ALMEncoder::getSymbolCodes(std::vector<SymbolCode> *code_list) const {
+  code_list->insert(code_list->end(), symbol_code_list.begin(), symbol_code_list.end());
+  return true;
+}
+
 }  // namespace hope
 
 #endif  // ALM_ENCODER_H
@@ -32,8 +32,16 @@ class DoubleCharEncoder : public Encoder {
   int numEntries() const;
   int64_t memoryUse() const;
 
+  Code lookupSymbol(const char *key_str, const int key_len, int &prefix_len) const;
+  bool getSymbolCodes(std::vector<SymbolCode> *symbol_code_list) const;
+
  private:
   bool buildDict(const std::vector<SymbolCode> &symbol_code_list);
+  // Every symbol of a run gets the code of the run followed by its
+  // position in a balanced binary tree over the run
+  void assignRunCodes(const std::vector<uint16_t> &run_start_list,
+		      const std::vector<Code> &run_code_list);
+  void buildDecodeDict();
 
   Code dict_[kNumDoubleChar];
   SBT *decode_dict_;
@@ -41,25 +49,55 @@ class DoubleCharEncoder : public Encoder {
 
 bool DoubleCharEncoder::build(const std::vector<std::string> &key_list,
 			      const int64_t dict_size_limit) {
-  double cur_time = 0;
-  setStopWatch(cur_time, 2);
+  BuildStatsRecorder recorder(&build_stats_, (int64_t)key_list.size(), reset_peak_rss_);
 
-  std::vector<SymbolFreq> symbol_freq_list;
+  ThreadPool pool(num_threads_);
   SymbolSelector *symbol_selector = SymbolSelectorFactory::createSymbolSelector(2);
+  symbol_selector->setThreadPool(&pool);
+#ifdef USE_FIXED_LEN_DICT_CODE
+  std::vector<SymbolFreq> symbol_freq_list;
   symbol_selector->selectSymbols(key_list, dict_size_limit, &symbol_freq_list);
-  printElapsedTime(cur_time, 0);
+  build_stats_.num_candidate_symbols = symbol_selector->numCandidates();
+  recorder.endPhase(kSymbolSelect);
 
   std::vector<SymbolCode> symbol_code_list;
   CodeAssigner *code_assigner = CodeAssignerFactory::createCodeAssigner(kCaType);
   code_assigner->assignCodes(symbol_freq_list, &symbol_code_list);
-  printElapsedTime(cur_time, 1);
+  build_stats_.sample_compression_rate = code_assigner->getCompressionRate();
+  recorder.endPhase(kCodeAssign);
 
   bool ret = buildDict(symbol_code_list);
-  printElapsedTime(cur_time, 2);
+  recorder.endPhase(kDictBuild);
+  build_stats_.num_intervals = (int64_t)symbol_code_list.size();
+  build_stats_.setCodeLens(symbol_code_list);
 
   delete symbol_selector;
   delete code_assigner;
   return ret;
+#else
+  std::vector<uint16_t> run_start_list;
+  std::vector<int64_t> run_freq_list;
+  bool ret = reinterpret_cast<DoubleCharSS *>(symbol_selector)
+		 ->selectSymbolRuns(key_list, &run_start_list, &run_freq_list);
+  build_stats_.num_candidate_symbols = symbol_selector->numCandidates();
+  delete symbol_selector;
+  if (!ret) return false;
+  recorder.endPhase(kSymbolSelect);
+
+  // Hu-Tucker codes the runs rather than all 65536 symbols, which keeps
+  // its Garsia-Wachs pass short
+  std::vector<Code> run_code_list;
+  HuTuckerCA code_assigner;
+  code_assigner.assignCodes(run_freq_list, &run_code_list);
+  assignRunCodes(run_start_list, run_code_list);
+  recorder.endPhase(kCodeAssign);
+
+  buildDecodeDict();
+  recorder.endPhase(kDictBuild);
+  build_stats_.num_intervals = kNumDoubleChar;
+  build_stats_.setCodeLens(dict_, kNumDoubleChar);
+  return true;
+#endif
 }
 
 int DoubleCharEncoder::encode(const std::string &key, uint8_t *buffer) const {
@@ -292,12 +330,64 @@ int64_t DoubleCharEncoder::memoryUse() const {
 #endif
 }
 
+Code DoubleCharEncoder::lookupSymbol(const char *key_str, const int key_len, int &prefix_len) const {
+  unsigned s_idx = 256 * (uint8_t)key_str[0];
+  if (key_len > 1) s_idx += (uint8_t)key_str[1];
+  prefix_len = (key_len > 1) ? 2 : 1;
+  return dict_[s_idx];
+}
+
+bool DoubleCharEncoder::getSymbolCodes(std::vector<SymbolCode> *symbol_code_list) const {
+  for (int i = 0; i < kNumDoubleChar; i++) {
+    std::string symbol;
+    symbol += (char)(i / 256);
+    symbol += (char)(i % 256);
+    symbol_code_list->push_back(std::make_pair(symbol, dict_[i]));
+  }
+  return true;
+}
+
 bool DoubleCharEncoder::buildDict(const std::vector<SymbolCode> &symbol_code_list) {
   if (symbol_code_list.size() < kNumDoubleChar) return false;
   for (int i = 0; i < kNumDoubleChar; i++) {
     dict_[i] = symbol_code_list[i].second;
   }
+  buildDecodeDict();
+  return true;
+}
+
+void DoubleCharEncoder::assignRunCodes(const std::vector<uint16_t> &run_start_list,
+				       const std::vector<Code> &run_code_list) {
+  assert(run_start_list.size() == run_code_list.size());
+  for (int r = 0; r < (int)run_start_list.size(); r++) {
+    int start = run_start_list[r];
+    int end = (r + 1 < (int)run_start_list.size()) ? run_start_list[r + 1] : kNumDoubleChar;
+    int run_len = end - start;
+    Code run_code = run_code_list[r];
+    if (run_len == 1) {
+      dict_[start] = run_code;
+      continue;
+    }
+    // the first num_short symbols are one level higher in the tree
+    int depth = 0;
+    while ((1 << depth) < run_len) depth++;
+    int num_short = (1 << depth) - run_len;
+    assert(run_code.len + depth <= 32);
+    for (int i = 0; i < run_len; i++) {
+      Code code;
+      if (i < num_short) {
+        code.code = (run_code.code << (depth - 1)) | i;
+        code.len = run_code.len + depth - 1;
+      } else {
+        code.code = (run_code.code << depth) | (i + num_short);
+        code.len = run_code.len + depth;
+      }
+      dict_[start + i] = code;
+    }
+  }
+}
 
+void DoubleCharEncoder::buildDecodeDict() {
 #ifdef INCLUDE_DECODE
   std::vector<Code> codes;
   for (int i = 0; i < kNumDoubleChar; i++) {
@@ -307,8 +397,6 @@ bool DoubleCharEncoder::buildDict(const std::vector<SymbolCode> &symbol_code_lis
 #else
   decode_dict_ = nullptr;
 #endif
-
-  return true;
 }
 
 }  // namespace hope
@@ -12,7 +12,14 @@ namespace hope {
 
 class EncoderFactory {
  public:
-  static Encoder *createEncoder(const int type, int W = 10000) {
+  static Encoder *createEncoder(const int type, int W = 10000, const int num_threads = 0) {
+    Encoder *encoder = newEncoder(type, W);
+    encoder->setNumThreads(num_threads);
+    return encoder;
+  }
+
+ private:
+  static Encoder *newEncoder(const int type, int W) {
     if (type == 1)
       return new SingleCharEncoder();
     else if (type == 2)
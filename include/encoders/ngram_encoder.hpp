@@ -30,32 +30,44 @@ class NGramEncoder : public Encoder {
   int numEntries() const;
   int64_t memoryUse() const;
 
+  Code lookupSymbol(const char *key_str, const int key_len, int &prefix_len) const;
+  bool getSymbolCodes(std::vector<SymbolCode> *symbol_code_list) const;
+
  private:
   int n_;
   int code_len_; // -1 means variable length
   Dictionary *dict_;
+  // only with setKeepSymbols(true)
+  std::vector<SymbolCode> symbol_code_list_;
 };
 
 bool NGramEncoder::build(const std::vector<std::string> &key_list,
 			 const int64_t dict_size_limit) {
-  double cur_time = 0;
-  setStopWatch(cur_time, n_);
+  BuildStatsRecorder recorder(&build_stats_, (int64_t)key_list.size(), reset_peak_rss_);
 
   std::vector<SymbolFreq> symbol_freq_list;
+  ThreadPool pool(num_threads_);
   SymbolSelector *symbol_selector = SymbolSelectorFactory::createSymbolSelector(n_);
+  symbol_selector->setThreadPool(&pool);
   symbol_selector->selectSymbols(key_list, dict_size_limit, &symbol_freq_list);
+  build_stats_.num_candidate_symbols = symbol_selector->numCandidates();
   delete symbol_selector;
-  printElapsedTime(cur_time, 0);
+  recorder.endPhase(kSymbolSelect);
 
   std::vector<SymbolCode> symbol_code_list;
   CodeAssigner *code_assigner = CodeAssignerFactory::createCodeAssigner(kCaType);
   code_assigner->assignCodes(symbol_freq_list, &symbol_code_list);
+  build_stats_.sample_compression_rate = code_assigner->getCompressionRate();
   code_len_ = code_assigner->getCodeLen();
-  printElapsedTime(cur_time, 1);
+  recorder.endPhase(kCodeAssign);
 
   dict_ = DictionaryFactory::createDictionary(n_);
   bool ret_val = dict_->build(symbol_code_list);
-  printElapsedTime(cur_time, 2);
+  recorder.endPhase(kDictBuild);
+  build_stats_.num_intervals = (int64_t)symbol_code_list.size();
+  build_stats_.setCodeLens(symbol_code_list);
+  symbol_code_list_.clear();
+  if (keep_symbols_) symbol_code_list_.swap(symbol_code_list);
 
   delete code_assigner;
   return ret_val;
@@ -323,6 +335,16 @@ int NGramEncoder::numEntries() const { return dict_->numEntries(); }
 
 int64_t NGramEncoder::memoryUse() const { return dict_->memoryUse(); }
 
+Code NGramEncoder::lookupSymbol(const char *key_str, const int key_len, int &prefix_len) const {
+  return dict_->lookup(key_str, n_ + 1, prefix_len);
+}
+
+bool NGramEncoder::getSymbolCodes(std::vector<SymbolCode> *symbol_code_list) const {
+  if (symbol_code_list_.empty()) return false;
+  symbol_code_list->insert(symbol_code_list->end(), symbol_code_list_.begin(), symbol_code_list_.end());
+  return true;
+}
+
 }  // namespace hope
 
 #endif  // NGRAM_ENCODER_H
@@ -35,6 +35,9 @@ class SingleCharEncoder : public Encoder {
   int numEntries() const;
   int64_t memoryUse() const;
 
+  Code lookupSymbol(const char *key_str, const int key_len, int &prefix_len) const;
+  bool getSymbolCodes(std::vector<SymbolCode> *symbol_code_list) const;
+
  private:
   bool buildDict(const std::vector<SymbolCode> &symbol_code_list);
 
@@ -44,21 +47,26 @@ class SingleCharEncoder : public Encoder {
 
 bool SingleCharEncoder::build(const std::vector<std::string> &key_list,
 			      const int64_t dict_size_limit) {
-  double cur_time = 0;
-  setStopWatch(cur_time, 1);
+  BuildStatsRecorder recorder(&build_stats_, (int64_t)key_list.size(), reset_peak_rss_);
   
   std::vector<SymbolFreq> symbol_freq_list;
+  ThreadPool pool(num_threads_);
   SymbolSelector *symbol_selector = SymbolSelectorFactory::createSymbolSelector(1);
+  symbol_selector->setThreadPool(&pool);
   symbol_selector->selectSymbols(key_list, dict_size_limit, &symbol_freq_list);
-  printElapsedTime(cur_time, 0);
+  build_stats_.num_candidate_symbols = symbol_selector->numCandidates();
+  recorder.endPhase(kSymbolSelect);
   
   std::vector<SymbolCode> symbol_code_list;
   CodeAssigner *code_assigner = CodeAssignerFactory::createCodeAssigner(kCaType);
   code_assigner->assignCodes(symbol_freq_list, &symbol_code_list);
-  printElapsedTime(cur_time, 1);
+  build_stats_.sample_compression_rate = code_assigner->getCompressionRate();
+  recorder.endPhase(kCodeAssign);
   
   bool ret_val = buildDict(symbol_code_list);
-  printElapsedTime(cur_time, 2);
+  recorder.endPhase(kDictBuild);
+  build_stats_.num_intervals = (int64_t)symbol_code_list.size();
+  build_stats_.setCodeLens(symbol_code_list);
 
   delete symbol_selector;
   delete code_assigner;
@@ -271,6 +279,18 @@ int64_t SingleCharEncoder::memoryUse() const {
 #endif
 }
 
+Code SingleCharEncoder::lookupSymbol(const char *key_str, const int key_len, int &prefix_len) const {
+  prefix_len = 1;
+  return dict_[(uint8_t)key_str[0]];
+}
+
+bool SingleCharEncoder::getSymbolCodes(std::vector<SymbolCode> *symbol_code_list) const {
+  for (int i = 0; i < kNumSingleChar; i++) {
+    symbol_code_list->push_back(std::make_pair(std::string(1, (char)i), dict_[i]));
+  }
+  return true;
+}
+
 bool SingleCharEncoder::buildDict(const std::vector<SymbolCode> &symbol_code_list) {
   if (symbol_code_list.size() < kNumSingleChar) return false;
   for (int i = 0; i < kNumSingleChar; i++) {
@@ -0,0 +1,88 @@
+#ifndef KEY_SAMPLER_H
+#define KEY_SAMPLER_H
+
+#include <istream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace hope {
+
+// Keeps a uniform random sample of at most sample_size_limit keys
+// out of a stream of unknown length (reservoir sampling, Algorithm R).
+// Memory is bounded by the sample, not by the input, so an encoder
+// can be trained in one pass over a key file or while the same scan
+// bulk-loads an index.
+class KeySampler {
+ public:
+  KeySampler(const int64_t sample_size_limit, const uint64_t seed = 0)
+      : sample_size_limit_(sample_size_limit), num_keys_(0), total_key_len_(0), rand_(seed){};
+  ~KeySampler(){};
+
+  void addKey(const std::string &key);
+
+  template <typename InputIt>
+  void addKeys(InputIt first, InputIt last);
+
+  // Reads one key per line until the end of the stream; empty lines are skipped
+  // Returns the number of keys read
+  int64_t addKeys(std::istream &in);
+
+  const std::vector<std::string> &getSample() const { return sample_; }
+
+  // Number of keys in the stream so far
+  int64_t numKeys() const { return num_keys_; }
+
+  // Total length in bytes of the keys in the stream so far
+  int64_t totalKeyLen() const { return total_key_len_; }
+
+  void clear();
+
+ private:
+  int64_t sample_size_limit_;
+  int64_t num_keys_;
+  int64_t total_key_len_;
+  std::mt19937_64 rand_;
+  std::vector<std::string> sample_;
+};
+
+void KeySampler::addKey(const std::string &key) {
+  num_keys_++;
+  total_key_len_ += (int64_t)key.length();
+  if ((int64_t)sample_.size() < sample_size_limit_) {
+    sample_.push_back(key);
+    return;
+  }
+  std::uniform_int_distribution<int64_t> dis(0, num_keys_ - 1);
+  int64_t idx = dis(rand_);
+  // assign instead of push so that the slot's buffer gets reused
+  if (idx < sample_size_limit_) sample_[idx].assign(key);
+}
+
+template <typename InputIt>
+void KeySampler::addKeys(InputIt first, InputIt last) {
+  for (; first != last; ++first) {
+    addKey(*first);
+  }
+}
+
+int64_t KeySampler::addKeys(std::istream &in) {
+  int64_t count = 0;
+  std::string key;
+  while (std::getline(in, key)) {
+    if (key.empty()) continue;
+    addKey(key);
+    count++;
+  }
+  return count;
+}
+
+void KeySampler::clear() {
+  num_keys_ = 0;
+  total_key_len_ = 0;
+  sample_.clear();
+}
+
+}  // namespace hope
+
+#endif  // KEY_SAMPLER_H
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "common.hpp"
+#include "thread_pool.hpp"
 
 namespace hope {
 
@@ -19,6 +20,17 @@ class SymbolSelector {
   virtual bool selectSymbols(const std::vector<std::string> &key_list,
 			     const int64_t num_limit,
                              std::vector<SymbolFreq> *symbol_freq_list) = 0;
+
+  // Runs the internal work of selectSymbols on the pool;
+  // nullptr means single-threaded
+  void setThreadPool(ThreadPool *pool) { pool_ = pool; }
+
+  // Distinct symbols seen in the sample by the last selectSymbols
+  int64_t numCandidates() const { return num_candidates_; }
+
+ protected:
+  ThreadPool *pool_ = nullptr;
+  int64_t num_candidates_ = 0;
 };
 
 }  // namespace hope
@@ -9,6 +9,7 @@
 #include <map>
 #include <unordered_map>
 #include "blending_trie.hpp"
+#include "interval_freq_counter.hpp"
 #include "symbol_selector.hpp"
 
 typedef struct SymbolFreqValid {
@@ -50,10 +51,6 @@ class ALMImprovedSS : public SymbolSelector {
 
   std::string getNextString(const std::string &str);
 
-  void getEncodeFrequency(const std::string &str, std::vector<int> &cnt);
-
-  int BinarySearch(const std::string &str, unsigned int pos, int &prefix_len);
-
   int64_t W;
 
   const int kMaxIntervalStringLen = 50;
@@ -70,10 +67,11 @@ bool ALMImprovedSS::selectSymbols(const std::vector<std::string> &key_list, cons
   if (key_list.empty()) return false;
   // Build Trie
   BlendTrie *tree = new BlendTrie(1);
-  tree->build(key_list);
+  tree->build(key_list, pool_);
   std::vector<SymbolFreq> blend_freq_table;
   // Blending
-  tree->blendingAndGetLeaves(&blend_freq_table);
+  tree->blendingAndGetLeaves(&blend_freq_table, pool_);
+  num_candidates_ = (int64_t)blend_freq_table.size();
   delete tree;
   // Search for best W
   int64_t l = 0;
@@ -106,70 +104,23 @@ bool ALMImprovedSS::selectSymbols(const std::vector<std::string> &key_list, cons
   return true;
 }
 
-int ALMImprovedSS::BinarySearch(const std::string &str, unsigned int pos, int &prefix_len) {
-  int l = 0;
-  int r = static_cast<int>(intervals_.size()) - 1;
-  assert(pos <= str.size());
-  std::string compare_str = str.substr(pos, str.size() - pos);
-  while (l <= r) {
-    int mid = (l + r) / 2;
-    std::string mid_left_bound = intervals_[mid].first;
-    int cmp = mid_left_bound.compare(compare_str);
-    if (cmp < 0) {
-      l = mid + 1;
-    } else if (cmp > 0) {
-      r = mid - 1;
-    } else {
-      r = mid;
-      break;
-    }
-  }
-  assert(r < (int)intervals_.size());
-  prefix_len = static_cast<int>(commonPrefix(intervals_[r].first, getPrevString(intervals_[r].second)).length());
-  return r;
-}
-
-void ALMImprovedSS::getEncodeFrequency(const std::string &cur_str, std::vector<int> &cnt) {
-  unsigned int pos = 0;
-  int prefix_len = 0;
-  int interval_idx;
-  while (pos < cur_str.length()) {
-    interval_idx = BinarySearch(cur_str, pos, prefix_len);
-    cnt[interval_idx]++;
-    assert(prefix_len > 0);
-    pos += prefix_len;
-  }
-}
-
 void ALMImprovedSS::getIntervalFreqEntropy(std::vector<SymbolFreq> *symbol_freq_list,
                                            const std::vector<std::string> &key_list) {
-  std::vector<int> cnt(intervals_.size(), 0);
-  for (const auto &iter : key_list) {
-    getEncodeFrequency(iter, cnt);
+  std::vector<std::string> interval_boundaries;
+  for (const auto &interval : intervals_) {
+    interval_boundaries.push_back(interval.first);
   }
-#ifdef CAl_ENTROPY
-  std::vector<double> freq_len;
-  double sum_fl = 0;
-#endif
+  std::vector<int64_t> cnt(intervals_.size(), 0);
+  IntervalFreqCounter freq_counter(5, 0);
+  freq_counter.build(interval_boundaries);
+  freq_counter.countIntervalFreq(key_list, &cnt, pool_);
+
   for (int i = 0; i < (int)intervals_.size(); i++) {
-    std::string interval_start = intervals_[i].first;
-    std::string interval_end = intervals_[i].second;
-    std::string common_prefix = commonPrefix(interval_start, getPrevString(interval_end));
-#ifdef CAL_ENTROPY
-    freq_len.push_back(common_prefix.length() * (cnt[i] + 1));
-    sum_fl += common_prefix.length() * (cnt[i] + 1);
-#endif
+    const std::string &interval_start = intervals_[i].first;
     // plus one for each interval to avoid 0 frequency
     // Pass Frequencty to Hu-Tucker
     symbol_freq_list->push_back(std::make_pair(interval_start, cnt[i] + 1));
   }
-#ifdef CAL_ENTROPY
-  double entropy = 0;
-  for (int i = 0; i < (int)freq_len.size(); i++) {
-    double p = freq_len[i] / sum_fl;
-    entropy += p * log2(p);
-  }
-#endif
 }
 
 void ALMImprovedSS::fillGap(std::string start_include, std::string end_exclude) {
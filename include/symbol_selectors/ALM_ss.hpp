@@ -9,6 +9,7 @@
 #include <map>
 #include <unordered_map>
 #include "blending_trie.hpp"
+#include "interval_freq_counter.hpp"
 #include "symbol_selector.hpp"
 
 namespace hope {
@@ -42,10 +43,6 @@ class ALMSS : public SymbolSelector {
 
   std::string getNextString(const std::string &str);
 
-  void encode(const std::string &str, std::vector<int> &cnt);
-
-  int binarySearch(const std::string &str, unsigned int pos, int &prefix_len);
-
   int64_t W;
 
   std::vector<std::pair<std::string, std::string>> intervals_;
@@ -66,9 +63,10 @@ bool ALMSS::selectSymbols(const std::vector<std::string> &key_list, const int64_
   std::vector<SymbolFreq> blend_freq_table;
   // Build Trie
   BlendTrie *tree = new BlendTrie(0);
-  tree->build(key_list);
+  tree->build(key_list, pool_);
   // Blending
-  tree->blendingAndGetLeaves(&blend_freq_table);
+  tree->blendingAndGetLeaves(&blend_freq_table, pool_);
+  num_candidates_ = (int64_t)blend_freq_table.size();
   delete tree;
 
   // Search for best W
@@ -101,72 +99,23 @@ bool ALMSS::selectSymbols(const std::vector<std::string> &key_list, const int64_
   return true;
 }
 
-int ALMSS::binarySearch(const std::string &str, unsigned int pos, int &prefix_len) {
-  int l = 0;
-  int r = static_cast<int>(intervals_.size()) - 1;
-  assert(pos <= str.size());
-  std::string compare_str = str.substr(pos, str.size() - pos);
-  while (l <= r) {
-    int mid = (l + r) / 2;
-    std::string mid_left_bound = intervals_[mid].first;
-    int cmp = mid_left_bound.compare(compare_str);
-    if (cmp < 0) {
-      l = mid + 1;
-    } else if (cmp > 0) {
-      r = mid - 1;
-    } else {
-      r = mid;
-      break;
-    }
-  }
-  assert(r < (int)intervals_.size());
-  prefix_len = static_cast<int>(commonPrefix(intervals_[r].first, getPrevString(intervals_[r].second)).size());
-  return r;
-}
-
-void ALMSS::encode(const std::string &str, std::vector<int> &cnt) {
-  unsigned int pos = 0;
-  int prefix_len = 0;
-  int interval_idx;
-  while (pos < str.size()) {
-    interval_idx = binarySearch(str, pos, prefix_len);
-    cnt[interval_idx]++;
-    assert(prefix_len > 0);
-    pos += prefix_len;
-  }
-}
-
 void ALMSS::getIntervalFreqByEntropy(std::vector<SymbolFreq> *symbol_freq_list,
                                            const std::vector<std::string> &key_list) {
-  std::vector<int> cnt(intervals_.size(), 0);
-  for (const auto &iter : key_list) {
-    encode(iter, cnt);
+  std::vector<std::string> interval_boundaries;
+  for (const auto &interval : intervals_) {
+    interval_boundaries.push_back(interval.first);
   }
+  std::vector<int64_t> cnt(intervals_.size(), 0);
+  IntervalFreqCounter freq_counter(5, 0);
+  freq_counter.build(interval_boundaries);
+  freq_counter.countIntervalFreq(key_list, &cnt, pool_);
 
-#ifdef CAL_ENTROPY
-  std::vector<double> freq_len;
-  double sum_fl = 0;
-#endif
   for (int i = 0; i < (int)intervals_.size(); i++) {
-    std::string interval_start = intervals_[i].first;
-    std::string interval_end = intervals_[i].second;
-    std::string common_prefix = commonPrefix(interval_start, getPrevString(interval_end));
-#ifdef CAL_ENTROPY
-    freq_len.push_back(common_prefix.length() * (cnt[i] + 1));
-    sum_fl += common_prefix.length() * (cnt[i] + 1);
-#endif
+    const std::string &interval_start = intervals_[i].first;
     // plus one for each interval to avoid 0 frequency
     // Pass Frequencty to Hu-Tucker
     symbol_freq_list->push_back(std::make_pair(interval_start, cnt[i] + 1));
   }
-#ifdef CAL_ENTROPY
-  double entropy = 0;
-  for (int i = 0; i < (int)freq_len.size(); i++) {
-    double p = freq_len[i] / sum_fl;
-    entropy += p * log2(p);
-  }
-  std::cout << "Entropy = " << -entropy << std::endl;
-#endif
 }
 
 void ALMSS::fillGap(std::string start_include, std::string end_exclude) {
@@ -1,6 +1,9 @@
 #ifndef BLENDING_TRI_H
 #define BLENDING_TRI_H
 
+#include <assert.h>
+
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <list>
@@ -11,6 +14,7 @@
 #include <vector>
 
 #include "common.hpp"
+#include "thread_pool.hpp"
 
 namespace hope {
 
@@ -36,7 +40,7 @@ class TrieNode {
 
   bool hasChildren() { return !children.empty(); }
 
-  std::map<char, TrieNode *> getChildren() { return children; }
+  const std::map<char, TrieNode *> &getChildren() { return children; }
 
  private:
   int64_t freq_;
@@ -50,17 +54,24 @@ class BlendTrie {
 
   ~BlendTrie();
 
-  void build(std::vector<std::string> key_list);
+  // pool = nullptr means building on the calling thread only
+  void build(const std::vector<std::string> &key_list, ThreadPool *pool = nullptr);
 
   void insert(const std::string &key, int64_t freq);
 
   void clear(TrieNode *node);
 
-  void blendingAndGetLeaves(std::vector<SymbolFreq> *freq_vec);
+  void blendingAndGetLeaves(std::vector<SymbolFreq> *freq_vec, ThreadPool *pool = nullptr);
 
   void vis(const std::string &filename);
 
  private:
+  // Adds freq to the node of key[0, len) under node; with all_prefixes,
+  // also to the nodes of every shorter prefix of it
+  void insert(TrieNode *node, const char *key, int len, int64_t freq, bool all_prefixes);
+
+  void blendSubtree(TrieNode *node, std::vector<SymbolFreq> *freq_vec);
+
   TrieNode *root_;
   int blend_type_;
 };
@@ -83,35 +94,49 @@ BlendTrie::~BlendTrie() {
  *      Only calculate partial suffixes
  *      For example, the key 'abc' will count abc,bc,c
  * In order to reduce calculation, we truncate strings longer than maxkey_len(50)
+ *
+ * Substrings starting with different bytes never share a node below the
+ * root, so the 256 subtries of the root are built independently.
  */
-void BlendTrie::build(std::vector<std::string> key_list) {
+void BlendTrie::build(const std::vector<std::string> &key_list, ThreadPool *pool) {
   root_ = new TrieNode();
   int maxkey_len = 50;
-  if (blend_type_ == 0) {
-    for (int i = 0; i < static_cast<int>(key_list.size()); i++) {
-      std::string key = key_list[i].substr(0, maxkey_len);
-      for (int j = 0; j < static_cast<int>(key.length()); j++) {
-        for (int k = 1; k <= static_cast<int>(key.length()) - j; k++) {
-          std::string substring = key.substr(j, k);
-          insert(substring, 1);
-        }
-      }
+  // group the (key id, start pos) of every substring by its first byte
+  std::vector<std::vector<std::pair<int64_t, int> > > starts(256);
+  for (int64_t i = 0; i < static_cast<int64_t>(key_list.size()); i++) {
+    int key_len = std::min(static_cast<int>(key_list[i].length()), maxkey_len);
+    for (int j = 0; j < key_len; j++) {
+      starts[(uint8_t)key_list[i][j]].push_back(std::make_pair(i, j));
     }
-  } else if (blend_type_ == 1) {
-    for (int i = 0; i < static_cast<int>(key_list.size()); i++) {
-      std::string key = key_list[i].substr(0, maxkey_len);
-      int str_len = key.length();
-      for (int j = 0; j < str_len; j++) {
-        std::string substring = key.substr(j, str_len - j);
-        insert(substring, 1);
-      }
+  }
+  std::vector<TrieNode *> subtries(256, nullptr);
+  auto build_subtrie = [&](int c) {
+    if (starts[c].empty()) return;
+    subtries[c] = new TrieNode();
+    for (const auto &start : starts[c]) {
+      const std::string &key = key_list[start.first];
+      int key_len = std::min(static_cast<int>(key.length()), maxkey_len);
+      insert(subtries[c], key.data() + start.second + 1, key_len - start.second - 1, 1,
+             blend_type_ == 0);
     }
+  };
+  if (pool == nullptr) {
+    for (int c = 0; c < 256; c++) build_subtrie(c);
+  } else {
+    pool->run(256, build_subtrie);
+  }
+  for (int c = 0; c < 256; c++) {
+    if (subtries[c] != nullptr) root_->addChild((char)c, subtries[c]);
   }
 }
 
 void BlendTrie::insert(const std::string &key, int64_t freq) {
-  TrieNode *node = root_;
-  for (int i = 0; i < static_cast<int>(key.length()); i++) {
+  insert(root_, key.data(), static_cast<int>(key.length()), freq, false);
+}
+
+void BlendTrie::insert(TrieNode *node, const char *key, int len, int64_t freq, bool all_prefixes) {
+  if (all_prefixes) node->setFreq(freq + node->getFreq());
+  for (int i = 0; i < len; i++) {
     std::map<char, TrieNode *>::iterator child = node->getChild(key[i]);
     if (child != node->getEnd()) {
       node = child->second;
@@ -120,13 +145,39 @@ void BlendTrie::insert(const std::string &key, int64_t freq) {
       node->addChild(key[i], new_node);
       node = new_node;
     }
+    if (all_prefixes) node->setFreq(freq + node->getFreq());
+  }
+  if (!all_prefixes) node->setFreq(freq + node->getFreq());
+}
+
+void BlendTrie::blendingAndGetLeaves(std::vector<SymbolFreq> *freq_vec, ThreadPool *pool) {
+  if (!root_->hasChildren()) {
+    freq_vec->push_back(std::make_pair(root_->getPrefix(), root_->getFreq()));
+    return;
+  }
+  // The root is never a substring itself (freq 0), so every subtrie
+  // blends on its own
+  std::vector<TrieNode *> subtries;
+  for (auto iter = root_->getBegin(); iter != root_->getEnd(); iter++) {
+    iter->second->setPrefix(std::string(1, iter->first));
+    subtries.push_back(iter->second);
+  }
+  assert(root_->getFreq() == 0);
+  std::vector<std::vector<SymbolFreq> > subtrie_leaves(subtries.size());
+  auto blend_subtrie = [&](int i) { blendSubtree(subtries[i], &subtrie_leaves[i]); };
+  if (pool == nullptr) {
+    for (int i = 0; i < (int)subtries.size(); i++) blend_subtrie(i);
+  } else {
+    pool->run((int)subtries.size(), blend_subtrie);
+  }
+  for (int i = 0; i < (int)subtries.size(); i++) {
+    freq_vec->insert(freq_vec->end(), subtrie_leaves[i].begin(), subtrie_leaves[i].end());
   }
-  node->setFreq(freq + node->getFreq());
 }
 
-void BlendTrie::blendingAndGetLeaves(std::vector<SymbolFreq> *freq_vec) {
+void BlendTrie::blendSubtree(TrieNode *node, std::vector<SymbolFreq> *freq_vec) {
   std::list<TrieNode *> l;
-  l.push_back(root_);
+  l.push_back(node);
   while (!l.empty()) {
     TrieNode *top_node = l.front();
     l.pop_front();
@@ -150,12 +201,12 @@ void BlendTrie::blendingAndGetLeaves(std::vector<SymbolFreq> *freq_vec) {
 }
 
 void BlendTrie::clear(hope::TrieNode *node) {
+  if (node == nullptr) return;
   if (!node->hasChildren()) {
     delete node;
     return;
   }
-  std::map<char, TrieNode *> children = node->getChildren();
-  for (auto iter = children.begin(); iter != children.end(); iter++) {
+  for (auto iter = node->getBegin(); iter != node->getEnd(); iter++) {
     clear(iter->second);
   }
   delete node;
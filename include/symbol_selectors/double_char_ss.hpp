@@ -14,8 +14,22 @@ class DoubleCharSS : public SymbolSelector {
 		     const int64_t num_limit,
                      std::vector<SymbolFreq> *symbol_freq_list);
 
+  // Same frequencies as selectSymbols, with the symbols packed as
+  // (first byte << 8 | second byte). Consecutive symbols that never
+  // appear in the sample are grouped into one run (within the same
+  // first byte), so that code assignment only has to order the
+  // observed symbols and the gaps between them.
+  // run_start_list: first symbol of every run, in ascending order
+  // run_freq_list: total frequency of every run
+  bool selectSymbolRuns(const std::vector<std::string> &key_list,
+			std::vector<uint16_t> *run_start_list,
+			std::vector<int64_t> *run_freq_list);
+
  private:
   void countSymbolFreq(const std::vector<std::string> &key_list);
+  void countShardFreq(const std::vector<std::string> &key_list,
+		      const int64_t start_id, const int64_t end_id,
+		      int64_t *freq_list) const;
 
   int64_t freq_list_[kNumDoubleChar];
 };
@@ -31,7 +45,10 @@ bool DoubleCharSS::selectSymbols(const std::vector<std::string> &key_list,
                                  std::vector<SymbolFreq> *symbol_freq_list) {
   if (key_list.empty()) return false;
   countSymbolFreq(key_list);
+  num_candidates_ = 0;
   for (int i = 0; i < kNumDoubleChar; i++) {
+    // every symbol starts at frequency 1
+    num_candidates_ += (freq_list_[i] > 1);
     std::string symbol;
     symbol += (char)(i / 256);
     symbol += (char)(i % 256);
@@ -40,13 +57,55 @@ bool DoubleCharSS::selectSymbols(const std::vector<std::string> &key_list,
   return true;
 }
 
+bool DoubleCharSS::selectSymbolRuns(const std::vector<std::string> &key_list,
+				    std::vector<uint16_t> *run_start_list,
+				    std::vector<int64_t> *run_freq_list) {
+  if (key_list.empty()) return false;
+  countSymbolFreq(key_list);
+  num_candidates_ = 0;
+  for (int i = 0; i < kNumDoubleChar; i++) {
+    // every symbol starts at frequency 1
+    bool unseen = (freq_list_[i] == 1);
+    num_candidates_ += !unseen;
+    bool extends_run = unseen && (i % 256 != 0) && (freq_list_[i - 1] == 1);
+    if (extends_run) {
+      run_freq_list->back()++;
+    } else {
+      run_start_list->push_back((uint16_t)i);
+      run_freq_list->push_back(freq_list_[i]);
+    }
+  }
+  return true;
+}
+
 void DoubleCharSS::countSymbolFreq(const std::vector<std::string> &key_list) {
-  for (int i = 0; i < (int)key_list.size(); i++) {
+  if (pool_ == nullptr) {
+    countShardFreq(key_list, 0, (int64_t)key_list.size(), freq_list_);
+    return;
+  }
+  std::vector<std::vector<int64_t> > shard_freq_lists(pool_->numThreads());
+  int num_shards = pool_->runShards((int64_t)key_list.size(), ThreadPool::kMinKeysPerShard,
+				    [&](int shard_id, int64_t start_id, int64_t end_id) {
+    shard_freq_lists[shard_id].assign(kNumDoubleChar, 0);
+    countShardFreq(key_list, start_id, end_id, shard_freq_lists[shard_id].data());
+  });
+  for (int s = 0; s < num_shards; s++) {
+    if (shard_freq_lists[s].empty()) continue;
+    for (int i = 0; i < kNumDoubleChar; i++) {
+      freq_list_[i] += shard_freq_lists[s][i];
+    }
+  }
+}
+
+void DoubleCharSS::countShardFreq(const std::vector<std::string> &key_list,
+				  const int64_t start_id, const int64_t end_id,
+				  int64_t *freq_list) const {
+  for (int64_t i = start_id; i < end_id; i++) {
     int key_len = (int)key_list[i].length();
     for (int j = 0; j < key_len; j++) {
       unsigned idx = 256 * (uint8_t)key_list[i][j];
       if (j + 1 < key_len) idx += (uint8_t)key_list[i][j + 1];
-      freq_list_[idx]++;
+      freq_list[idx]++;
     }
   }
 }
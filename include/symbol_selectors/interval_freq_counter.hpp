@@ -0,0 +1,119 @@
+#ifndef INTERVAL_FREQ_COUNTER_H
+#define INTERVAL_FREQ_COUNTER_H
+
+#include <string.h>
+
+#include "dictionary_factory.hpp"
+#include "thread_pool.hpp"
+
+namespace hope {
+
+// Runs a test encoding of the sampled keys to count how often each
+// interval is accessed. The interval boundaries are loaded into a
+// temporary read-only dictionary of the same type as the final one,
+// with the interval id stored as its code, so that the prefix length
+// of every interval is computed once at build time and each lookup
+// is allocation-free. The sampled keys are split into shards that
+// are encoded in parallel on the build's thread pool.
+class IntervalFreqCounter {
+ public:
+  static const int kMaxLookupLen = 8;
+
+  // dict_type: the DictionaryFactory type of the final dictionary
+  // lookup_len: number of bytes passed to each lookup (n + 1 for the
+  // n-gram dictionaries); 0 means the rest of the key (ALM dictionary)
+  IntervalFreqCounter(const int dict_type, const int lookup_len);
+  ~IntervalFreqCounter() { delete dict_; };
+
+  // interval_boundaries: sorted left boundaries of the intervals
+  bool build(const std::vector<std::string> &interval_boundaries);
+
+  // Adds the access count of every interval to freq_list.
+  // pool = nullptr means counting on the calling thread only
+  void countIntervalFreq(const std::vector<std::string> &key_list,
+			 std::vector<int64_t> *freq_list,
+			 ThreadPool *pool = nullptr) const;
+
+ private:
+  void countShardFreq(const std::vector<std::string> &key_list,
+		      const int64_t start_id, const int64_t end_id,
+		      std::vector<int64_t> *freq_list) const;
+
+  int dict_type_;
+  int lookup_len_;
+  Dictionary *dict_;
+  // The ALM dictionary keeps pointers into this list
+  std::vector<SymbolCode> symbol_code_list_;
+};
+
+IntervalFreqCounter::IntervalFreqCounter(const int dict_type, const int lookup_len)
+    : dict_type_(dict_type), lookup_len_(lookup_len), dict_(nullptr) {
+  assert(lookup_len_ <= kMaxLookupLen);
+}
+
+bool IntervalFreqCounter::build(const std::vector<std::string> &interval_boundaries) {
+  symbol_code_list_.clear();
+  for (int i = 0; i < (int)interval_boundaries.size(); i++) {
+    Code code = {i, 0};
+    symbol_code_list_.push_back(std::make_pair(interval_boundaries[i], code));
+  }
+  delete dict_;
+  dict_ = DictionaryFactory::createDictionary(dict_type_);
+  if (dict_ == nullptr) return false;
+  return dict_->build(symbol_code_list_);
+}
+
+void IntervalFreqCounter::countIntervalFreq(const std::vector<std::string> &key_list,
+					    std::vector<int64_t> *freq_list,
+					    ThreadPool *pool) const {
+  int64_t num_keys = (int64_t)key_list.size();
+  if (pool == nullptr) {
+    countShardFreq(key_list, 0, num_keys, freq_list);
+    return;
+  }
+  std::vector<std::vector<int64_t> > shard_freq_lists(pool->numThreads());
+  int num_shards = pool->runShards(num_keys, ThreadPool::kMinKeysPerShard,
+				   [&](int shard_id, int64_t start_id, int64_t end_id) {
+    shard_freq_lists[shard_id].assign(freq_list->size(), 0);
+    countShardFreq(key_list, start_id, end_id, &shard_freq_lists[shard_id]);
+  });
+  for (int s = 0; s < num_shards; s++) {
+    if (shard_freq_lists[s].empty()) continue;
+    for (int i = 0; i < (int)freq_list->size(); i++) {
+      (*freq_list)[i] += shard_freq_lists[s][i];
+    }
+  }
+}
+
+void IntervalFreqCounter::countShardFreq(const std::vector<std::string> &key_list,
+					 const int64_t start_id, const int64_t end_id,
+					 std::vector<int64_t> *freq_list) const {
+  // Fixed-length lookups may read past the end of the key;
+  // the tail is zero-padded as in the encoder
+  char tail[kMaxLookupLen];
+  for (int64_t i = start_id; i < end_id; i++) {
+    const char *key_str = key_list[i].c_str();
+    int key_len = (int)key_list[i].length();
+    int pos = 0;
+    while (pos < key_len) {
+      int prefix_len = 0;
+      Code code;
+      if (lookup_len_ == 0) {
+        code = dict_->lookup(key_str + pos, key_len - pos, prefix_len);
+      } else if (pos + lookup_len_ <= key_len) {
+        code = dict_->lookup(key_str + pos, lookup_len_, prefix_len);
+      } else {
+        memset(tail, 0, kMaxLookupLen);
+        memcpy(tail, key_str + pos, key_len - pos);
+        code = dict_->lookup(tail, lookup_len_, prefix_len);
+      }
+      (*freq_list)[code.code]++;
+      assert(prefix_len > 0);
+      pos += prefix_len;
+    }
+  }
+}
+
+}  // namespace hope
+
+#endif  // INTERVAL_FREQ_COUNTER_H
@@ -2,14 +2,15 @@
 #define NGRAM_SS_H
 
 #include <algorithm>
-#include <map>
+#include <unordered_map>
+#include "interval_freq_counter.hpp"
 #include "symbol_selector.hpp"
 
 namespace hope {
 
 class NGramSS : public SymbolSelector {
  public:
-  NGramSS(int n) : n_(n){};
+  NGramSS(int n) : n_(n) { assert(n_ <= 4); };
   ~NGramSS() { freq_map_.clear(); };
 
   bool selectSymbols(const std::vector<std::string> &key_list,
@@ -19,6 +20,9 @@ class NGramSS : public SymbolSelector {
  private:
   // count the frequency of every ngram appeared in the sampled keys
   void countSymbolFreq(const std::vector<std::string> &key_list);
+  void countShardFreq(const std::vector<std::string> &key_list,
+		      const int64_t start_id, const int64_t end_id,
+		      std::unordered_map<uint32_t, int64_t> *freq_map) const;
   void pickMostFreqSymbols(const int64_t num_limit,
 			   std::vector<std::string> *most_freq_symbols);
 
@@ -33,10 +37,10 @@ class NGramSS : public SymbolSelector {
   // being accessed. This information is useful later for assigning
   // optimal prefix codes to the intervals.
   void countIntervalFreq(const std::vector<std::string> &key_list);
-  int binarySearch(const std::string &key) const;
 
   int n_;
-  std::map<std::string, int64_t> freq_map_;
+  // ngrams are packed big-endian so that they compare as strings
+  std::unordered_map<uint32_t, int64_t> freq_map_;
   std::vector<std::string> interval_prefixes_;
   std::vector<std::string> interval_boundaries_; // left boundaries
   std::vector<int64_t> interval_freqs_;
@@ -47,6 +51,7 @@ bool NGramSS::selectSymbols(const std::vector<std::string> &key_list,
                             std::vector<SymbolFreq> *symbol_freq_list) {
   if (key_list.empty()) return false;
   countSymbolFreq(key_list);
+  num_candidates_ = (int64_t)freq_map_.size();
   std::vector<std::string> most_freq_symbols;
   int64_t adjust_num_limit = num_limit;
   if (num_limit > (int64_t)freq_map_.size() * 2) {
@@ -68,35 +73,55 @@ bool NGramSS::selectSymbols(const std::vector<std::string> &key_list,
 
 void NGramSS::countSymbolFreq(const std::vector<std::string> &key_list) {
   freq_map_.clear();
-  // std::unordered_map<std::string, int64_t>::iterator iter;
-  std::map<std::string, int64_t>::iterator iter;
-  for (int i = 0; i < (int)key_list.size(); i++) {
-    for (int j = 0; j < (int)key_list[i].length() - n_ + 1; j++) {
-      std::string ngram = key_list[i].substr(j, n_);
-      iter = freq_map_.find(ngram);
-      if (iter == freq_map_.end()) {
-        freq_map_.insert(std::pair<std::string, int64_t>(ngram, 1));
-      } else {
-        iter->second += 1;
+  if (pool_ == nullptr) {
+    countShardFreq(key_list, 0, (int64_t)key_list.size(), &freq_map_);
+    return;
+  }
+  std::vector<std::unordered_map<uint32_t, int64_t> > shard_freq_maps(pool_->numThreads());
+  int num_shards = pool_->runShards((int64_t)key_list.size(), ThreadPool::kMinKeysPerShard,
+				    [&](int shard_id, int64_t start_id, int64_t end_id) {
+    countShardFreq(key_list, start_id, end_id, &shard_freq_maps[shard_id]);
+  });
+  for (int s = 0; s < num_shards; s++) {
+    for (auto iter = shard_freq_maps[s].begin(); iter != shard_freq_maps[s].end(); ++iter) {
+      freq_map_[iter->first] += iter->second;
+    }
+  }
+}
+
+void NGramSS::countShardFreq(const std::vector<std::string> &key_list,
+			     const int64_t start_id, const int64_t end_id,
+			     std::unordered_map<uint32_t, int64_t> *freq_map) const {
+  for (int64_t i = start_id; i < end_id; i++) {
+    const std::string &key = key_list[i];
+    for (int j = 0; j < (int)key.length() - n_ + 1; j++) {
+      uint32_t ngram = 0;
+      for (int k = 0; k < n_; k++) {
+        ngram = (ngram << 8) | (uint8_t)key[j + k];
       }
+      (*freq_map)[ngram]++;
     }
   }
 }
 
 void NGramSS::pickMostFreqSymbols(const int64_t num_limit,
 				  std::vector<std::string> *most_freq_symbols) {
-  std::vector<SymbolFreq> symbol_freqs;
-  std::map<std::string, int64_t>::iterator iter;
-  for (iter = freq_map_.begin(); iter != freq_map_.end(); ++iter) {
-    symbol_freqs.push_back(std::make_pair(iter->first, iter->second));
-  }
-  std::sort(symbol_freqs.begin(), symbol_freqs.end(),
-	    [](const SymbolFreq &x, const SymbolFreq &y) {
+  std::vector<std::pair<uint32_t, int64_t> > symbol_freqs(freq_map_.begin(), freq_map_.end());
+  int64_t num_picked = std::min(num_limit, (int64_t)symbol_freqs.size());
+  // only the top num_picked ngrams need to be ordered
+  std::partial_sort(symbol_freqs.begin(), symbol_freqs.begin() + num_picked,
+		    symbol_freqs.end(),
+		    [](const std::pair<uint32_t, int64_t> &x,
+		       const std::pair<uint32_t, int64_t> &y) {
     if (x.second != y.second) return x.second > y.second;
-    return (x.first.compare(y.first) > 0);
+    return x.first > y.first;
   });
-  for (int i = 0; i < num_limit; i++) {
-    most_freq_symbols->push_back(symbol_freqs[i].first);
+  for (int64_t i = 0; i < num_picked; i++) {
+    std::string ngram(n_, 0);
+    for (int k = 0; k < n_; k++) {
+      ngram[k] = (char)(symbol_freqs[i].first >> (8 * (n_ - 1 - k)));
+    }
+    most_freq_symbols->push_back(ngram);
   }
   std::sort(most_freq_symbols->begin(), most_freq_symbols->end());
 }
@@ -177,34 +202,9 @@ void NGramSS::countIntervalFreq(const std::vector<std::string> &key_list) {
   for (int i = 0; i < (int)interval_prefixes_.size(); i++) {
     interval_freqs_.push_back(1);
   }
-  for (int i = 0; i < (int)key_list.size(); i++) {
-    int pos = 0;
-    while (pos < (int)key_list[i].length()) {
-      std::string cur_str = key_list[i].substr(pos, n_ + 1);
-      int idx = binarySearch(cur_str);
-      interval_freqs_[idx]++;
-      pos += (int)interval_prefixes_[idx].length();
-    }
-  }
-}
-
-int NGramSS::binarySearch(const std::string &key) const {
-  int l = 0;
-  int r = interval_boundaries_.size();
-  int m = 0;
-  while (r - l > 1) {
-    m = (l + r) >> 1;
-    std::string cur_key = interval_boundaries_[m];
-    int cmp = key.compare(cur_key);
-    if (cmp < 0) {
-      r = m;
-    } else if (cmp == 0) {
-      return m;
-    } else {
-      l = m;
-    }
-  }
-  return l;
+  IntervalFreqCounter freq_counter(n_, n_ + 1);
+  freq_counter.build(interval_boundaries_);
+  freq_counter.countIntervalFreq(key_list, &interval_freqs_, pool_);
 }
 
 }  // namespace hope
@@ -16,6 +16,9 @@ class SingleCharSS : public SymbolSelector {
 
  private:
   void countSymbolFreq(const std::vector<std::string> &key_list);
+  void countShardFreq(const std::vector<std::string> &key_list,
+		      const int64_t start_id, const int64_t end_id,
+		      int64_t *freq_list) const;
 
   int64_t freq_list_[kNumSingleChar];
 };
@@ -31,16 +34,39 @@ bool SingleCharSS::selectSymbols(const std::vector<std::string> &key_list,
                                  std::vector<SymbolFreq> *symbol_freq_list) {
   if (key_list.empty() || num_limit < kNumSingleChar) return false;
   countSymbolFreq(key_list);
+  num_candidates_ = 0;
   for (int i = 0; i < kNumSingleChar; i++) {
+    // every symbol starts at frequency 1
+    num_candidates_ += (freq_list_[i] > 1);
     symbol_freq_list->push_back(std::make_pair(std::string(1, (char)i), freq_list_[i]));
   }
   return true;
 }
 
 void SingleCharSS::countSymbolFreq(const std::vector<std::string> &key_list) {
-  for (int i = 0; i < (int)key_list.size(); i++) {
+  if (pool_ == nullptr) {
+    countShardFreq(key_list, 0, (int64_t)key_list.size(), freq_list_);
+    return;
+  }
+  std::vector<std::vector<int64_t> > shard_freq_lists(pool_->numThreads(),
+						      std::vector<int64_t>(kNumSingleChar, 0));
+  int num_shards = pool_->runShards((int64_t)key_list.size(), ThreadPool::kMinKeysPerShard,
+				    [&](int shard_id, int64_t start_id, int64_t end_id) {
+    countShardFreq(key_list, start_id, end_id, shard_freq_lists[shard_id].data());
+  });
+  for (int s = 0; s < num_shards; s++) {
+    for (int i = 0; i < kNumSingleChar; i++) {
+      freq_list_[i] += shard_freq_lists[s][i];
+    }
+  }
+}
+
+void SingleCharSS::countShardFreq(const std::vector<std::string> &key_list,
+				  const int64_t start_id, const int64_t end_id,
+				  int64_t *freq_list) const {
+  for (int64_t i = start_id; i < end_id; i++) {
     for (int j = 0; j < (int)key_list[i].length(); j++) {
-      freq_list_[(uint8_t)key_list[i][j]]++;
+      freq_list[(uint8_t)key_list[i][j]]++;
     }
   }
 }
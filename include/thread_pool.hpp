@@ -0,0 +1,142 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hope {
+
+// A fixed set of worker threads shared by the stages of an encoder
+// build. run() hands out task ids to the workers and to the calling
+// thread, and returns once all tasks are done. Tasks must not call
+// run() on the same pool.
+class ThreadPool {
+ public:
+  // Inputs smaller than this are not worth splitting across threads
+  static const int64_t kMinKeysPerShard = 4096;
+
+  // num_threads = 0 means using all the hardware threads
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  int numThreads() const { return num_threads_; }
+
+  // Runs task(task_id) for every task_id in [0, num_tasks)
+  void run(const int num_tasks, const std::function<void(int)> &task);
+
+  // Splits [0, n) into at most numThreads() contiguous shards of at
+  // least min_shard_size elements and runs task(shard_id, begin, end)
+  // on each. Returns the number of shards.
+  int runShards(const int64_t n, const int64_t min_shard_size,
+		const std::function<void(int, int64_t, int64_t)> &task);
+
+ private:
+  void workerLoop();
+  void runTasks();
+
+  int num_threads_;
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable job_cv_;
+  std::condition_variable done_cv_;
+  bool stop_;
+  int64_t generation_;
+  int num_busy_workers_;
+
+  const std::function<void(int)> *task_;
+  int num_tasks_;
+  std::atomic<int> next_task_id_;
+};
+
+ThreadPool::ThreadPool(int num_threads)
+    : stop_(false), generation_(0), num_busy_workers_(0), task_(nullptr), num_tasks_(0), next_task_id_(0) {
+  if (num_threads <= 0) num_threads = (int)std::thread::hardware_concurrency();
+  if (num_threads <= 0) num_threads = 1;
+  num_threads_ = num_threads;
+  // the calling thread is also used to run tasks
+  for (int i = 0; i < num_threads_ - 1; i++) {
+    workers_.push_back(std::thread(&ThreadPool::workerLoop, this));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  job_cv_.notify_all();
+  for (int i = 0; i < (int)workers_.size(); i++) {
+    workers_[i].join();
+  }
+}
+
+void ThreadPool::run(const int num_tasks, const std::function<void(int)> &task) {
+  if (num_tasks <= 0) return;
+  if (workers_.empty() || num_tasks == 1) {
+    for (int i = 0; i < num_tasks; i++) task(i);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_id_ = 0;
+    num_busy_workers_ = (int)workers_.size();
+    generation_++;
+  }
+  job_cv_.notify_all();
+  runTasks();
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this] { return num_busy_workers_ == 0; });
+  task_ = nullptr;
+}
+
+int ThreadPool::runShards(const int64_t n, const int64_t min_shard_size,
+			  const std::function<void(int, int64_t, int64_t)> &task) {
+  int64_t num_shards = num_threads_;
+  if (min_shard_size > 0) num_shards = std::min(num_shards, n / min_shard_size);
+  if (num_shards < 1) num_shards = 1;
+  int64_t shard_size = (n + num_shards - 1) / num_shards;
+  run((int)num_shards, [&](int shard_id) {
+    int64_t begin = shard_id * shard_size;
+    int64_t end = std::min(begin + shard_size, n);
+    if (begin < end) task(shard_id, begin, end);
+  });
+  return (int)num_shards;
+}
+
+void ThreadPool::workerLoop() {
+  int64_t last_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      job_cv_.wait(lock, [&] { return stop_ || generation_ != last_generation; });
+      if (stop_) return;
+      last_generation = generation_;
+    }
+    runTasks();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      num_busy_workers_--;
+    }
+    done_cv_.notify_one();
+  }
+}
+
+void ThreadPool::runTasks() {
+  while (true) {
+    int task_id = next_task_id_.fetch_add(1);
+    if (task_id >= num_tasks_) return;
+    (*task_)(task_id);
+  }
+}
+
+}  // namespace hope
+
+#endif  // THREAD_POOL_H
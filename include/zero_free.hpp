@@ -0,0 +1,81 @@
+#ifndef ZERO_FREE_H
+#define ZERO_FREE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+
+namespace hope {
+
+// Order-preserving escaping that removes the zero bytes from encoded keys
+// so that they can be stored as C strings (e.g., in HOT). Byte 0x00
+// becomes 0x01 0x01, byte 0x01 becomes 0x01 0x02 and the other bytes stay
+// as they are. The byte codes are prefix-free and ordered like the bytes,
+// so escaped keys compare (with strcmp or memcmp) like the original keys.
+// HOPE codes are dense, so few bytes are escaped.
+static const uint8_t kZeroFreeEscape = 0x01;
+
+// True if one of the 8 bytes of word is 0x00 or 0x01
+inline bool hasEscapedByte(const uint64_t word) {
+  return ((word - 0x0202020202020202ULL) & ~word & 0x8080808080808080ULL) != 0;
+}
+
+inline int countEscapedBytes(const uint8_t *buf, const int len) {
+  int count = 0;
+  int i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t word;
+    memcpy(&word, buf + i, 8);
+    if (!hasEscapedByte(word)) continue;
+    for (int j = i; j < i + 8; j++) count += (buf[j] <= kZeroFreeEscape);
+  }
+  for (; i < len; i++) count += (buf[i] <= kZeroFreeEscape);
+  return count;
+}
+
+// Escapes the len bytes of buf in place and appends a terminating zero.
+// buf needs room for 2 * len + 1 bytes. Returns the escaped length
+// without the terminator
+inline int escapeZeroBytes(uint8_t *buf, const int len) {
+  int num_escapes = countEscapedBytes(buf, len);
+  int esc_len = len + num_escapes;
+  buf[esc_len] = 0;
+  // move the bytes back to front; the ones before the first escape stay put
+  int dst = esc_len;
+  for (int src = len - 1; num_escapes > 0; src--) {
+    uint8_t b = buf[src];
+    if (b <= kZeroFreeEscape) {
+      buf[--dst] = b + 1;
+      buf[--dst] = kZeroFreeEscape;
+      num_escapes--;
+    } else {
+      buf[--dst] = b;
+    }
+  }
+  return esc_len;
+}
+
+inline void escapeZeroBytes(std::string &str) {
+  int len = (int)str.length();
+  int num_escapes = countEscapedBytes((const uint8_t *)str.data(), len);
+  if (num_escapes == 0) return;
+  str.resize(2 * len + 1);
+  str.resize(escapeZeroBytes((uint8_t *)&str[0], len));
+}
+
+// Reverses escapeZeroBytes. dst may be src. Returns the original length
+inline int unescapeZeroBytes(const uint8_t *src, const int len, uint8_t *dst) {
+  int dst_len = 0;
+  for (int i = 0; i < len; i++) {
+    if (src[i] == kZeroFreeEscape && i + 1 < len)
+      dst[dst_len++] = src[++i] - 1;
+    else
+      dst[dst_len++] = src[i];
+  }
+  return dst_len;
+}
+
+}  // namespace hope
+
+#endif  // ZERO_FREE_H
@@ -11,6 +11,8 @@ mkdir results/microbench/hu_tucker
 mkdir results/microbench/array_trie
 mkdir results/microbench/ht_vs_dc
 mkdir results/microbench/build_time_breakdown
+mkdir results/microbench/scalability
+mkdir results/microbench/cache_sweep
 mkdir results/SuRF
 mkdir results/SuRF/point
 mkdir results/SuRF/range
@@ -114,15 +114,6 @@ then
   install_hot_dependeny
 fi
 
-###################################################
-# Generate worklaods
-###################################################
-# Download YCSB if the directory does not exist
-cd workload_gen
-chmod 744 ./ycsb_download.sh
-[ ! -d "./YCSB" ] && ./ycsb_download.sh
-[ ! -d "../workloads" ] && mkdir ../workloads && ./gen_workload.sh
-
 ###################################################
 # Build Project
 ###################################################
@@ -138,6 +129,13 @@ fi
 make -j
 cd ${PROJECT_DIR}
 
+###################################################
+# Generate worklaods
+###################################################
+cd workload_gen
+[ ! -d "../workloads" ] && mkdir ../workloads && ./gen_workload.sh
+cd ${PROJECT_DIR}
+
 ##################################################
 # Run experiments
 ##################################################
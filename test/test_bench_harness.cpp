@@ -0,0 +1,111 @@
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench_harness.hpp"
+#include "gtest/gtest.h"
+
+namespace benchharness {
+
+namespace benchharnesstest {
+
+class BenchHarnessTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {}
+  virtual void TearDown() {}
+};
+
+Options makeOptions() {
+  Options options;
+  options.add("index", "btree", "index");
+  options.add("reps", "3", "repetitions");
+  options.add("output", "", "output file");
+  return options;
+}
+
+TEST_F(BenchHarnessTest, optionsTest) {
+  Options options = makeOptions();
+  const char *argv[] = {"bench", "--index=art", "--reps", "5"};
+  std::string error;
+  ASSERT_TRUE(options.parse(4, argv, &error));
+  EXPECT_EQ("art", options.get("index"));
+  EXPECT_EQ(5, options.getInt("reps"));
+  EXPECT_EQ("", options.get("output"));
+  EXPECT_FALSE(options.helpRequested());
+  std::vector<std::pair<std::string, std::string> > all = options.all();
+  ASSERT_EQ(3, (int)all.size());
+  EXPECT_EQ("index", all[0].first);
+  EXPECT_EQ("art", all[0].second);
+
+  const char *unknown_argv[] = {"bench", "--bogus=1"};
+  ASSERT_FALSE(options.parse(2, unknown_argv, &error));
+  EXPECT_EQ("unknown option --bogus", error);
+  const char *missing_argv[] = {"bench", "--reps"};
+  ASSERT_FALSE(options.parse(2, missing_argv, &error));
+  const char *help_argv[] = {"bench", "--help"};
+  ASSERT_TRUE(options.parse(2, help_argv, &error));
+  EXPECT_TRUE(options.helpRequested());
+}
+
+TEST_F(BenchHarnessTest, statsTest) {
+  Stats stats = computeStats({4, 1, 3, 2});
+  EXPECT_DOUBLE_EQ(2.5, stats.median);
+  EXPECT_DOUBLE_EQ(2.5, stats.mean);
+  EXPECT_DOUBLE_EQ(5.0 / 3, stats.variance);
+  EXPECT_DOUBLE_EQ(1, stats.min);
+  EXPECT_DOUBLE_EQ(4, stats.max);
+  stats = computeStats({7});
+  EXPECT_DOUBLE_EQ(7, stats.median);
+  EXPECT_DOUBLE_EQ(0, stats.variance);
+}
+
+TEST_F(BenchHarnessTest, writerTest) {
+  Record record;
+  record.config.push_back(std::make_pair("index", "btree"));
+  record.config.push_back(std::make_pair("dataset", "a,\"b\""));
+  record.addMetric("txn_mops", {1, 3});
+
+  std::ostringstream json;
+  ResultWriter json_writer(json, ResultWriter::kJson);
+  json_writer.write(record);
+  EXPECT_EQ(
+      "{\"config\":{\"index\":\"btree\",\"dataset\":\"a,\\\"b\\\"\"},\"metrics\":{\"txn_mops\":{\"median\":2,"
+      "\"mean\":2,\"variance\":2,\"min\":1,\"max\":3,\"values\":[1,3]}}}\n",
+      json.str());
+
+  std::ostringstream csv;
+  ResultWriter csv_writer(csv, ResultWriter::kCsv);
+  csv_writer.write(record);
+  csv_writer.write(record);
+  std::string row = "btree,\"a,\"\"b\"\"\",txn_mops,2,2,2,1,3,2\n";
+  EXPECT_EQ("index,dataset,metric,median,mean,variance,min,max,reps\n" + row + row, csv.str());
+
+  std::ostringstream appended;
+  ResultWriter append_writer(appended, ResultWriter::kCsv, false);
+  append_writer.write(record);
+  EXPECT_EQ(row, appended.str());
+
+  Record degenerate;
+  degenerate.addMetric("ratio", {std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity()});
+  std::ostringstream nonfinite;
+  ResultWriter nonfinite_writer(nonfinite, ResultWriter::kJson);
+  nonfinite_writer.write(degenerate);
+  EXPECT_EQ(std::string::npos, nonfinite.str().find("nan"));
+  EXPECT_EQ(std::string::npos, nonfinite.str().find("inf"));
+  EXPECT_NE(std::string::npos, nonfinite.str().find("\"values\":[null,null]"));
+
+  ResultWriter::Format format;
+  EXPECT_TRUE(ResultWriter::parseFormat("csv", &format));
+  EXPECT_EQ(ResultWriter::kCsv, format);
+  EXPECT_FALSE(ResultWriter::parseFormat("xml", &format));
+}
+
+}  // namespace benchharnesstest
+
+}  // namespace benchharness
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,92 @@
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "cache_info.hpp"
+#include "gtest/gtest.h"
+
+namespace benchharness {
+
+namespace cacheinfotest {
+
+static const std::string kCpuDir = "cache_info_test_cpu";
+
+class CacheInfoTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {}
+  virtual void TearDown() { system(("rm -rf " + kCpuDir).c_str()); }
+};
+
+// A sysfs cache/index<i> directory under kCpuDir
+void writeIndex(const int i, const int level, const std::string &type, const std::string &size,
+                const std::string &line_size) {
+  std::string dir = kCpuDir + "/cache/index" + std::to_string(i);
+  mkdir(kCpuDir.c_str(), 0755);
+  mkdir((kCpuDir + "/cache").c_str(), 0755);
+  mkdir(dir.c_str(), 0755);
+  std::ofstream(dir + "/level") << level << "\n";
+  std::ofstream(dir + "/type") << type << "\n";
+  std::ofstream(dir + "/size") << size << "\n";
+  std::ofstream(dir + "/coherency_line_size") << line_size << "\n";
+}
+
+TEST_F(CacheInfoTest, parseCacheSizeTest) {
+  EXPECT_EQ(48 * 1024, parseCacheSize("48K"));
+  EXPECT_EQ(2048 * 1024, parseCacheSize("2048K\n"));
+  EXPECT_EQ(16 * 1024 * 1024, parseCacheSize("16M"));
+  EXPECT_EQ(32768, parseCacheSize("32768"));
+  EXPECT_EQ(-1, parseCacheSize(""));
+  EXPECT_EQ(-1, parseCacheSize("K"));
+  EXPECT_EQ(-1, parseCacheSize("48KB"));
+}
+
+TEST_F(CacheInfoTest, readCacheLevelsTest) {
+  writeIndex(0, 1, "Data", "48K", "64");
+  writeIndex(1, 1, "Instruction", "32K", "64");
+  writeIndex(2, 3, "Unified", "16M", "64");
+  writeIndex(3, 2, "Unified", "2048K", "");
+  std::vector<CacheLevel> levels = readCacheLevels(kCpuDir);
+  ASSERT_EQ(3u, levels.size());
+  EXPECT_EQ("L1d", levels[0].name);
+  EXPECT_EQ(48 * 1024, levels[0].size_bytes);
+  EXPECT_EQ(64, levels[0].line_bytes);
+  EXPECT_EQ("L2", levels[1].name);
+  EXPECT_EQ(kDefaultCacheLineBytes, levels[1].line_bytes);
+  EXPECT_EQ("L3", levels[2].name);
+  EXPECT_EQ(3, levels[2].level);
+}
+
+TEST_F(CacheInfoTest, workingSetTest) {
+  // 100 bytes per entry
+  EXPECT_EQ(1000, workingSetBytes(100000, 1000, 10));
+  // at least a line per hot entry
+  EXPECT_EQ(640, workingSetBytes(10000, 1000, 10));
+  EXPECT_EQ(1280, workingSetBytes(10000, 1000, 10, 128));
+  // never more than the whole dictionary
+  EXPECT_EQ(10000, workingSetBytes(10000, 1000, 1000));
+  EXPECT_EQ(0, workingSetBytes(10000, 0, 10));
+  EXPECT_EQ(0, workingSetBytes(10000, 1000, 0));
+}
+
+TEST_F(CacheInfoTest, fittingLevelTest) {
+  std::vector<CacheLevel> levels = {{1, "L1d", 1024, 64}, {2, "L2", 8192, 64}, {3, "L3", 65536, 64}};
+  EXPECT_EQ(0, fittingLevel(levels, 0));
+  EXPECT_EQ(0, fittingLevel(levels, 1024));
+  EXPECT_EQ(1, fittingLevel(levels, 1025));
+  EXPECT_EQ(2, fittingLevel(levels, 65536));
+  EXPECT_EQ(3, fittingLevel(levels, 65537));
+  EXPECT_EQ(0, fittingLevel(std::vector<CacheLevel>(), 1));
+}
+
+}  // namespace cacheinfotest
+
+}  // namespace benchharness
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -104,6 +104,45 @@ TEST_F(DoubleCharEncoderTest, wordTest) {
   delete encoder;
 }
 
+// Symbols that never appear in the sample share run codes;
+// every symbol must still get its own order-preserving code
+TEST_F(DoubleCharEncoderTest, allSymbolsTest) {
+  std::vector<std::string> sample_keys;
+  for (int i = 0; i < static_cast<int>(words.size()); i += 100) {
+    sample_keys.push_back(words[i]);
+  }
+  DoubleCharEncoder *encoder = new DoubleCharEncoder();
+  ASSERT_TRUE(encoder->build(sample_keys, 65536));
+  auto buffer = new uint8_t[kLongestCodeLen];
+  std::string prev;
+  for (int i = 0; i < kNumDoubleChar; i++) {
+    std::string key;
+    key += (char)(i / 256);
+    key += (char)(i % 256);
+    int len = encoder->encode(key, buffer);
+    std::string cur = std::string((const char *)buffer, GetByteLen(len));
+    if (i > 0) {
+      EXPECT_LT(prev.compare(cur), 0);
+    }
+    prev = cur;
+  }
+  delete[] buffer;
+  delete encoder;
+}
+
+TEST_F(DoubleCharEncoderTest, buildStatsTest) {
+  DoubleCharEncoder *encoder = new DoubleCharEncoder();
+  encoder->build(words, 65536);
+  const BuildStats &stats = encoder->buildStats();
+  EXPECT_EQ(kNumDoubleChar, stats.num_intervals);
+  EXPECT_GT(stats.num_candidate_symbols, kNumSingleChar);
+  EXPECT_LT(stats.num_candidate_symbols, kNumDoubleChar);
+  // unseen symbols get long codes
+  EXPECT_GT(stats.max_code_len, stats.avg_code_len);
+  EXPECT_GT(stats.phase_sec[kCodeAssign], 0);
+  delete encoder;
+}
+
 TEST_F(DoubleCharEncoderTest, wikiTest) {
   DoubleCharEncoder *encoder = new DoubleCharEncoder();
   encoder->build(wikis, 65536);
@@ -0,0 +1,225 @@
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "encoded_key.hpp"
+#include "encoder_factory.hpp"
+#include "gtest/gtest.h"
+
+namespace hope {
+
+namespace encodedkeytest {
+
+static const char kWordFilePath[] = "../../datasets/words.txt";
+static const int kWordTestSize = 234369;
+static const int kRandomTestSize = 2000;
+static const int kMaxBitLen = 40;
+static const int kDictSizeLimit = 10000;
+static const int kLongestCodeLen = 4096;
+static std::vector<std::string> words;
+
+class EncodedKeyTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {}
+  virtual void TearDown() {}
+};
+
+int sign(const int cmp) { return (cmp > 0) - (cmp < 0); }
+
+// Bit strings are written as strings of '0' and '1', which std::string
+// orders the same way as the bits
+std::vector<std::string> randomBitStrings() {
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<> len_dis(0, kMaxBitLen);
+  // mostly zeros, so that keys often differ only in padding
+  std::uniform_int_distribution<> bit_dis(0, 3);
+  std::vector<std::string> bit_strs;
+  for (int i = 0; i < kRandomTestSize; i++) {
+    std::string bit_str(len_dis(gen), '0');
+    for (int j = 0; j < (int)bit_str.length(); j++)
+      if (bit_dis(gen) == 0) bit_str[j] = '1';
+    bit_strs.push_back(bit_str);
+  }
+  return bit_strs;
+}
+
+std::string toPadded(const std::string &bit_str) {
+  std::string bytes(byteLen(bit_str.length()), 0);
+  for (int i = 0; i < (int)bit_str.length(); i++)
+    if (bit_str[i] == '1') bytes[i >> 3] |= (char)(0x80 >> (i & 7));
+  return bytes;
+}
+
+int compareBytes(const std::string &a, const std::string &b) { return sign(a.compare(b)); }
+
+TEST_F(EncodedKeyTest, compareTest) {
+  std::vector<std::string> bit_strs = randomBitStrings();
+  std::vector<std::string> padded, canonical;
+  uint8_t buffer[64];
+  for (int i = 0; i < (int)bit_strs.size(); i++) {
+    padded.push_back(toPadded(bit_strs[i]));
+    canonical.push_back(toCanonicalKey((const uint8_t *)padded[i].data(), bit_strs[i].length()));
+    int bit_len = fromCanonicalKey((const uint8_t *)canonical[i].data(), canonical[i].length(), buffer);
+    ASSERT_EQ((int)bit_strs[i].length(), bit_len);
+    ASSERT_EQ(padded[i], std::string((const char *)buffer, byteLen(bit_len)));
+  }
+  int num_collisions = 0;
+  for (int i = 0; i < (int)bit_strs.size(); i++) {
+    for (int j = 0; j < (int)bit_strs.size(); j++) {
+      int cmp = sign(bit_strs[i].compare(bit_strs[j]));
+      ASSERT_EQ(cmp, sign(compareEncodedKeys((const uint8_t *)padded[i].data(), bit_strs[i].length(),
+					     (const uint8_t *)padded[j].data(), bit_strs[j].length())));
+      ASSERT_EQ(cmp, compareBytes(canonical[i], canonical[j]));
+      num_collisions += (cmp != 0 && padded[i] == padded[j]);
+    }
+  }
+  // the padded form is not strictly ordered
+  EXPECT_GT(num_collisions, 0);
+}
+
+// Every padded key of a bit-string range lies within the padded bounds
+TEST_F(EncodedKeyTest, boundTest) {
+  std::vector<std::string> bit_strs = randomBitStrings();
+  for (int i = 0; i < (int)bit_strs.size(); i += 10) {
+    const std::string &bound = bit_strs[i];
+    std::string padded_bound = toPadded(bound);
+    int bit_len = bound.length();
+    bool left_inclusive = paddedLeftInclusive(bit_len, false);
+    bool right_inclusive = paddedRightInclusive((const uint8_t *)padded_bound.data(), bit_len, false);
+    for (int j = 0; j < (int)bit_strs.size(); j++) {
+      int cmp = bit_strs[j].compare(bound);
+      int byte_cmp = compareBytes(toPadded(bit_strs[j]), padded_bound);
+      if (cmp > 0) {
+	ASSERT_TRUE(byte_cmp > 0 || (left_inclusive && byte_cmp == 0));
+      }
+      if (cmp < 0) {
+	ASSERT_TRUE(byte_cmp < 0 || (right_inclusive && byte_cmp == 0));
+      }
+    }
+    // the bounds are tight: an inclusive bound has a key that pads to it
+    if (left_inclusive) {
+      ASSERT_EQ(padded_bound, toPadded(bound + "0"));
+    }
+    if (right_inclusive) {
+      ASSERT_EQ(padded_bound, toPadded(bound.substr(0, bit_len - 1)));
+    }
+  }
+}
+
+TEST_F(EncodedKeyTest, encodeTest) {
+  uint8_t *buffer = new uint8_t[kLongestCodeLen];
+  uint8_t *buffer_r = new uint8_t[kLongestCodeLen];
+  for (int encoder_type = 1; encoder_type <= 6; encoder_type++) {
+    Encoder *encoder = EncoderFactory::createEncoder(encoder_type, 10000);
+    encoder->build(words, kDictSizeLimit);
+    std::string last_enc_key, last_canonical_key;
+    int last_bit_len = 0;
+    for (int i = 0; i < (int)words.size(); i++) {
+      int bit_len = encoder->encode(words[i], buffer);
+      std::string enc_key((const char *)buffer, byteLen(bit_len));
+      std::string canonical_key = toCanonicalKey(buffer, bit_len);
+      if (i > 0) {
+	ASSERT_LT(compareEncodedKeys((const uint8_t *)last_enc_key.data(), last_bit_len,
+				     (const uint8_t *)enc_key.data(), bit_len), 0);
+	ASSERT_LT(last_canonical_key.compare(canonical_key), 0);
+      }
+      last_enc_key = enc_key;
+      last_canonical_key = canonical_key;
+      last_bit_len = bit_len;
+    }
+
+    // the key between two exclusive bounds is in the padded byte range
+    for (int i = 0; i + 2 < (int)words.size(); i += 7) {
+      EncodedBound l_bound, r_bound;
+      encoder->encodeRange(words[i], false, words[i + 2], false, buffer, buffer_r, &l_bound, &r_bound);
+      std::string l_key((const char *)buffer, l_bound.byteLen());
+      std::string r_key((const char *)buffer_r, r_bound.byteLen());
+      int bit_len = encoder->encode(words[i + 1], buffer);
+      std::string key((const char *)buffer, byteLen(bit_len));
+      ASSERT_TRUE(key > l_key || (l_bound.inclusive && key == l_key));
+      ASSERT_TRUE(key < r_key || (r_bound.inclusive && key == r_key));
+    }
+    delete encoder;
+  }
+  delete[] buffer;
+  delete[] buffer_r;
+}
+
+bool inBounds(const std::string &key, const std::string &lo_key, const EncodedBound &lo_bound,
+	      const std::string &hi_key, const EncodedBound &hi_bound, const bool has_hi) {
+  if (key < lo_key || (key == lo_key && !lo_bound.inclusive)) return false;
+  return !has_hi || key < hi_key || (key == hi_key && hi_bound.inclusive);
+}
+
+// The words around each prefix range are in the encoded bounds exactly
+// when they start with the prefix, but for those that pad to a bound
+TEST_F(EncodedKeyTest, prefixRangeTest) {
+  std::string successor;
+  ASSERT_TRUE(prefixSuccessor("ab\xff\xff", &successor));
+  ASSERT_EQ("ac", successor);
+  ASSERT_FALSE(prefixSuccessor("\xff", &successor));
+  ASSERT_FALSE(prefixSuccessor("", &successor));
+
+  std::vector<std::string> prefixes = {"", "\xff", "a", "z\xff"};
+  for (int i = 0; i < (int)words.size(); i += 101) {
+    for (int len = 1; len <= (int)words[i].length(); len++) prefixes.push_back(words[i].substr(0, len));
+  }
+  uint8_t *buffer = new uint8_t[kLongestCodeLen];
+  uint8_t *buffer_hi = new uint8_t[kLongestCodeLen];
+  for (int encoder_type = 1; encoder_type <= 6; encoder_type++) {
+    Encoder *encoder = EncoderFactory::createEncoder(encoder_type, 10000);
+    encoder->build(words, kDictSizeLimit);
+    for (const std::string &prefix : prefixes) {
+      EncodedBound lo_bound, hi_bound;
+      bool has_hi = encoder->encodePrefixRange(prefix, buffer, buffer_hi, &lo_bound, &hi_bound);
+      ASSERT_EQ(has_hi, prefixSuccessor(prefix, &successor));
+      std::string lo_key((const char *)buffer, lo_bound.byteLen());
+      std::string hi_key = has_hi ? std::string((const char *)buffer_hi, hi_bound.byteLen()) : std::string();
+      int begin = std::lower_bound(words.begin(), words.end(), prefix) - words.begin();
+      int end = has_hi ? std::lower_bound(words.begin(), words.end(), successor) - words.begin() : words.size();
+      for (int j = std::max(0, begin - 3); j < std::min((int)words.size(), end + 3); j++) {
+	if (j >= begin + 3 && j < end - 3) j = end - 3;
+	int bit_len = encoder->encode(words[j], buffer);
+	std::string key((const char *)buffer, byteLen(bit_len));
+	bool has_prefix = words[j].compare(0, prefix.length(), prefix) == 0;
+	ASSERT_EQ(j >= begin && j < end, has_prefix);
+	bool in_bounds = inBounds(key, lo_key, lo_bound, hi_key, hi_bound, has_hi);
+	if (has_prefix) {
+	  ASSERT_TRUE(in_bounds);
+	} else if (in_bounds) {
+	  ASSERT_TRUE(key == lo_key || key == hi_key);
+	}
+      }
+    }
+    delete encoder;
+  }
+  delete[] buffer;
+  delete[] buffer_hi;
+}
+
+void LoadWords() {
+  std::ifstream infile(kWordFilePath);
+  std::string key;
+  int count = 0;
+  while (infile.good() && count < kWordTestSize) {
+    infile >> key;
+    words.push_back(key);
+    count++;
+  }
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+}
+
+}  // namespace encodedkeytest
+
+}  // namespace hope
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  hope::encodedkeytest::LoadWords();
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,122 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "encoder_factory.hpp"
+#include "encoder_profiler.hpp"
+#include "gtest/gtest.h"
+
+namespace hope {
+
+namespace encoderprofilertest {
+
+static const char kWordFilePath[] = "../../datasets/words.txt";
+static const int kWordTestSize = 234369;
+static const int kSampleStep = 100;
+static const int kLongestCodeLen = 4096;
+static std::vector<std::string> words;
+static std::vector<std::string> sample;
+
+class EncoderProfilerTest : public ::testing::Test {};
+
+// The profile splits keys as encode does: same bits in total
+TEST_F(EncoderProfilerTest, encodeMatchTest) {
+  uint8_t buffer[kLongestCodeLen];
+  for (int encoder_type = 1; encoder_type <= 6; encoder_type++) {
+    Encoder *encoder = EncoderFactory::createEncoder(encoder_type, 1000);
+    encoder->setKeepSymbols(true);
+    encoder->build(sample, 2000);
+    EncoderProfiler profiler(encoder);
+    EXPECT_TRUE(profiler.hasAllEntries());
+    int64_t total_bits = 0, total_bytes = 0;
+    for (const std::string &word : words) {
+      total_bits += encoder->encode(word, buffer);
+      total_bytes += word.length();
+    }
+    profiler.profile(words);
+    EXPECT_EQ((int64_t)words.size(), profiler.numKeys());
+    EXPECT_EQ(total_bits, profiler.numBits()) << "encoder " << encoder_type;
+    EXPECT_EQ(total_bytes, profiler.numBytes()) << "encoder " << encoder_type;
+    EXPECT_DOUBLE_EQ(total_bytes * 8.0 / total_bits, profiler.compressionRate());
+    // Hu-Tucker codes are prefix codes: no shorter than the entropy
+    EXPECT_GE(profiler.entropyBoundCompressionRate(), profiler.compressionRate() * 0.999);
+    EXPECT_GT(profiler.compressionRate(), 1);
+    delete encoder;
+  }
+}
+
+TEST_F(EncoderProfilerTest, reportTest) {
+  Encoder *encoder = EncoderFactory::createEncoder(3);
+  encoder->build(sample, 4096);
+  // the n-gram encoders drop their entries unless asked to keep them
+  EncoderProfiler partial_profiler(encoder);
+  EXPECT_FALSE(partial_profiler.hasAllEntries());
+  EXPECT_TRUE(partial_profiler.entries().empty());
+  partial_profiler.profile(words);
+  EXPECT_EQ(0, partial_profiler.numColdEntries());
+  delete encoder;
+
+  encoder = EncoderFactory::createEncoder(3);
+  encoder->setKeepSymbols(true);
+  encoder->build(sample, 4096);
+  EncoderProfiler profiler(encoder);
+  EXPECT_EQ((size_t)encoder->buildStats().num_intervals, profiler.entries().size());
+  profiler.profile(words);
+  EXPECT_EQ(partial_profiler.numBits(), profiler.numBits());
+  EXPECT_GT(profiler.numColdEntries(), 0);
+  std::vector<SymbolProfile> hottest = profiler.hottest(10);
+  std::vector<SymbolProfile> coldest = profiler.coldest(10);
+  ASSERT_EQ(10u, hottest.size());
+  ASSERT_EQ(10u, coldest.size());
+  for (int i = 1; i < 10; i++) {
+    EXPECT_GE(hottest[i - 1].hits, hottest[i].hits);
+    EXPECT_LE(coldest[i - 1].hits, coldest[i].hits);
+  }
+  EXPECT_EQ(0, coldest[0].hits);
+  EXPECT_EQ(hottest[0].hits * hottest[0].code.len, hottest[0].bits);
+  // frequent symbols get short codes
+  EXPECT_LT(hottest[0].code.len, encoder->buildStats().avg_code_len);
+
+  std::ostringstream report;
+  profiler.printReport(report, 5);
+  EXPECT_NE(std::string::npos, report.str().find("hottest"));
+  std::string json = profiler.toJson(5);
+  EXPECT_NE(std::string::npos, json.find("\"entropy_bound_compression_rate\":"));
+
+  int64_t num_hit_entries = (int64_t)profiler.entries().size() - profiler.numColdEntries();
+  EXPECT_EQ(num_hit_entries, profiler.numEntriesCovering(1));
+  EXPECT_EQ(1, profiler.numEntriesCovering((hottest[0].hits - 0.5) / profiler.numHits()));
+  int64_t num_hot = profiler.numEntriesCovering(0.9);
+  EXPECT_LT(num_hot, num_hit_entries);
+  EXPECT_LE(num_hot, profiler.numEntriesCovering(0.99));
+  EXPECT_EQ(0, profiler.numEntriesCovering(0));
+
+  profiler.clear();
+  EXPECT_EQ(0, profiler.numHits());
+  EXPECT_EQ(0, profiler.numEntriesCovering(0.99));
+  EXPECT_EQ("a\\x00\\x5c", EncoderProfiler::escapeSymbol(std::string("a\0\\", 3)));
+  delete encoder;
+}
+
+void loadWords() {
+  std::ifstream infile(kWordFilePath);
+  std::string key;
+  int count = 0;
+  while (infile.good() && count < kWordTestSize) {
+    infile >> key;
+    words.push_back(key);
+    count++;
+  }
+  for (int i = 0; i < (int)words.size(); i += kSampleStep) sample.push_back(words[i]);
+}
+
+}  // namespace encoderprofilertest
+
+}  // namespace hope
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  hope::encoderprofilertest::loadWords();
+  return RUN_ALL_TESTS();
+}
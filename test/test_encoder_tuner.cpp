@@ -0,0 +1,107 @@
+#include <assert.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "encoder_tuner.hpp"
+#include "gtest/gtest.h"
+
+namespace hope {
+
+namespace encodertunertest {
+
+static const char kWordFilePath[] = "../../datasets/words.txt";
+static const int kWordTestSize = 234369;
+static const int64_t kMemoryBudget = 200000;
+static std::vector<std::string> words;
+
+class EncoderTunerTest : public ::testing::Test {
+ public:
+  EncoderTunerTest() : tuner_(kMemoryBudget, 0) {
+    tuner_.setEncoderTypes({1, 3, 4, 6});
+    tuner_.setDictSizeRange(1024, 8192);
+    tuner_.setSampleSize(2000, 2000);
+  }
+
+  EncoderTuner tuner_;
+};
+
+TEST_F(EncoderTunerTest, memoryBudgetTest) {
+  EncoderConfig best;
+  ASSERT_TRUE(tuner_.tune(words, &best));
+  EXPECT_LE(best.memory, kMemoryBudget);
+  EXPECT_TRUE(best.within_budget);
+  EXPECT_TRUE(best.pareto_optimal);
+  const std::vector<EncoderConfig> &candidates = tuner_.getCandidates();
+  EXPECT_GT(candidates.size(), 4);
+  for (const auto &config : candidates) {
+    EXPECT_EQ(config.memory <= kMemoryBudget, config.within_budget);
+    if (config.within_budget) {
+      EXPECT_LE(config.cpr, best.cpr);
+    }
+  }
+  std::stringstream report;
+  tuner_.printReport(report);
+  EXPECT_FALSE(report.str().empty());
+}
+
+TEST_F(EncoderTunerTest, paretoTest) {
+  EncoderConfig best;
+  tuner_.tune(words, &best);
+  const std::vector<EncoderConfig> &candidates = tuner_.getCandidates();
+  for (const auto &x : candidates) {
+    bool dominated = false;
+    for (const auto &y : candidates) {
+      if (y.cpr >= x.cpr && y.latency <= x.latency && y.memory <= x.memory &&
+          (y.cpr > x.cpr || y.latency < x.latency || y.memory < x.memory))
+        dominated = true;
+    }
+    EXPECT_EQ(!dominated, x.pareto_optimal);
+  }
+}
+
+TEST_F(EncoderTunerTest, latencyBudgetTest) {
+  EncoderTuner tuner(kMemoryBudget, 0.001);
+  tuner.setEncoderTypes({1, 3});
+  tuner.setDictSizeRange(1024, 1024);
+  tuner.setSampleSize(2000, 2000);
+  EncoderConfig best;
+  EXPECT_FALSE(tuner.tune(words, &best));
+  EXPECT_EQ(2, (int)tuner.getCandidates().size());
+}
+
+TEST_F(EncoderTunerTest, buildTunedEncoderTest) {
+  EncoderConfig best;
+  ASSERT_TRUE(tuner_.tune(words, &best));
+  Encoder *encoder = EncoderTuner::createEncoder(best);
+  std::vector<std::string> key_list;
+  for (int i = 0; i < (int)words.size(); i += 100) {
+    key_list.push_back(words[i]);
+  }
+  ASSERT_TRUE(encoder->build(key_list, best.dict_size_limit));
+  EXPECT_LE(encoder->memoryUse(), kMemoryBudget * 2);
+  delete encoder;
+}
+
+void LoadWords() {
+  std::ifstream infile(kWordFilePath);
+  std::string key;
+  int count = 0;
+  while (std::getline(infile, key) && count < kWordTestSize) {
+    if (key.empty()) continue;
+    words.push_back(key);
+    count++;
+  }
+}
+
+}  // namespace encodertunertest
+}  // namespace hope
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  hope::encodertunertest::LoadWords();
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,118 @@
+#include <assert.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "encoder_factory.hpp"
+#include "gtest/gtest.h"
+#include "key_sampler.hpp"
+
+namespace hope {
+
+namespace keysamplertest {
+
+static const char kWordFilePath[] = "../../datasets/words.txt";
+static const int kWordTestSize = 234369;
+static const int kSampleSize = 2000;
+static const int kLongestCodeLen = 4096;
+static std::vector<std::string> words;
+
+class KeySamplerTest : public ::testing::Test {};
+
+int GetByteLen(const int bitlen) { return ((bitlen + 7) & ~7) / 8; }
+
+TEST_F(KeySamplerTest, shortStreamTest) {
+  KeySampler sampler(kSampleSize);
+  sampler.addKeys(words.begin(), words.begin() + 100);
+  ASSERT_EQ(100, (int)sampler.getSample().size());
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(words[i], sampler.getSample()[i]);
+  }
+}
+
+TEST_F(KeySamplerTest, boundedSampleTest) {
+  KeySampler sampler(kSampleSize);
+  int64_t total_len = 0;
+  for (int i = 0; i < (int)words.size(); i++) {
+    sampler.addKey(words[i]);
+    total_len += words[i].length();
+  }
+  EXPECT_EQ(kSampleSize, (int)sampler.getSample().size());
+  EXPECT_EQ((int64_t)words.size(), sampler.numKeys());
+  EXPECT_EQ(total_len, sampler.totalKeyLen());
+}
+
+TEST_F(KeySamplerTest, uniformTest) {
+  // words are sorted, so the sample drawn from the stream should
+  // be spread evenly over the whole key list
+  KeySampler sampler(kSampleSize);
+  sampler.addKeys(words.begin(), words.end());
+  std::vector<std::string> sample = sampler.getSample();
+  std::sort(sample.begin(), sample.end());
+  int num_buckets = 4;
+  int bucket_size = (int)words.size() / num_buckets;
+  for (int b = 0; b < num_buckets; b++) {
+    const std::string &lower = words[b * bucket_size];
+    const std::string &upper = words[std::min((b + 1) * bucket_size, (int)words.size() - 1)];
+    int count = (int)(std::lower_bound(sample.begin(), sample.end(), upper) -
+                      std::lower_bound(sample.begin(), sample.end(), lower));
+    EXPECT_GT(count, kSampleSize / num_buckets * 3 / 4);
+    EXPECT_LT(count, kSampleSize / num_buckets * 5 / 4);
+  }
+}
+
+TEST_F(KeySamplerTest, deterministicTest) {
+  KeySampler sampler1(kSampleSize, 7);
+  KeySampler sampler2(kSampleSize, 7);
+  sampler1.addKeys(words.begin(), words.end());
+  sampler2.addKeys(words.begin(), words.end());
+  EXPECT_EQ(sampler1.getSample(), sampler2.getSample());
+}
+
+TEST_F(KeySamplerTest, buildFromFileTest) {
+  for (int encoder_type = 1; encoder_type < 7; encoder_type++) {
+    if (encoder_type == 2) continue;
+    Encoder *encoder = EncoderFactory::createEncoder(encoder_type);
+    ASSERT_TRUE(encoder->buildFromFile(kWordFilePath, 1000, kSampleSize));
+    auto buffer = new uint8_t[kLongestCodeLen];
+    int len = encoder->encode(words[0], buffer);
+    std::string prev = std::string((const char *)buffer, GetByteLen(len));
+    for (int i = 1; i < (int)words.size(); i++) {
+      len = encoder->encode(words[i], buffer);
+      std::string cur = std::string((const char *)buffer, GetByteLen(len));
+      EXPECT_LT(prev.compare(cur), 0);
+      prev = cur;
+    }
+    delete[] buffer;
+    delete encoder;
+  }
+}
+
+TEST_F(KeySamplerTest, buildFromStreamTest) {
+  Encoder *encoder = EncoderFactory::createEncoder(3);
+  ASSERT_TRUE(encoder->buildFromStream(words.begin(), words.end(), 1000, kSampleSize));
+  EXPECT_GT(encoder->numEntries(), 0);
+  delete encoder;
+}
+
+void LoadWords() {
+  std::ifstream infile(kWordFilePath);
+  std::string key;
+  int count = 0;
+  while (std::getline(infile, key) && count < kWordTestSize) {
+    if (key.empty()) continue;
+    words.push_back(key);
+    count++;
+  }
+}
+
+}  // namespace keysamplertest
+}  // namespace hope
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  hope::keysamplertest::LoadWords();
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "key_set.hpp"
+
+namespace benchharness {
+
+namespace keysettest {
+
+static const std::string kFileName = "key_set_test_keys.txt";
+static const int kNumBigKeys = 1000000;
+
+class KeySetTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {}
+  virtual void TearDown() {
+    unlink(kFileName.c_str());
+    unlink((kFileName + ".idx").c_str());
+  }
+};
+
+// A new file each time, so that open KeySets keep their mapping
+void writeFile(const std::string &content) {
+  unlink(kFileName.c_str());
+  unlink((kFileName + ".idx").c_str());
+  std::ofstream outfile(kFileName, std::ios::binary | std::ios::trunc);
+  outfile << content;
+}
+
+TEST_F(KeySetTest, lineTest) {
+  writeFile("banana\r\napple\n\ncherry\r\n\napple\ndate");
+  KeySet key_set;
+  ASSERT_TRUE(key_set.open(kFileName));
+  EXPECT_FALSE(key_set.indexFromCache());
+  std::vector<std::string> expected = {"banana", "apple", "cherry", "apple", "date"};
+  ASSERT_EQ((int64_t)expected.size(), key_set.size());
+  EXPECT_EQ(expected, key_set.strings(key_set.ids()));
+  EXPECT_EQ(26, key_set.totalLength(key_set.ids()));
+
+  KeyIds first = key_set.ids(2);
+  ASSERT_EQ(2u, first.size());
+  EXPECT_EQ("apple", key_set.str(first[1]));
+  EXPECT_EQ(5u, key_set.ids(100).size());
+
+  KeyIds sorted = key_set.ids();
+  key_set.sortIds(&sorted, false);
+  EXPECT_EQ(std::vector<std::string>({"apple", "apple", "banana", "cherry", "date"}), key_set.strings(sorted));
+  EXPECT_EQ(1u, sorted[0]);
+  key_set.sortIds(&sorted, true);
+  EXPECT_EQ(std::vector<std::string>({"apple", "banana", "cherry", "date"}), key_set.strings(sorted));
+  EXPECT_EQ(1u, sorted[0]);
+
+  EXPECT_EQ(KeyIds({0, 2, 4}), KeySet::sample(key_set.ids(), 2));
+
+  EXPECT_FALSE(key_set.key(1).isProperPrefixOf(key_set.key(3)));
+  EXPECT_FALSE(key_set.key(0).isProperPrefixOf(key_set.key(1)));
+  writeFile("app\napple\n");
+  KeySet prefix_set;
+  ASSERT_TRUE(prefix_set.open(kFileName));
+  EXPECT_TRUE(prefix_set.key(0).isProperPrefixOf(prefix_set.key(1)));
+  EXPECT_FALSE(prefix_set.key(1).isProperPrefixOf(prefix_set.key(0)));
+}
+
+TEST_F(KeySetTest, cacheTest) {
+  writeFile("one\ntwo\nthree\n");
+  {
+    KeySet key_set;
+    ASSERT_TRUE(key_set.open(kFileName));
+    EXPECT_FALSE(key_set.indexFromCache());
+  }
+  KeySet key_set;
+  ASSERT_TRUE(key_set.open(kFileName));
+  EXPECT_TRUE(key_set.indexFromCache());
+  EXPECT_EQ(std::vector<std::string>({"one", "two", "three"}), key_set.strings(key_set.ids()));
+
+  // a changed file must not use the old index
+  writeFile("one\ntwo\nthree\nfour\n");
+  ASSERT_TRUE(key_set.open(kFileName));
+  EXPECT_FALSE(key_set.indexFromCache());
+  EXPECT_EQ(4, key_set.size());
+
+  // nor a corrupted one
+  ASSERT_TRUE(key_set.open(kFileName));
+  EXPECT_TRUE(key_set.indexFromCache());
+  {
+    std::fstream index_file(kFileName + ".idx", std::ios::binary | std::ios::in | std::ios::out);
+    uint64_t num_keys = UINT64_MAX / 8;
+    index_file.seekp(4 * sizeof(uint64_t));
+    index_file.write((const char *)&num_keys, sizeof(num_keys));
+  }
+  ASSERT_TRUE(key_set.open(kFileName));
+  EXPECT_FALSE(key_set.indexFromCache());
+  EXPECT_EQ(4, key_set.size());
+
+  EXPECT_FALSE(key_set.open("no_such_key_file.txt"));
+  EXPECT_EQ(0, key_set.size());
+}
+
+TEST_F(KeySetTest, shuffleTest) {
+  writeFile("a\nb\nc\nd\ne\nf\ng\nh\n");
+  KeySet key_set;
+  ASSERT_TRUE(key_set.open(kFileName));
+  KeyIds shuffled = key_set.shuffledIds(0);
+  EXPECT_EQ(shuffled, key_set.shuffledIds(0));
+  EXPECT_EQ(4u, key_set.shuffledIds(0, 4).size());
+  std::sort(shuffled.begin(), shuffled.end());
+  EXPECT_EQ(key_set.ids(), shuffled);
+}
+
+TEST_F(KeySetTest, parallelScanTest) {
+  std::string content;
+  for (int i = 0; i < kNumBigKeys; i++)
+    content += "key" + std::to_string((int64_t)i * 7919) + ((i % 3 == 0) ? "\r\n" : "\n");
+  writeFile(content);
+  KeySet serial;
+  ASSERT_TRUE(serial.open(kFileName, 1));
+  ASSERT_EQ(kNumBigKeys, serial.size());
+  unlink((kFileName + ".idx").c_str());
+  KeySet parallel;
+  ASSERT_TRUE(parallel.open(kFileName, 4));
+  EXPECT_FALSE(parallel.indexFromCache());
+  ASSERT_EQ(serial.size(), parallel.size());
+  for (int64_t i = 0; i < serial.size(); i++) {
+    ASSERT_EQ(serial.str((uint32_t)i), parallel.str((uint32_t)i));
+  }
+}
+
+}  // namespace keysettest
+
+}  // namespace benchharness
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
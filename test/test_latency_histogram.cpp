@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "latency_histogram.hpp"
+
+namespace benchharness {
+
+namespace latencyhistogramtest {
+
+static const int kNumValues = 100000;
+
+class LatencyHistogramTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {}
+  virtual void TearDown() {}
+};
+
+// Every value lies in its bucket, and buckets are within 1/16 of it
+TEST_F(LatencyHistogramTest, bucketTest) {
+  std::mt19937_64 gen(0);
+  for (int i = 0; i < kNumValues; i++) {
+    uint64_t value = gen() >> (gen() % 64);
+    int bucket = LatencyHistogram::bucketOf(value);
+    ASSERT_GE(bucket, 0);
+    ASSERT_LT(bucket, (int)LatencyHistogram::kNumBuckets);
+    uint64_t bucket_max = LatencyHistogram::bucketMax(bucket);
+    ASSERT_GE(bucket_max, value);
+    ASSERT_LE(bucket_max - value, value / 16);
+    if (bucket > 0) {
+      ASSERT_LT(LatencyHistogram::bucketMax(bucket - 1), value);
+    }
+  }
+  for (uint64_t value = 0; value < 32; value++) ASSERT_EQ(value, LatencyHistogram::bucketMax((int)value));
+  ASSERT_EQ(LatencyHistogram::kNumBuckets - 1, LatencyHistogram::bucketOf(UINT64_MAX));
+}
+
+TEST_F(LatencyHistogramTest, percentileTest) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0u, histogram.percentile(99));
+  std::mt19937_64 gen(0);
+  std::vector<uint64_t> values;
+  for (int i = 0; i < kNumValues; i++) {
+    uint64_t value = 100 + gen() % 100000;
+    values.push_back(value);
+    histogram.record(value);
+  }
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ((uint64_t)kNumValues, histogram.count());
+  EXPECT_EQ(values.back(), histogram.max());
+  EXPECT_EQ(values.back(), histogram.percentile(100));
+  for (double percentile : {1.0, 50.0, 90.0, 99.0, 99.9}) {
+    uint64_t exact = values[(size_t)(percentile / 100 * kNumValues + 0.5) - 1];
+    uint64_t approx = histogram.percentile(percentile);
+    EXPECT_GE(approx, exact);
+    EXPECT_LE(approx - exact, exact / 16);
+  }
+
+  LatencyHistogram other;
+  other.record(1000000000);
+  histogram.merge(other);
+  EXPECT_EQ((uint64_t)kNumValues + 1, histogram.count());
+  EXPECT_EQ(1000000000u, histogram.max());
+  histogram.clear();
+  EXPECT_EQ(0u, histogram.count());
+}
+
+TEST_F(LatencyHistogramTest, keyLengthTest) {
+  EXPECT_EQ(0, KeyLengthHistograms::rangeOf(1));
+  EXPECT_EQ(0, KeyLengthHistograms::rangeOf(8));
+  EXPECT_EQ(1, KeyLengthHistograms::rangeOf(9));
+  EXPECT_EQ(4, KeyLengthHistograms::rangeOf(128));
+  EXPECT_EQ(5, KeyLengthHistograms::rangeOf(100000));
+
+  KeyLengthHistograms histograms;
+  for (int i = 0; i < 100; i++) histograms.record(4, 10);
+  histograms.record(200, 5000);
+  EXPECT_EQ(101u, histograms.all().count());
+  EXPECT_EQ(100u, histograms.range(0).count());
+  EXPECT_EQ(1u, histograms.range(5).count());
+  EXPECT_EQ(10u, histograms.range(0).percentile(99.9));
+  EXPECT_EQ(5000u, histograms.all().max());
+
+  LatencyMetrics metrics;
+  metrics.add("encode", histograms);
+  metrics.add("encode", histograms);
+  Record record;
+  metrics.addTo(&record);
+  ASSERT_EQ("encode_ns_p50", record.metrics[0].first);
+  EXPECT_EQ(2u, record.metrics[0].second.size());
+  bool has_long_range = false;
+  for (const auto &metric : record.metrics) has_long_range |= (metric.first == "encode_ns_p99_9_len_129_");
+  EXPECT_TRUE(has_long_range);
+}
+
+}  // namespace latencyhistogramtest
+
+}  // namespace benchharness
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
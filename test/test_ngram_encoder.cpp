@@ -150,6 +150,54 @@ TEST_F(NGramEncoderTest, word4BatchTest) {
   }
 }
 
+TEST_F(NGramEncoderTest, buildStatsTest) {
+  NGramEncoder *encoder = new NGramEncoder(3);
+  encoder->build(words, 10000);
+  const BuildStats &stats = encoder->buildStats();
+  EXPECT_EQ((int64_t)words.size(), stats.num_sample_keys);
+  EXPECT_GT(stats.num_candidate_symbols, 5000);
+  EXPECT_GT(stats.num_intervals, 5000);
+  EXPECT_LE(stats.num_intervals, 10000);
+  EXPECT_GT(stats.avg_code_len, 1);
+  EXPECT_LE(stats.avg_code_len, stats.max_code_len);
+  EXPECT_LE(stats.max_code_len, 32);
+  double phase_sum = 0;
+  for (int i = 0; i < kNumBuildPhases; i++) {
+    EXPECT_GE(stats.phase_sec[i], 0);
+    EXPECT_NE(0, stats.phase_peak_rss_bytes[i]);
+    phase_sum += stats.phase_sec[i];
+  }
+  EXPECT_GE(stats.total_sec, phase_sum * 0.99);
+  std::string json = stats.toJson();
+  EXPECT_EQ('{', json[0]);
+  EXPECT_NE(std::string::npos, json.find("\"symbol_select_sec\":"));
+  EXPECT_NE(std::string::npos, json.find("\"num_intervals\":" + std::to_string(stats.num_intervals)));
+
+  // stats are of the last build only
+  std::vector<std::string> few_words(words.begin(), words.begin() + 1000);
+  encoder->build(few_words, 1000);
+  EXPECT_EQ(1000, encoder->buildStats().num_sample_keys);
+  delete encoder;
+}
+
+TEST_F(NGramEncoderTest, peakRssTest) {
+  // raise the process's peak RSS well above the build's
+  std::vector<char> *big = new std::vector<char>(256 << 20, 1);
+  delete big;
+  int64_t peak = peakRssBytes();
+  NGramEncoder *encoder = new NGramEncoder(3);
+  encoder->build(words, 10000);
+  // the peak is only reset on request
+  EXPECT_GE(peakRssBytes(), peak);
+  EXPECT_GE(encoder->buildStats().phase_peak_rss_bytes[kSymbolSelect], peak);
+  encoder->setResetPeakRss(true);
+  encoder->build(words, 10000);
+  if (peak > 0 && resetPeakRss()) {
+    EXPECT_LT(encoder->buildStats().phase_peak_rss_bytes[kDictBuild], peak);
+  }
+  delete encoder;
+}
+
 TEST_F(NGramEncoderTest, wiki3Test) {
   NGramEncoder *encoder = new NGramEncoder(3);
   encoder->build(wikis, 10000);
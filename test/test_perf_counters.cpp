@@ -0,0 +1,76 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "perf_counters.hpp"
+
+namespace benchharness {
+
+namespace perfcounterstest {
+
+static const int kNumOps = 1000000;
+
+class PerfCountersTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {}
+  virtual void TearDown() {}
+};
+
+volatile uint64_t sink;
+
+void work() {
+  uint64_t sum = 0;
+  for (int i = 0; i < kNumOps; i++) sum += (uint64_t)i * i;
+  sink = sum;
+}
+
+// Counters may be unavailable (e.g., in a VM); what opens must count
+TEST_F(PerfCountersTest, countTest) {
+  PerfCounters counters;
+  counters.start();
+  work();
+  counters.stop();
+  for (int i = 0; i < PerfCounters::kNumEvents; i++) {
+    if (!counters.available(i)) {
+      EXPECT_EQ(0, counters.value(i));
+    }
+  }
+  if (counters.available(PerfCounters::kInstructions)) {
+    EXPECT_GT(counters.value(PerfCounters::kInstructions), (double)kNumOps);
+  }
+  if (counters.available(PerfCounters::kCycles)) {
+    EXPECT_GT(counters.value(PerfCounters::kCycles), 0);
+  }
+  if (counters.available(PerfCounters::kTaskClock)) {
+    EXPECT_GT(counters.value(PerfCounters::kTaskClock), 0);
+  }
+
+  std::vector<std::pair<std::string, double> > metrics = counters.perOp("encode", kNumOps, "key");
+  int num_available = 0;
+  for (int i = 0; i < PerfCounters::kNumEvents; i++) num_available += counters.available(i);
+  ASSERT_LE(num_available, (int)metrics.size());
+  for (const auto &metric : metrics) {
+    EXPECT_EQ(0u, metric.first.find("encode_"));
+    EXPECT_GE(metric.second, 0);
+  }
+  if (counters.available(PerfCounters::kTaskClock)) {
+    bool found = false;
+    for (const auto &metric : metrics) found |= (metric.first == "encode_task_clock_ns_per_key");
+    EXPECT_TRUE(found);
+  }
+  EXPECT_TRUE(counters.perOp("encode", 0, "key").empty());
+
+  std::ostringstream os;
+  printPerfCounters(os, "encode", counters, kNumOps, "key");
+  EXPECT_EQ(0u, os.str().find("encode per key:"));
+}
+
+}  // namespace perfcounterstest
+
+}  // namespace benchharness
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
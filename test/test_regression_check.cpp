@@ -0,0 +1,135 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "regression_check.hpp"
+
+namespace benchharness {
+
+namespace regressionchecktest {
+
+class RegressionCheckTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {}
+  virtual void TearDown() {}
+};
+
+std::vector<BaselineEntry> baselineEntries() {
+  return {
+      {"words/3/1024", kCalibrationMetric, 2.0, 0.1},
+      {"words/3/1024", "build_sec", 1.0, 0.01},
+      {"words/3/1024", "encode_ns_per_char", 10.0, 0.2},
+      {"words/3/1024", "compression_rate", 1.6, 0},
+      {"words/3/1024", "memory_bytes", 10000, 0},
+  };
+}
+
+RegressionChecker::Verdict verdictOf(const std::vector<RegressionChecker::Result> &results,
+				     const std::string &metric) {
+  for (const RegressionChecker::Result &result : results) {
+    if (result.metric == metric) return result.verdict;
+  }
+  return RegressionChecker::kUnchanged;
+}
+
+void setMetric(std::vector<BaselineEntry> *entries, const std::string &metric, const double median) {
+  for (BaselineEntry &entry : *entries) {
+    if (entry.metric == metric) entry.median = median;
+  }
+}
+
+TEST_F(RegressionCheckTest, baselineFileTest) {
+  std::vector<BaselineEntry> entries = baselineEntries();
+  std::stringstream ss;
+  RegressionChecker::writeBaseline(ss, entries);
+  std::vector<BaselineEntry> read_entries;
+  std::string error;
+  ASSERT_TRUE(RegressionChecker::readBaseline(ss, &read_entries, &error));
+  ASSERT_EQ(entries.size(), read_entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    EXPECT_EQ(entries[i].config, read_entries[i].config);
+    EXPECT_EQ(entries[i].metric, read_entries[i].metric);
+    EXPECT_DOUBLE_EQ(entries[i].median, read_entries[i].median);
+    EXPECT_DOUBLE_EQ(entries[i].stddev, read_entries[i].stddev);
+  }
+
+  std::stringstream bad("config,metric,median,stddev\nwords/3/1024,build_sec,1\n");
+  EXPECT_FALSE(RegressionChecker::readBaseline(bad, &read_entries, &error));
+  EXPECT_FALSE(error.empty());
+}
+
+TEST_F(RegressionCheckTest, verdictTest) {
+  RegressionChecker checker(baselineEntries(), true);
+  std::vector<RegressionChecker::Result> results = checker.check(baselineEntries());
+  EXPECT_EQ(4u, results.size());
+  EXPECT_EQ(0, RegressionChecker::numFailures(results));
+
+  // the compression rate and memory are exact
+  std::vector<BaselineEntry> current = baselineEntries();
+  setMetric(&current, "compression_rate", 1.59);
+  setMetric(&current, "memory_bytes", 9000);
+  results = checker.check(current);
+  EXPECT_EQ(RegressionChecker::kRegressed, verdictOf(results, "compression_rate"));
+  EXPECT_EQ(RegressionChecker::kImproved, verdictOf(results, "memory_bytes"));
+  EXPECT_EQ(1, RegressionChecker::numFailures(results));
+
+  // 10 + 25% + 3 * 5% calibration noise + 3 stddevs = 14.6 ns/char
+  current = baselineEntries();
+  setMetric(&current, "encode_ns_per_char", 14.5);
+  EXPECT_EQ(RegressionChecker::kUnchanged, verdictOf(checker.check(current), "encode_ns_per_char"));
+  setMetric(&current, "encode_ns_per_char", 14.7);
+  EXPECT_EQ(RegressionChecker::kRegressed, verdictOf(checker.check(current), "encode_ns_per_char"));
+
+  // a noisier calibration in either run allows more
+  current[0].stddev = 0.2;
+  EXPECT_EQ(RegressionChecker::kUnchanged, verdictOf(checker.check(current), "encode_ns_per_char"));
+  current[0].stddev = 0.1;
+
+  // noisier runs are allowed more
+  setMetric(&current, "encode_ns_per_char", 15.0);
+  EXPECT_EQ(RegressionChecker::kRegressed, verdictOf(checker.check(current), "encode_ns_per_char"));
+  current[2].stddev = 1.0;
+  EXPECT_EQ(RegressionChecker::kUnchanged, verdictOf(checker.check(current), "encode_ns_per_char"));
+
+  RegressionChecker no_timing_checker(baselineEntries(), false);
+  results = no_timing_checker.check(current);
+  EXPECT_EQ(2u, results.size());
+  EXPECT_EQ(0, RegressionChecker::numFailures(results));
+}
+
+TEST_F(RegressionCheckTest, calibrationTest) {
+  RegressionChecker checker(baselineEntries(), true);
+  // a machine half as fast: twice the timings are no regression
+  std::vector<BaselineEntry> current = baselineEntries();
+  setMetric(&current, kCalibrationMetric, 4.0);
+  setMetric(&current, "encode_ns_per_char", 20.0);
+  setMetric(&current, "build_sec", 2.0);
+  std::vector<RegressionChecker::Result> results = checker.check(current);
+  EXPECT_EQ(0, RegressionChecker::numFailures(results));
+  EXPECT_DOUBLE_EQ(20.0, results[1].baseline);
+
+  setMetric(&current, kCalibrationMetric, 2.0);
+  EXPECT_EQ(RegressionChecker::kRegressed, verdictOf(checker.check(current), "encode_ns_per_char"));
+}
+
+TEST_F(RegressionCheckTest, missingTest) {
+  RegressionChecker checker(baselineEntries(), true);
+  std::vector<BaselineEntry> current = baselineEntries();
+  current.pop_back();
+  current.push_back(BaselineEntry{"urls/3/1024", "compression_rate", 1.4, 0});
+  std::vector<RegressionChecker::Result> results = checker.check(current);
+  EXPECT_EQ(RegressionChecker::kNew, results[3].verdict);
+  EXPECT_EQ(RegressionChecker::kMissing, results.back().verdict);
+  EXPECT_EQ("memory_bytes", results.back().metric);
+  EXPECT_EQ(1, RegressionChecker::numFailures(results));
+}
+
+}  // namespace regressionchecktest
+
+}  // namespace benchharness
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,106 @@
+#include <assert.h>
+#include <string.h>
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "encoder_factory.hpp"
+#include "gtest/gtest.h"
+#include "thread_pool.hpp"
+
+namespace hope {
+
+namespace threadpooltest {
+
+static const char kWordFilePath[] = "../../datasets/words.txt";
+static const int kWordTestSize = 234369;
+static const int kDictSizeLimit = 1000;
+static const int kLongestCodeLen = 4096;
+static std::vector<std::string> words;
+
+class ThreadPoolTest : public ::testing::Test {};
+
+int GetByteLen(const int bitlen) { return ((bitlen + 7) & ~7) / 8; }
+
+TEST_F(ThreadPoolTest, runTest) {
+  ThreadPool pool(4);
+  EXPECT_EQ(4, pool.numThreads());
+  for (int round = 0; round < 10; round++) {
+    std::vector<int> visits(1000, 0);
+    pool.run((int)visits.size(), [&](int task_id) { visits[task_id]++; });
+    for (int i = 0; i < (int)visits.size(); i++) {
+      EXPECT_EQ(1, visits[i]);
+    }
+  }
+}
+
+TEST_F(ThreadPoolTest, runShardsTest) {
+  ThreadPool pool(4);
+  int64_t n = 100000;
+  std::atomic<int64_t> sum(0);
+  int num_shards = pool.runShards(n, ThreadPool::kMinKeysPerShard,
+				  [&](int shard_id, int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) sum += i;
+  });
+  EXPECT_EQ(4, num_shards);
+  EXPECT_EQ(n * (n - 1) / 2, sum.load());
+
+  // small inputs are not split
+  num_shards = pool.runShards(100, ThreadPool::kMinKeysPerShard,
+			      [&](int shard_id, int64_t begin, int64_t end) {
+    EXPECT_EQ(0, begin);
+    EXPECT_EQ(100, end);
+  });
+  EXPECT_EQ(1, num_shards);
+}
+
+// The dictionary must not depend on the number of build threads
+TEST_F(ThreadPoolTest, deterministicBuildTest) {
+  std::vector<std::string> key_list;
+  for (int i = 0; i < (int)words.size(); i += 5) {
+    key_list.push_back(words[i]);
+  }
+  for (int encoder_type = 1; encoder_type < 7; encoder_type++) {
+    if (encoder_type == 2) continue;
+    Encoder *serial_encoder = EncoderFactory::createEncoder(encoder_type, 10000, 1);
+    Encoder *parallel_encoder = EncoderFactory::createEncoder(encoder_type, 10000, 4);
+    serial_encoder->build(key_list, kDictSizeLimit);
+    parallel_encoder->build(key_list, kDictSizeLimit);
+    EXPECT_EQ(serial_encoder->numEntries(), parallel_encoder->numEntries());
+    auto serial_buffer = new uint8_t[kLongestCodeLen];
+    auto parallel_buffer = new uint8_t[kLongestCodeLen];
+    for (int i = 0; i < (int)words.size(); i += 7) {
+      int serial_len = serial_encoder->encode(words[i], serial_buffer);
+      int parallel_len = parallel_encoder->encode(words[i], parallel_buffer);
+      ASSERT_EQ(serial_len, parallel_len);
+      EXPECT_EQ(0, memcmp(serial_buffer, parallel_buffer, GetByteLen(serial_len)));
+    }
+    delete[] serial_buffer;
+    delete[] parallel_buffer;
+    delete serial_encoder;
+    delete parallel_encoder;
+  }
+}
+
+void LoadWords() {
+  std::ifstream infile(kWordFilePath);
+  std::string key;
+  int count = 0;
+  while (std::getline(infile, key) && count < kWordTestSize) {
+    if (key.empty()) continue;
+    words.push_back(key);
+    count++;
+  }
+}
+
+}  // namespace threadpooltest
+}  // namespace hope
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  hope::threadpooltest::LoadWords();
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "workload_generator.hpp"
+
+namespace workloadgen {
+
+namespace workloadgeneratortest {
+
+static const char kSpecFilePath[] = "../../workload_gen/workload_spec/workloade_email_zipfian";
+static const int64_t kNumRecords = 100000;
+static const int64_t kNumOps = 1000000;
+
+class WorkloadGeneratorTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {}
+  virtual void TearDown() {}
+};
+
+std::vector<int64_t> countKeys(const WorkloadSpec &spec, const uint64_t seed) {
+  std::vector<int64_t> counts(spec.record_count, 0);
+  WorkloadGenerator generator(spec, seed);
+  for (int64_t i = 0; i < spec.operation_count; i++) {
+    Operation op = generator.next();
+    EXPECT_GE(op.key_id, 0);
+    EXPECT_LT(op.key_id, spec.record_count);
+    counts[op.key_id]++;
+  }
+  return counts;
+}
+
+WorkloadSpec makeSpec(const Distribution distribution) {
+  WorkloadSpec spec;
+  spec.record_count = kNumRecords;
+  spec.operation_count = kNumOps;
+  spec.request_distribution = distribution;
+  return spec;
+}
+
+TEST_F(WorkloadGeneratorTest, specTest) {
+  WorkloadSpec spec;
+  ASSERT_TRUE(loadSpec(kSpecFilePath, &spec));
+  EXPECT_EQ(25000000, spec.record_count);
+  EXPECT_EQ(10000000, spec.operation_count);
+  EXPECT_EQ(0, spec.read_proportion);
+  EXPECT_EQ(1, spec.scan_proportion);
+  EXPECT_EQ(kZipfian, spec.request_distribution);
+  EXPECT_EQ(100, spec.max_scan_length);
+  EXPECT_EQ(kUniform, spec.scan_length_distribution);
+  ASSERT_FALSE(loadSpec("no_such_spec", &spec));
+}
+
+TEST_F(WorkloadGeneratorTest, determinismTest) {
+  WorkloadSpec spec = makeSpec(kZipfian);
+  spec.read_proportion = 0.5;
+  spec.scan_proportion = 0.5;
+  WorkloadGenerator generator(spec, 7), same_generator(spec, 7), other_generator(spec, 8);
+  int num_diffs = 0;
+  for (int i = 0; i < 10000; i++) {
+    Operation op = generator.next();
+    Operation same_op = same_generator.next();
+    Operation other_op = other_generator.next();
+    ASSERT_EQ(op.type, same_op.type);
+    ASSERT_EQ(op.key_id, same_op.key_id);
+    ASSERT_EQ(op.scan_len, same_op.scan_len);
+    num_diffs += (op.key_id != other_op.key_id);
+  }
+  EXPECT_GT(num_diffs, 9000);
+}
+
+TEST_F(WorkloadGeneratorTest, uniformTest) {
+  std::vector<int64_t> counts = countKeys(makeSpec(kUniform), 0);
+  int64_t max_count = *std::max_element(counts.begin(), counts.end());
+  // 10 per key on average
+  EXPECT_LT(max_count, 40);
+  EXPECT_LT(std::count(counts.begin(), counts.end(), 0), kNumRecords / 1000);
+}
+
+// Zipfian keys are skewed, with the popular keys scattered
+TEST_F(WorkloadGeneratorTest, zipfianTest) {
+  std::vector<int64_t> counts = countKeys(makeSpec(kZipfian), 0);
+  std::vector<int64_t> sorted_counts = counts;
+  std::sort(sorted_counts.begin(), sorted_counts.end(), std::greater<int64_t>());
+  int64_t top_count = 0;
+  for (int i = 0; i < kNumRecords / 100; i++) top_count += sorted_counts[i];
+  // the top 1% of the keys get far more than 1% of the operations
+  EXPECT_GT(top_count, kNumOps / 10);
+  int64_t max_id = std::max_element(counts.begin(), counts.end()) - counts.begin();
+  EXPECT_NE(0, max_id);
+}
+
+// Latest keys are skewed to the last loaded keys
+TEST_F(WorkloadGeneratorTest, latestTest) {
+  std::vector<int64_t> counts = countKeys(makeSpec(kLatest), 0);
+  EXPECT_EQ(counts.end() - 1, std::max_element(counts.begin(), counts.end()));
+  int64_t last_count = 0;
+  for (int64_t i = kNumRecords - kNumRecords / 100; i < kNumRecords; i++) last_count += counts[i];
+  EXPECT_GT(last_count, kNumOps / 2);
+}
+
+TEST_F(WorkloadGeneratorTest, scanTest) {
+  WorkloadSpec spec = makeSpec(kZipfian);
+  spec.read_proportion = 0.25;
+  spec.scan_proportion = 0.75;
+  WorkloadGenerator generator(spec, 0);
+  int64_t num_scans = 0, total_len = 0;
+  std::vector<int64_t> len_counts(spec.max_scan_length + 1, 0);
+  for (int64_t i = 0; i < kNumOps; i++) {
+    Operation op = generator.next();
+    if (op.type == kRead) {
+      ASSERT_EQ(0, op.scan_len);
+      continue;
+    }
+    ASSERT_GE(op.scan_len, 1);
+    ASSERT_LE(op.scan_len, spec.max_scan_length);
+    len_counts[op.scan_len]++;
+    total_len += op.scan_len;
+    num_scans++;
+  }
+  EXPECT_NEAR(0.75, num_scans / (double)kNumOps, 0.01);
+  EXPECT_NEAR(50.5, total_len / (double)num_scans, 0.5);
+  EXPECT_GT(len_counts[1], 0);
+  EXPECT_GT(len_counts[spec.max_scan_length], 0);
+}
+
+TEST_F(WorkloadGeneratorTest, txnTest) {
+  std::vector<std::string> dataset_keys;
+  for (int i = 0; i < 1000; i++) dataset_keys.push_back("key" + std::to_string(i));
+  std::vector<std::string> load_keys;
+  selectLoadKeys(dataset_keys, 100, load_keys);
+  ASSERT_EQ(100, (int)load_keys.size());
+  EXPECT_EQ("key0", load_keys[0]);
+  EXPECT_EQ("key990", load_keys[99]);
+
+  WorkloadSpec spec;
+  ASSERT_TRUE(loadSpec(kSpecFilePath, &spec));
+  spec.operation_count = 10000;
+  std::vector<std::string> txn_keys;
+  std::vector<int> scan_lens;
+  generateTxns(spec, 0, load_keys, txn_keys, &scan_lens);
+  ASSERT_EQ(10000, (int)txn_keys.size());
+  ASSERT_EQ(10000, (int)scan_lens.size());
+  std::sort(load_keys.begin(), load_keys.end());
+  for (int i = 0; i < (int)txn_keys.size(); i++) {
+    ASSERT_TRUE(std::binary_search(load_keys.begin(), load_keys.end(), txn_keys[i]));
+    ASSERT_GE(scan_lens[i], 1);
+  }
+
+  std::vector<std::string> randint_keys;
+  selectRandintLoadKeys(1000, randint_keys);
+  std::sort(randint_keys.begin(), randint_keys.end());
+  EXPECT_EQ(randint_keys.end(), std::unique(randint_keys.begin(), randint_keys.end()));
+}
+
+}  // namespace workloadgeneratortest
+
+}  // namespace workloadgen
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
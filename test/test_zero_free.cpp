@@ -0,0 +1,122 @@
+#include <string.h>
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "encoder_factory.hpp"
+#include "gtest/gtest.h"
+#include "zero_free.hpp"
+
+namespace hope {
+
+namespace zerofreetest {
+
+static const char kWordFilePath[] = "../../datasets/words.txt";
+static const int kWordTestSize = 234369;
+static const int kRandomTestSize = 100000;
+static const int kDictSizeLimit = 10000;
+static const int kBatchSize = 10;
+static const int kLongestCodeLen = 4096;
+static std::vector<std::string> words;
+
+class ZeroFreeTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {}
+  virtual void TearDown() {}
+};
+
+int sign(const int cmp) { return (cmp > 0) - (cmp < 0); }
+
+std::string escape(const std::string &str) {
+  std::string esc_str = str;
+  escapeZeroBytes(esc_str);
+  return esc_str;
+}
+
+// Strings over a small alphabet that includes both escaped bytes
+TEST_F(ZeroFreeTest, escapeTest) {
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<> len_dis(0, 24);
+  std::uniform_int_distribution<> byte_dis(0, 3);
+  std::vector<std::string> strs;
+  for (int i = 0; i < kRandomTestSize; i++) {
+    std::string str(len_dis(gen), 0);
+    for (int j = 0; j < (int)str.length(); j++) str[j] = (char)byte_dis(gen);
+    strs.push_back(str);
+  }
+  uint8_t buffer[64];
+  for (int i = 0; i < (int)strs.size(); i++) {
+    std::string esc_str = escape(strs[i]);
+    ASSERT_EQ(esc_str.length(), strlen(esc_str.c_str()));
+    memcpy(buffer, strs[i].data(), strs[i].length());
+    int esc_len = escapeZeroBytes(buffer, (int)strs[i].length());
+    ASSERT_EQ(esc_str, std::string((const char *)buffer, esc_len));
+    ASSERT_EQ(0, buffer[esc_len]);
+    int len = unescapeZeroBytes(buffer, esc_len, buffer);
+    ASSERT_EQ(strs[i], std::string((const char *)buffer, len));
+    if (i > 0) {
+      int cmp = sign(strs[i - 1].compare(strs[i]));
+      ASSERT_EQ(cmp, sign(strcmp(escape(strs[i - 1]).c_str(), esc_str.c_str())));
+    }
+  }
+}
+
+// The escaped encodings of sorted keys are sorted as C strings
+TEST_F(ZeroFreeTest, encodeTest) {
+  uint8_t *buffer = new uint8_t[kLongestCodeLen];
+  for (int encoder_type = 1; encoder_type <= 6; encoder_type++) {
+    Encoder *encoder = EncoderFactory::createEncoder(encoder_type, 10000);
+    encoder->build(words, kDictSizeLimit);
+    std::vector<std::string> enc_keys;
+    int64_t num_escapes = 0;
+    for (int i = 0; i < (int)words.size(); i++) {
+      int bit_len = encoder->encode(words[i], buffer);
+      std::string enc_key((const char *)buffer, (bit_len + 7) >> 3);
+      int len = encoder->encodeZeroFree(words[i], buffer);
+      std::string esc_key((const char *)buffer, len);
+      ASSERT_EQ(escape(enc_key), esc_key);
+      ASSERT_EQ(len, (int)strlen((const char *)buffer));
+      num_escapes += len - (int)enc_key.length();
+      enc_keys.push_back(esc_key);
+      if (i > 0) {
+        ASSERT_LE(strcmp(enc_keys[i - 1].c_str(), enc_keys[i].c_str()), 0);
+      }
+    }
+    // plain HOPE codes do produce zero bytes
+    EXPECT_GT(num_escapes, 0);
+
+    std::vector<std::string> batch_keys;
+    int num_words = (int)words.size();
+    for (int i = 0; i < num_words - kBatchSize; i += kBatchSize)
+      encoder->encodeBatchZeroFree(words, i, kBatchSize, batch_keys);
+    for (int i = 0; i < (int)batch_keys.size(); i++) ASSERT_EQ(enc_keys[i], batch_keys[i]);
+    delete encoder;
+  }
+  delete[] buffer;
+}
+
+void LoadWords() {
+  std::ifstream infile(kWordFilePath);
+  std::string key;
+  int count = 0;
+  while (infile.good() && count < kWordTestSize) {
+    infile >> key;
+    words.push_back(key);
+    count++;
+  }
+  std::sort(words.begin(), words.end());
+  words.erase(std::unique(words.begin(), words.end()), words.end());
+}
+
+}  // namespace zerofreetest
+
+}  // namespace hope
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  hope::zerofreetest::LoadWords();
+  return RUN_ALL_TESTS();
+}
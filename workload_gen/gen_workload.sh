@@ -1,16 +1,9 @@
 #!/bin/bash
 
-python gen_load.py randint uniform
-python gen_txn.py randint zipfian
+# gen_workload is built with the project (build/bench/gen_workload)
+GEN_WORKLOAD=${GEN_WORKLOAD:-../build/bench/gen_workload}
 
-python gen_load.py email uniform
-python gen_txn.py email zipfian
-python gen_txn_scan_len.py email zipfian
-
-python gen_load.py url uniform
-python gen_txn.py url zipfian
-python gen_txn_scan_len.py url zipfian
-
-python gen_load.py wiki uniform
-python gen_txn.py wiki zipfian
-python gen_txn_scan_len.py wiki zipfian
+${GEN_WORKLOAD} randint zipfian
+${GEN_WORKLOAD} email zipfian
+${GEN_WORKLOAD} url zipfian
+${GEN_WORKLOAD} wiki zipfian